@@ -0,0 +1,794 @@
+/**
+ *  @File: capture_analyzer.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      capture_analyzer.cpp
+ *
+ *  @brief     Offline analysis of a link capture on all cores. The capture is cut into chunks
+ *             that are decoded at the same time, each with its own decoders and counters, and
+ *             the chunk results are merged in capture order
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "capture_analyzer.h"
+#include "blerecord.h"
+#include "capture.h"
+#include "timer.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define SYNC_RECORDS       8u          // plausible record headers in a row taken as a record start
+#define SYNC_SLACK_US      1000000u    // rx and tx records may be stamped slightly out of order
+#define TASKS_PER_THREAD   4u          // chunks are made smaller until each thread has this many
+#define MIN_CHUNK          65536u
+#define COMMAND_TIMEOUT_US (CMD_TRACKER_DEFAULT_TIMEOUT_MS * 1000ull)
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+// Where a chunk starts decoding: the record it starts in and the first rx byte of it to
+// decode. rec is NULL when no start was found in the chunk, pos NULL for the start of the
+// record's data
+struct SyncPoint
+{
+   const uint8_t *rec;
+   const uint8_t *pos;
+};
+
+struct PendingCommand
+{
+   uint8_t cmdId;
+   uint64_t sentUs;
+};
+
+struct CommandEvent
+{
+   uint64_t timeUs;
+   uint8_t id;        // MCU_CMD_xx of a command, MCU_RSP_xx of a response
+   bool response;
+};
+
+// Everything one chunk found. Which command a response answers depends on every command
+// before it, so commands and responses are only listed here and matched when the chunks are
+// merged, in capture order. They are few next to the bytes decoded
+struct ChunkResult
+{
+   size_t next;                          // chunk this one decoded up to, the chunk count at the end
+   uint32_t resyncs;
+   uint64_t records;
+   uint64_t rxBytes;
+   uint64_t txBytes;
+   uint64_t firstUs;
+   uint64_t lastUs;
+   bool truncated;
+   BLEDecoder_t rx;
+   BLEDecoder_t tx;
+   uint64_t messages[256];
+   std::vector<CommandEvent> commands;   // in capture order
+   std::unordered_map<NodeId_t, CaptureNodeStats_t> nodes;
+};
+
+struct Analysis
+{
+   const uint8_t *first;  // first record
+   const uint8_t *end;
+   size_t chunkBytes;
+   std::vector<SyncPoint> syncs;
+   std::vector<ChunkResult> chunks;
+};
+
+struct WorkQueue
+{
+   std::mutex lock;
+   std::deque<size_t> tasks;
+};
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void RunTasks(size_t count, uint32_t threads, const std::function<void(size_t)> &task);
+static bool IsRecordChain(const Analysis &a, const uint8_t *rec);
+static SyncPoint FindSync(const Analysis &a, size_t k);
+static size_t NextSync(const Analysis &a, size_t k);
+static void DecodeChunk(Analysis &a, size_t k);
+static void CountFrame(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+static void AnalyseRx(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+static void AnalyseTx(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+static void ExpireCommands(std::deque<PendingCommand> &pending, CmdTrackerStats_t *stats, uint64_t nowUs);
+static bool MatchResponse(std::deque<PendingCommand> &pending, CmdTrackerStats_t *stats, uint8_t cmdId, uint64_t rxUs);
+static void MergeChunk(CaptureAnalysis_t *result, std::map<NodeId_t, CaptureNodeStats_t> &nodes,
+                       std::deque<PendingCommand> &pending, const ChunkResult &chunk);
+static void AddDecoderStats(BLEDecoderStats_t *dst, const BLEDecoderStats_t *src);
+static void AddNodeStats(CaptureNodeStats_t *dst, const CaptureNodeStats_t *src);
+static bool SameDecoderStats(const BLEDecoderStats_t *a, const BLEDecoderStats_t *b);
+static bool SameNodeStats(const CaptureNodeStats_t *a, const CaptureNodeStats_t *b);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Decode a whole capture and gather its framing errors, messages, command round trips
+ *         and per node statistics. Chunk k + 1 is started speculatively, at the first frame
+ *         boundary found after its first plausible record header. Chunk k decodes up to that
+ *         point and checks that its own decoder is between frames there, if not it carries on
+ *         through chunk k + 1 and that chunk's result is not used. The result is therefore
+ *         exactly that of one decoder run over the whole capture
+ * @param  base - mapped capture file
+ * @param  size - file size in bytes
+ * @param  threads - worker threads, 1 to CAPTURE_ANALYZER_MAX_THREADS
+ * @param  chunkBytes - bytes of capture per task, made smaller for small captures so every
+ *         thread has work
+ * @param  result - filled in, free with CaptureAnalyzer_Free
+ * @return false if the file is not a capture
+ */
+bool CaptureAnalyzer_Run(const void *base, size_t size, uint32_t threads, size_t chunkBytes, CaptureAnalysis_t *result)
+{
+   (void)memset(result, 0, sizeof(*result));
+   if (!Capture_CheckHeader(base, size))
+   {
+      return false;
+   }
+
+   uint64_t startUs = TIMER_NowUs();
+   const CaptureFileHeader_t *header = static_cast<const CaptureFileHeader_t*>(base);
+   threads = (threads < 1u) ? 1u : ((threads > CAPTURE_ANALYZER_MAX_THREADS) ? CAPTURE_ANALYZER_MAX_THREADS : threads);
+
+   Analysis a;
+   a.first = static_cast<const uint8_t*>(base) + header->headerSize;
+   a.end = static_cast<const uint8_t*>(base) + size;
+   size_t dataBytes = static_cast<size_t>(a.end - a.first);
+   size_t balanced = dataBytes / (threads * TASKS_PER_THREAD);
+   a.chunkBytes = (chunkBytes < MIN_CHUNK) ? MIN_CHUNK : chunkBytes;
+   a.chunkBytes = (balanced < a.chunkBytes) ? ((balanced < MIN_CHUNK) ? MIN_CHUNK : balanced) : a.chunkBytes;
+   size_t count = (dataBytes + a.chunkBytes - 1u) / a.chunkBytes;
+   count = (count < 1u) ? 1u : count;
+
+   a.syncs.resize(count);
+   a.chunks.resize(count);
+
+   // find where each chunk starts, then decode them all
+   a.syncs[0].rec = a.first;
+   a.syncs[0].pos = NULL;
+   RunTasks(count - 1u, threads, [&a](size_t k) { a.syncs[k + 1u] = FindSync(a, k + 1u); });
+   RunTasks(count, threads, [&a](size_t k) {
+      if (NULL != a.syncs[k].rec)
+      {
+         DecodeChunk(a, k);
+      }
+   });
+
+   // merge the chunks that were decoded from a verified start, in capture order
+   std::map<NodeId_t, CaptureNodeStats_t> nodes;
+   std::deque<PendingCommand> pending;
+   uint64_t firstUs = 0;
+   uint64_t lastUs = 0;
+   for (size_t k = 0; k < count; k = a.chunks[k].next)
+   {
+      const ChunkResult &chunk = a.chunks[k];
+      if (chunk.records > 0u)
+      {
+         firstUs = (0u == result->records) ? chunk.firstUs : firstUs;
+         lastUs = chunk.lastUs;
+      }
+      MergeChunk(result, nodes, pending, chunk);
+   }
+   result->durationUs = lastUs - firstUs;
+   for (const PendingCommand &command : pending)
+   {
+      if ((command.sentUs + COMMAND_TIMEOUT_US) <= lastUs)
+      {
+         result->commands[command.cmdId].timedOut++;
+      }
+      else
+      {
+         result->unanswered++;
+      }
+   }
+
+   result->nodes = new CaptureNodeStats_t[nodes.size()];
+   for (const auto &node : nodes)
+   {
+      result->nodes[result->nodeCount++] = node.second;
+   }
+
+   result->threads = threads;
+   result->chunks = static_cast<uint32_t>(count);
+   result->fileBytes = size;
+   result->elapsedUs = TIMER_NowUs() - startUs;
+   return true;
+}
+
+/**
+ * @brief  Free what CaptureAnalyzer_Run allocated in a result
+ * @param  result - result to free, may be freed twice
+ * @return None
+ */
+void CaptureAnalyzer_Free(CaptureAnalysis_t *result)
+{
+   delete[] result->nodes;
+   result->nodes = NULL;
+   result->nodeCount = 0;
+}
+
+/**
+ * @brief  Compare what two analyses found, leaving out how they were run (threads, chunks,
+ *         resyncs and time taken)
+ * @param  a - first result
+ * @param  b - second result
+ * @return true if the analyses agree
+ */
+bool CaptureAnalyzer_Equal(const CaptureAnalysis_t *a, const CaptureAnalysis_t *b)
+{
+   if ((a->fileBytes != b->fileBytes) || (a->records != b->records) || (a->rxBytes != b->rxBytes) ||
+       (a->txBytes != b->txBytes) || (a->durationUs != b->durationUs) || (a->truncated != b->truncated) ||
+       !SameDecoderStats(&a->rx, &b->rx) || !SameDecoderStats(&a->tx, &b->tx) ||
+       (a->unanswered != b->unanswered) || (a->nodeCount != b->nodeCount) ||
+       (memcmp(a->messages, b->messages, sizeof(a->messages)) != 0) ||
+       (memcmp(a->commands, b->commands, sizeof(a->commands)) != 0))
+   {
+      return false;
+   }
+   for (size_t i = 0; i < a->nodeCount; i++)
+   {
+      if (!SameNodeStats(&a->nodes[i], &b->nodes[i]))
+      {
+         return false;
+      }
+   }
+   return true;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Run task(0) to task(count - 1) on a pool of threads. Each thread starts with its own
+ *         run of neighbouring tasks and takes them from the front, a thread that runs out
+ *         steals from the back of another's, so uneven chunks still keep every thread busy
+ * @param  count - number of tasks
+ * @param  threads - threads to use, the calling thread included
+ * @param  task - the work, called once for each task index
+ * @return None
+ */
+static void RunTasks(size_t count, uint32_t threads, const std::function<void(size_t)> &task)
+{
+   std::vector<WorkQueue> queues(threads);
+   for (size_t i = 0; i < count; i++)
+   {
+      queues[(i * threads) / count].tasks.push_back(i);
+   }
+
+   auto worker = [&queues, &task, threads](uint32_t self) {
+      for (;;)
+      {
+         size_t next = 0;
+         bool found = false;
+         {
+            std::lock_guard<std::mutex> guard(queues[self].lock);
+            if (!queues[self].tasks.empty())
+            {
+               next = queues[self].tasks.front();
+               queues[self].tasks.pop_front();
+               found = true;
+            }
+         }
+         for (uint32_t victim = 1; !found && (victim < threads); victim++)
+         {
+            WorkQueue &queue = queues[(self + victim) % threads];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (!queue.tasks.empty())
+            {
+               next = queue.tasks.back();
+               queue.tasks.pop_back();
+               found = true;
+            }
+         }
+         if (!found)
+         {
+            return; // no task is ever queued again, so every queue empty means done
+         }
+         task(next);
+      }
+   };
+
+   std::vector<std::thread> pool;
+   for (uint32_t i = 1; i < threads; i++)
+   {
+      pool.emplace_back(worker, i);
+   }
+   worker(0);
+   for (std::thread &thread : pool)
+   {
+      thread.join();
+   }
+}
+
+/**
+ * @brief  Check whether a record header could start at a point of the file, by walking the
+ *         headers that would follow it
+ * @param  a - analysis
+ * @param  rec - possible record header
+ * @return true if SYNC_RECORDS plausible headers follow on, or fewer ending exactly at the end
+ *         of the file
+ */
+static bool IsRecordChain(const Analysis &a, const uint8_t *rec)
+{
+   uint64_t lastUs = 0;
+
+   for (uint32_t i = 0; i < SYNC_RECORDS; i++)
+   {
+      if (rec == a.end)
+      {
+         return i > 0u;
+      }
+
+      CaptureRecordHeader_t hdr;
+      if (static_cast<size_t>(a.end - rec) < sizeof(hdr))
+      {
+         return false;
+      }
+      (void)memcpy(&hdr, rec, sizeof(hdr));
+      rec += sizeof(hdr);
+      if ((hdr.dir > CAPTURE_DIR_TX) || (0u == hdr.len) ||
+          (static_cast<size_t>(a.end - rec) < hdr.len) ||
+          ((i > 0u) && ((hdr.timeUs + SYNC_SLACK_US) < lastUs)))
+      {
+         return false;
+      }
+      lastUs = hdr.timeUs;
+      rec += hdr.len;
+   }
+   return true;
+}
+
+/**
+ * @brief  Find a speculative start for a chunk: the first plausible record header in its part
+ *         of the file, then the end of the first valid rx frame from there. The chunk before
+ *         checks it when it gets there
+ * @param  a - analysis
+ * @param  k - chunk, 1 or more
+ * @return start, rec NULL if none was found before the chunk's part of the file ends
+ */
+static SyncPoint FindSync(const Analysis &a, size_t k)
+{
+   SyncPoint sync = { NULL, NULL };
+   const uint8_t *rec = a.first + (k * a.chunkBytes);
+   const uint8_t *limit = ((size_t)(a.end - rec) > a.chunkBytes) ? (rec + a.chunkBytes) : a.end;
+
+   while ((rec < limit) && !IsRecordChain(a, rec))
+   {
+      rec++;
+   }
+
+   // one byte at a time, so the decoder stops on the byte that completes the frame
+   BLEDecoder_t dec;
+   BLEDecoder_Init(&dec, CountFrame, NULL);
+   while (rec < limit)
+   {
+      CaptureRecordHeader_t hdr;
+      if (static_cast<size_t>(a.end - rec) < sizeof(hdr))
+      {
+         break;
+      }
+      (void)memcpy(&hdr, rec, sizeof(hdr));
+      const uint8_t *data = rec + sizeof(hdr);
+      if (static_cast<size_t>(a.end - data) < hdr.len)
+      {
+         break;
+      }
+
+      if (CAPTURE_DIR_RX == hdr.dir)
+      {
+         for (const uint8_t *pos = data; pos < (data + hdr.len); pos++)
+         {
+            BLEDecoder_OnRxBlock(&dec, pos, 1u, hdr.timeUs);
+            if (dec.stats.frames > 0u)
+            {
+               sync.rec = rec;
+               sync.pos = pos + 1;
+               return sync;
+            }
+         }
+      }
+      rec = data + hdr.len;
+   }
+   return sync;
+}
+
+/**
+ * @brief  Get the next chunk after k that has a start
+ * @param  a - analysis
+ * @param  k - chunk
+ * @return chunk index, the chunk count if there is none
+ */
+static size_t NextSync(const Analysis &a, size_t k)
+{
+   do
+   {
+      k++;
+   } while ((k < a.syncs.size()) && (NULL == a.syncs[k].rec));
+   return k;
+}
+
+/**
+ * @brief  Decode a chunk from its start up to the start of the next chunk, or on through it if
+ *         this chunk's decoder is part way through a frame there
+ * @param  a - analysis
+ * @param  k - chunk
+ * @return None
+ */
+static void DecodeChunk(Analysis &a, size_t k)
+{
+   ChunkResult &chunk = a.chunks[k];
+   BLEDecoder_Init(&chunk.rx, AnalyseRx, &chunk);
+   BLEDecoder_Init(&chunk.tx, AnalyseTx, &chunk);
+
+   size_t next = NextSync(a, k);
+   const uint8_t *rec = a.syncs[k].rec;
+   const uint8_t *from = a.syncs[k].pos;
+
+   while (rec < a.end)
+   {
+      // a start this walk passed over was not a record
+      while ((next < a.syncs.size()) && (a.syncs[next].rec < rec))
+      {
+         next = NextSync(a, next);
+         chunk.resyncs++;
+      }
+
+      CaptureRecordHeader_t hdr;
+      if (static_cast<size_t>(a.end - rec) < sizeof(hdr))
+      {
+         chunk.truncated = true;
+         break;
+      }
+      (void)memcpy(&hdr, rec, sizeof(hdr));
+      const uint8_t *data = rec + sizeof(hdr);
+      const uint8_t *stop = data + hdr.len;
+      if (static_cast<size_t>(a.end - data) < hdr.len)
+      {
+         chunk.truncated = true;
+         break;
+      }
+      from = (NULL == from) ? data : from;
+
+      if ((next < a.syncs.size()) && (a.syncs[next].rec == rec))
+      {
+         BLEDecoder_OnRxBlock(&chunk.rx, from, static_cast<size_t>(a.syncs[next].pos - from), hdr.timeUs);
+         if (BLEDecoder_IsIdle(&chunk.rx))
+         {
+            chunk.next = next; // the next chunk decoded the rest
+            return;
+         }
+         from = a.syncs[next].pos;
+         next = NextSync(a, next);
+         chunk.resyncs++;
+      }
+
+      chunk.firstUs = (0u == chunk.records) ? hdr.timeUs : chunk.firstUs;
+      chunk.lastUs = hdr.timeUs;
+      chunk.records++;
+      if (CAPTURE_DIR_RX == hdr.dir)
+      {
+         chunk.rxBytes += hdr.len;
+         BLEDecoder_OnRxBlock(&chunk.rx, from, static_cast<size_t>(stop - from), hdr.timeUs);
+      }
+      else
+      {
+         chunk.txBytes += hdr.len;
+         BLEDecoder_OnRxBlock(&chunk.tx, data, hdr.len, hdr.timeUs);
+      }
+      rec = stop;
+      from = NULL;
+   }
+   chunk.next = a.syncs.size();
+}
+
+/**
+ * @brief  Frame handler of the decoder looking for a chunk start, the decoder counts frames
+ * @param  dec - decoder
+ * @param  buf - frame payload
+ * @param  bufLen - number of bytes in buf
+ * @return None
+ */
+static void CountFrame(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen)
+{
+   (void)dec;
+   (void)buf;
+   (void)bufLen;
+}
+
+/**
+ * @brief  Frame handler of a chunk's rx decoder. The fields are pulled out as for the terminal
+ *         with BLEModule_FillRecord, the response and event handlers are not run since they
+ *         feed the live command tracker, benchmarks and record pool
+ * @param  dec - chunk rx decoder
+ * @param  buf - response or event payload
+ * @param  bufLen - number of bytes in buf
+ * @return None
+ */
+static void AnalyseRx(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen)
+{
+   ChunkResult *chunk = static_cast<ChunkResult*>(dec->ctx);
+   BLERecord_t rec;
+   BLEModule_FillRecord(&rec, buf, bufLen, dec->frameUs);
+
+   chunk->messages[rec.id]++;
+   if (eBLE_RECORD_RSP == rec.kind)
+   {
+      CommandEvent response = { rec.timeUs, rec.id, true };
+      chunk->commands.push_back(response);
+   }
+
+   if (0u == rec.nodeId)
+   {
+      return;
+   }
+   CaptureNodeStats_t &node = chunk->nodes[rec.nodeId];
+   if (0u == node.messages)
+   {
+      node.nodeId = rec.nodeId;
+      node.firstUs = rec.timeUs;
+   }
+   else
+   {
+      node.gapHist[CmdTracker_HistBucket((rec.timeUs > node.lastUs) ? (rec.timeUs - node.lastUs) : 0u)]++;
+   }
+   node.lastUs = rec.timeUs;
+   node.messages++;
+
+   if (MCU_EVT_NODE_FOUND == rec.id)
+   {
+      node.adverts++;
+   }
+   else if (MCU_EVT_RX_PAYLOAD == rec.id)
+   {
+      const MCU_EVT_RX_PAYLOAD_t *evt = (const MCU_EVT_RX_PAYLOAD_t *)rec.data;
+      node.payloads++;
+      node.payloadBytes += evt->payloadLen;
+   }
+
+   if (0 != rec.rssi)
+   {
+      node.rssiMin = ((0u == node.rssiCount) || (rec.rssi < node.rssiMin)) ? rec.rssi : node.rssiMin;
+      node.rssiMax = ((0u == node.rssiCount) || (rec.rssi > node.rssiMax)) ? rec.rssi : node.rssiMax;
+      node.rssiTotal += rec.rssi;
+      node.rssiCount++;
+   }
+}
+
+/**
+ * @brief  Frame handler of a chunk's tx decoder, every command the host sent is timed
+ * @param  dec - chunk tx decoder
+ * @param  buf - command payload
+ * @param  bufLen - number of bytes in buf
+ * @return None
+ */
+static void AnalyseTx(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen)
+{
+   ChunkResult *chunk = static_cast<ChunkResult*>(dec->ctx);
+   (void)bufLen;
+
+   CommandEvent command = { dec->frameUs, buf[0], false };
+   chunk->commands.push_back(command);
+}
+
+/**
+ * @brief  Time out the commands that have waited longer than CmdTracker would let them
+ * @param  pending - commands in send order
+ * @param  stats - per command statistics
+ * @param  nowUs - capture time
+ * @return None
+ */
+static void ExpireCommands(std::deque<PendingCommand> &pending, CmdTrackerStats_t *stats, uint64_t nowUs)
+{
+   while (!pending.empty() && ((pending.front().sentUs + COMMAND_TIMEOUT_US) <= nowUs))
+   {
+      stats[pending.front().cmdId].timedOut++;
+      pending.pop_front();
+   }
+}
+
+/**
+ * @brief  Match a response to the oldest waiting command with the same id, or reject the
+ *         oldest waiting command on MCU_RSP_UNKNOWN_COMMAND, as CmdTracker_OnResponse does
+ * @param  pending - commands in send order
+ * @param  stats - per command statistics, the round trip is added to them
+ * @param  rspId - MCU_RSP_xx id of the response
+ * @param  rxUs - capture time of the response
+ * @return false if no command was waiting
+ */
+static bool MatchResponse(std::deque<PendingCommand> &pending, CmdTrackerStats_t *stats, uint8_t rspId, uint64_t rxUs)
+{
+   ExpireCommands(pending, stats, rxUs);
+
+   uint8_t cmdId = (uint8_t)(rspId & (uint8_t)~MCU_RSP_MASK);
+   bool rejected = (MCU_RSP_UNKNOWN_COMMAND == rspId);
+   auto it = pending.begin();
+   while (!rejected && (it != pending.end()) && (it->cmdId != cmdId))
+   {
+      ++it;
+   }
+   if (it == pending.end())
+   {
+      return false;
+   }
+
+   CmdTrackerStats_t *stat = &stats[it->cmdId];
+   if (rejected)
+   {
+      stat->rejected++;
+      pending.erase(it);
+      return true;
+   }
+
+   uint64_t rttUs = (rxUs > it->sentUs) ? (rxUs - it->sentUs) : 0u;
+   stat->rttMinUs = ((0u == stat->completed) || (rttUs < stat->rttMinUs)) ? rttUs : stat->rttMinUs;
+   stat->rttMaxUs = (rttUs > stat->rttMaxUs) ? rttUs : stat->rttMaxUs;
+   stat->rttTotalUs += rttUs;
+   stat->hist[CmdTracker_HistBucket(rttUs)]++;
+   stat->completed++;
+   pending.erase(it);
+   return true;
+}
+
+/**
+ * @brief  Add a chunk to the result, matching its responses to the commands sent before them
+ * @param  result - result so far
+ * @param  nodes - node statistics so far
+ * @param  pending - commands still waiting, in send order
+ * @param  chunk - next chunk in capture order
+ * @return None
+ */
+static void MergeChunk(CaptureAnalysis_t *result, std::map<NodeId_t, CaptureNodeStats_t> &nodes,
+                       std::deque<PendingCommand> &pending, const ChunkResult &chunk)
+{
+   result->records += chunk.records;
+   result->rxBytes += chunk.rxBytes;
+   result->txBytes += chunk.txBytes;
+   result->resyncs += chunk.resyncs;
+   result->truncated = result->truncated || chunk.truncated;
+   AddDecoderStats(&result->rx, &chunk.rx.stats);
+   AddDecoderStats(&result->tx, &chunk.tx.stats);
+   for (size_t id = 0; id < 256u; id++)
+   {
+      result->messages[id] += chunk.messages[id];
+   }
+
+   for (const CommandEvent &event : chunk.commands)
+   {
+      if (!event.response)
+      {
+         PendingCommand command = { event.id, event.timeUs };
+         result->commands[event.id].sent++;
+         pending.push_back(command);
+      }
+      else if (!MatchResponse(pending, result->commands, event.id, event.timeUs))
+      {
+         result->commands[event.id & (uint8_t)~MCU_RSP_MASK].unmatched++;
+      }
+   }
+
+   for (const auto &node : chunk.nodes)
+   {
+      auto it = nodes.find(node.first);
+      if (it == nodes.end())
+      {
+         nodes[node.first] = node.second;
+      }
+      else
+      {
+         AddNodeStats(&it->second, &node.second);
+      }
+   }
+}
+
+/**
+ * @brief  Add one set of decoder counters to another
+ * @param  dst - counters to add to
+ * @param  src - counters to add
+ * @return None
+ */
+static void AddDecoderStats(BLEDecoderStats_t *dst, const BLEDecoderStats_t *src)
+{
+   dst->bytes += src->bytes;
+   dst->frames += src->frames;
+   dst->badHeader += src->badHeader;
+   dst->badLength += src->badLength;
+   dst->badCrc += src->badCrc;
+}
+
+/**
+ * @brief  Add a node's statistics from a later part of the capture to another, counting the gap
+ *         across the join
+ * @param  dst - statistics to add to
+ * @param  src - statistics to add, all later than dst
+ * @return None
+ */
+static void AddNodeStats(CaptureNodeStats_t *dst, const CaptureNodeStats_t *src)
+{
+   dst->gapHist[CmdTracker_HistBucket((src->firstUs > dst->lastUs) ? (src->firstUs - dst->lastUs) : 0u)]++;
+   for (uint32_t i = 0; i < CMD_TRACKER_HIST_BUCKETS; i++)
+   {
+      dst->gapHist[i] += src->gapHist[i];
+   }
+   if (src->rssiCount > 0u)
+   {
+      dst->rssiMin = ((0u == dst->rssiCount) || (src->rssiMin < dst->rssiMin)) ? src->rssiMin : dst->rssiMin;
+      dst->rssiMax = ((0u == dst->rssiCount) || (src->rssiMax > dst->rssiMax)) ? src->rssiMax : dst->rssiMax;
+   }
+   dst->messages += src->messages;
+   dst->adverts += src->adverts;
+   dst->payloads += src->payloads;
+   dst->payloadBytes += src->payloadBytes;
+   dst->rssiCount += src->rssiCount;
+   dst->rssiTotal += src->rssiTotal;
+   dst->lastUs = src->lastUs;
+}
+
+/**
+ * @brief  Compare two sets of decoder counters
+ * @param  a - first counters
+ * @param  b - second counters
+ * @return true if equal
+ */
+static bool SameDecoderStats(const BLEDecoderStats_t *a, const BLEDecoderStats_t *b)
+{
+   return (a->bytes == b->bytes) && (a->frames == b->frames) && (a->badHeader == b->badHeader) &&
+          (a->badLength == b->badLength) && (a->badCrc == b->badCrc);
+}
+
+/**
+ * @brief  Compare two nodes' statistics
+ * @param  a - first node
+ * @param  b - second node
+ * @return true if equal
+ */
+static bool SameNodeStats(const CaptureNodeStats_t *a, const CaptureNodeStats_t *b)
+{
+   return (a->nodeId == b->nodeId) && (a->messages == b->messages) && (a->adverts == b->adverts) &&
+          (a->payloads == b->payloads) && (a->payloadBytes == b->payloadBytes) &&
+          (a->rssiCount == b->rssiCount) && (a->rssiTotal == b->rssiTotal) &&
+          (a->rssiMin == b->rssiMin) && (a->rssiMax == b->rssiMax) &&
+          (a->firstUs == b->firstUs) && (a->lastUs == b->lastUs) &&
+          (memcmp(a->gapHist, b->gapHist, sizeof(a->gapHist)) == 0);
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
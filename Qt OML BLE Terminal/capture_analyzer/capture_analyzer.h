@@ -0,0 +1,108 @@
+/**
+ *  @File: capture_analyzer.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      capture_analyzer.h
+ *
+ *  @brief     Defines the offline capture analysis API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "ble_module.h"
+#include "cmdtracker.h"
+#include "../../OML BLE App/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define CAPTURE_ANALYZER_DEFAULT_CHUNK  (16u * 1024u * 1024u) // bytes of capture per task
+#define CAPTURE_ANALYZER_MAX_THREADS    256u
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+// Everything heard about one node, from the responses and events that carry its node id.
+// Gaps are the times between consecutive messages about the node, on the CmdTracker log2
+// buckets
+typedef struct
+{
+   NodeId_t nodeId;
+   uint64_t messages;
+   uint64_t adverts;        // MCU_EVT_NODE_FOUND
+   uint64_t payloads;       // MCU_EVT_RX_PAYLOAD
+   uint64_t payloadBytes;
+   uint64_t rssiCount;      // messages with an RSSI
+   int64_t rssiTotal;
+   int8_t rssiMin;
+   int8_t rssiMax;
+   uint64_t firstUs;        // capture time of the first and last message
+   uint64_t lastUs;
+   uint32_t gapHist[CMD_TRACKER_HIST_BUCKETS];
+} CaptureNodeStats_t;
+
+// Result of CaptureAnalyzer_Run, the same whatever the thread count and chunk size. Times are
+// capture times, us since the capture started
+typedef struct
+{
+   uint32_t threads;
+   uint32_t chunks;          // tasks the capture was cut into
+   uint32_t resyncs;         // chunk edges where the speculative start was wrong and the
+                             // chunk before decoded on through it
+   uint64_t fileBytes;
+   uint64_t records;
+   uint64_t rxBytes;
+   uint64_t txBytes;
+   uint64_t durationUs;      // first to last record
+   bool truncated;           // file ended part way through a record
+   BLEDecoderStats_t rx;     // dongle to host framing
+   BLEDecoderStats_t tx;     // host to dongle framing, the commands
+   uint64_t messages[256];   // valid frames by MCU_RSP_xx or MCU_EVT_xx id
+   CmdTrackerStats_t commands[256]; // by MCU_CMD_xx id, matched as CmdTracker does live
+   uint32_t unanswered;      // commands still waiting when the capture ends
+   CaptureNodeStats_t *nodes; // in node id order, freed by CaptureAnalyzer_Free
+   size_t nodeCount;
+   uint64_t elapsedUs;       // wall time of the analysis
+} CaptureAnalysis_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+bool CaptureAnalyzer_Run(const void *base, size_t size, uint32_t threads, size_t chunkBytes, CaptureAnalysis_t *result);
+void CaptureAnalyzer_Free(CaptureAnalysis_t *result);
+bool CaptureAnalyzer_Equal(const CaptureAnalysis_t *a, const CaptureAnalysis_t *b);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,22 @@
+# Offline capture analyzer, a console tool that decodes a link capture on every core with the
+# oml_core decoder and reports framing errors, command round trips and per node statistics.
+QT = core serialport
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+TARGET = oml_capture_analyzer
+
+include(../oml_core/oml_core.pri)
+
+git_commit_hash = $$system(git rev-parse --short HEAD)
+DEFINES += GIT_COMMIT_HASH=\\\"$$git_commit_hash\\\"
+
+SOURCES += \
+    capture_analyzer.cpp \
+    main.cpp
+
+HEADERS += \
+    capture_analyzer.h
+
+unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,284 @@
+/**
+ *  @File: main.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      main.cpp
+ *
+ *  @brief     Offline capture analyzer. Decodes a link capture on every core and prints the
+ *             framing errors, message counts, command round trips and per node statistics,
+ *             with the decode rate, or how the decode rate scales with the thread count
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "capture_analyzer.h"
+#include "timer.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define DEFAULT_NODES 20u
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void PrintReport(const CaptureAnalysis_t *result, size_t maxNodes);
+static bool PrintScaling(const uint8_t *base, size_t size, uint32_t maxThreads, size_t chunkBytes);
+static double GBPerSec(const CaptureAnalysis_t *result);
+static uint64_t HistPercentileUs(const uint32_t *hist, uint32_t pct);
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   QCoreApplication app(argc, argv);
+   QCoreApplication::setApplicationName("oml_capture_analyzer");
+   QCoreApplication::setApplicationVersion(GIT_COMMIT_HASH);
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription("Decodes a link capture on every core and reports framing errors, message counts,\n"
+                                    "command round trips and per node statistics, with the decode rate.");
+   parser.addHelpOption();
+   parser.addVersionOption();
+   parser.addPositionalArgument("capture", "Capture file from the terminal or oml_terminal_cli.");
+   QCommandLineOption threadsOption(QStringList() << "j" << "threads", "Worker threads (default one per core).", "n",
+                                    QString::number(QThread::idealThreadCount()));
+   QCommandLineOption chunkOption(QStringList() << "c" << "chunk", "MiB of capture per task (default 16).", "MiB", "16");
+   QCommandLineOption nodesOption(QStringList() << "n" << "nodes", "Nodes to list, busiest first, 0 for all (default 20).", "n",
+                                  QString::number(DEFAULT_NODES));
+   QCommandLineOption scalingOption(QStringList() << "s" << "scaling", "Time the analysis on 1, 2, 4 ... threads up to --threads and check every run agrees.");
+   parser.addOptions({ threadsOption, chunkOption, nodesOption, scalingOption });
+   parser.process(app);
+
+   if (parser.positionalArguments().size() != 1)
+   {
+      fprintf(stderr, "Give one capture file, see --help\n");
+      return EXIT_FAILURE;
+   }
+   QString path = parser.positionalArguments().first();
+   uint32_t threads = parser.value(threadsOption).toUInt();
+   size_t chunkBytes = static_cast<size_t>(parser.value(chunkOption).toULongLong()) * 1024u * 1024u;
+
+   QFile file(path);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      fprintf(stderr, "Cannot open %s: %s\n", qPrintable(path), qPrintable(file.errorString()));
+      return EXIT_FAILURE;
+   }
+   size_t size = static_cast<size_t>(file.size());
+   const uint8_t *base = (size > 0u) ? file.map(0, file.size()) : nullptr;
+
+   TIMER_Init();
+   bool ok;
+   if (parser.isSet(scalingOption))
+   {
+      ok = PrintScaling(base, size, threads, chunkBytes);
+   }
+   else
+   {
+      CaptureAnalysis_t result;
+      ok = CaptureAnalyzer_Run(base, size, threads, chunkBytes, &result);
+      if (ok)
+      {
+         PrintReport(&result, parser.value(nodesOption).toUInt());
+      }
+      CaptureAnalyzer_Free(&result);
+   }
+   if (!ok)
+   {
+      fprintf(stderr, "%s is not a capture file\n", qPrintable(path));
+   }
+
+   if (nullptr != base)
+   {
+      file.unmap(const_cast<uint8_t*>(base));
+   }
+   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Print what an analysis found to stdout
+ * @param  result - analysis
+ * @param  maxNodes - nodes to list, busiest first, 0 for all
+ * @return None
+ */
+static void PrintReport(const CaptureAnalysis_t *result, size_t maxNodes)
+{
+   printf("capture   %llu bytes, %llu records%s, %.3f s, rx %llu bytes, tx %llu bytes\n",
+          (unsigned long long)result->fileBytes, (unsigned long long)result->records,
+          result->truncated ? " (truncated)" : "", result->durationUs / 1e6,
+          (unsigned long long)result->rxBytes, (unsigned long long)result->txBytes);
+   printf("analysis  %.3f s on %u threads, %u chunks, %u resyncs, %.2f GB/s\n",
+          result->elapsedUs / 1e6, result->threads, result->chunks, result->resyncs, GBPerSec(result));
+   printf("rx frames %llu, bad header %u, bad length %u, bad crc %u\n",
+          (unsigned long long)result->rx.frames, result->rx.badHeader, result->rx.badLength, result->rx.badCrc);
+   printf("tx frames %llu, bad header %u, bad length %u, bad crc %u\n",
+          (unsigned long long)result->tx.frames, result->tx.badHeader, result->tx.badLength, result->tx.badCrc);
+
+   printf("\nmessage   count\n");
+   for (uint32_t id = 0; id < 256u; id++)
+   {
+      if (result->messages[id] > 0u)
+      {
+         printf("0x%02X      %llu\n", id, (unsigned long long)result->messages[id]);
+      }
+   }
+
+   printf("\ncommand   sent      answered  timed out unknown   unmatched rtt min/avg/max us         p50/p99 us\n");
+   for (uint32_t id = 0; id < 256u; id++)
+   {
+      const CmdTrackerStats_t *stats = &result->commands[id];
+      if ((stats->sent > 0u) || (stats->unmatched > 0u))
+      {
+         printf("0x%02X      %-9u %-9u %-9u %-9u %-9u %llu/%llu/%llu %llu/%llu\n", id, stats->sent, stats->completed,
+                stats->timedOut, stats->rejected, stats->unmatched, (unsigned long long)stats->rttMinUs,
+                (unsigned long long)((stats->completed > 0u) ? (stats->rttTotalUs / stats->completed) : 0u),
+                (unsigned long long)stats->rttMaxUs, (unsigned long long)HistPercentileUs(stats->hist, 50u),
+                (unsigned long long)HistPercentileUs(stats->hist, 99u));
+      }
+   }
+   if (result->unanswered > 0u)
+   {
+      printf("%u commands still waiting at the end of the capture\n", result->unanswered);
+   }
+
+   std::vector<const CaptureNodeStats_t*> nodes;
+   for (size_t i = 0; i < result->nodeCount; i++)
+   {
+      nodes.push_back(&result->nodes[i]);
+   }
+   std::stable_sort(nodes.begin(), nodes.end(), [](const CaptureNodeStats_t *a, const CaptureNodeStats_t *b) {
+      return a->messages > b->messages;
+   });
+   if ((maxNodes > 0u) && (nodes.size() > maxNodes))
+   {
+      nodes.resize(maxNodes);
+   }
+
+   printf("\nnode      messages  adverts   payloads  bytes       rssi min/avg/max gap p50/p99 us\n");
+   for (const CaptureNodeStats_t *node : nodes)
+   {
+      char rssi[32];
+      (void)snprintf(rssi, sizeof(rssi), "%d/%d/%d", node->rssiMin,
+                     (node->rssiCount > 0u) ? (int)(node->rssiTotal / (int64_t)node->rssiCount) : 0, node->rssiMax);
+      printf("%-9u %-9llu %-9llu %-9llu %-11llu %-16s %llu/%llu\n", (unsigned)node->nodeId,
+             (unsigned long long)node->messages, (unsigned long long)node->adverts,
+             (unsigned long long)node->payloads, (unsigned long long)node->payloadBytes, rssi,
+             (unsigned long long)HistPercentileUs(node->gapHist, 50u),
+             (unsigned long long)HistPercentileUs(node->gapHist, 99u));
+   }
+   if (nodes.size() < result->nodeCount)
+   {
+      printf("... %llu more nodes, see --nodes\n", (unsigned long long)(result->nodeCount - nodes.size()));
+   }
+}
+
+/**
+ * @brief  Time the analysis on 1, 2, 4 ... threads up to maxThreads and print the decode rate
+ *         and speed up of each, checking every run finds the same as the single thread one.
+ *         One untimed run first brings the file into the page cache
+ * @param  base - mapped capture file
+ * @param  size - file size in bytes
+ * @param  maxThreads - most threads to try
+ * @param  chunkBytes - bytes of capture per task
+ * @return false if the file is not a capture or a run disagreed
+ */
+static bool PrintScaling(const uint8_t *base, size_t size, uint32_t maxThreads, size_t chunkBytes)
+{
+   CaptureAnalysis_t single;
+   CaptureAnalysis_t run;
+   if (!CaptureAnalyzer_Run(base, size, maxThreads, chunkBytes, &run))
+   {
+      return false;
+   }
+   CaptureAnalyzer_Free(&run);
+   (void)CaptureAnalyzer_Run(base, size, 1u, chunkBytes, &single);
+
+   bool agree = true;
+   printf("threads   seconds   GB/s      speed up  efficiency\n");
+   for (uint32_t threads = 1u; ; threads = ((threads * 2u) < maxThreads) ? (threads * 2u) : maxThreads)
+   {
+      (void)CaptureAnalyzer_Run(base, size, threads, chunkBytes, &run);
+      double speedUp = (double)single.elapsedUs / (double)((run.elapsedUs > 0u) ? run.elapsedUs : 1u);
+      bool same = CaptureAnalyzer_Equal(&run, &single);
+      printf("%-9u %-9.3f %-9.2f %-9.2f %.0f%%%s\n", run.threads, run.elapsedUs / 1e6, GBPerSec(&run), speedUp,
+             100.0 * speedUp / run.threads, same ? "" : "  results differ from 1 thread");
+      agree = agree && same;
+      CaptureAnalyzer_Free(&run);
+      if (threads >= maxThreads)
+      {
+         break;
+      }
+   }
+   CaptureAnalyzer_Free(&single);
+   return agree;
+}
+
+/**
+ * @brief  Get the rate an analysis went through its capture
+ * @param  result - analysis
+ * @return capture file GB (10^9 bytes) per second
+ */
+static double GBPerSec(const CaptureAnalysis_t *result)
+{
+   return (double)result->fileBytes / 1e3 / (double)((result->elapsedUs > 0u) ? result->elapsedUs : 1u);
+}
+
+/**
+ * @brief  Read a percentile off a CmdTracker style log2 histogram
+ * @param  hist - CMD_TRACKER_HIST_BUCKETS counts
+ * @param  pct - percentile, 1 to 100
+ * @return upper edge of the bucket holding the percentile in us, 0 for an empty histogram
+ */
+static uint64_t HistPercentileUs(const uint32_t *hist, uint32_t pct)
+{
+   uint64_t total = 0;
+   for (uint32_t i = 0; i < CMD_TRACKER_HIST_BUCKETS; i++)
+   {
+      total += hist[i];
+   }
+
+   uint64_t seen = 0;
+   for (uint32_t i = 0; i < CMD_TRACKER_HIST_BUCKETS; i++)
+   {
+      seen += hist[i];
+      if ((seen > 0u) && ((seen * 100u) >= (total * pct)))
+      {
+         return 1ull << i;
+      }
+   }
+   return 0;
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
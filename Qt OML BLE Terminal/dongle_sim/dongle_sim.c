@@ -0,0 +1,808 @@
+/**
+ *  @File: dongle_sim.c
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      dongle_sim.c
+ *
+ *  @brief     Implements the OML BLE dongle simulator. Parses MCU command frames from the host,
+ *             answers each with its MCU_RSP_xx and generates the events a real dongle would,
+ *             plus NODE_FOUND / RX_PAYLOAD storms and corrupted frames for load testing
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "dongle_sim.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "../../OML BLE App/utils.h"
+#include "crc8.h"
+#include "debug.h"
+#include <string.h>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define FRAME_OVERHEAD       4u       // 2 header bytes, length and CRC
+#define OUT_BUFFER_SIZE      65536u   // frames are batched and handed to the sink in one write
+#define MAX_EVENTS_PER_TICK  4096u    // a late tick catches up over several calls
+#define MAX_PINGS            64u
+#define MAX_CONNECTIONS      8u
+#define MAX_NOISE_BYTES      8u
+#define SIM_FW_MAJOR         9u
+#define SIM_FW_MINOR         99u
+#define DISCONNECT_REASON    0x16u    // BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION
+#define RANDOM_SEED          0x2545F491u
+
+// Every command the dongle answers. A response carries at least cmdId | MCU_RSP_MASK and a
+// status, the GET_xx responses are filled in by name in BuildResponse()
+#define SIM_COMMANDS(X) \
+   X(NOP) X(ON_MCU_RESET) X(ON_MCU_BOOTLOADER) X(ON_MCU_SLEEP) X(BLE_REBOOT) X(BLE_POWEROFF) \
+   X(BLE_UARTOFF) X(BLE_FACTORY_RESET) X(BLE_DFU_MODE) X(GET_FW_VERSION) X(SET_AUTH_KEY) \
+   X(SET_TX_POWER) X(SET_NODE_ROLE) X(GET_NODE_ROLE) X(SET_NODE_ID) X(GET_NODE_ID) \
+   X(SET_NODE_TYPE) X(GET_NODE_TYPE) X(SET_CONNECTION_PARAMS) X(SET_GAP_EVENT_LENGTH) \
+   X(GET_GAP_EVENT_LENGTH) X(SET_SCAN_PARAMS) X(GET_SCAN_PARAMS) X(SCAN) X(SET_ADV_PARAMS) \
+   X(GET_ADV_PARAMS) X(ADVERTISE) X(SET_ADVERT_DATA) X(GET_ADVERT_DATA) X(SAVE_CONFIG) \
+   X(CONNECT) X(DISCONNECT) X(PAIR) X(UNPAIR) X(UNPAIR_ALL) X(GET_PAIR_ENTRY_COUNT) \
+   X(GET_PAIR_ENTRY) X(GET_CONNECTION_COUNT) X(GET_CONNECTION) X(SET_ADVERT_RSSI_THRESHOLD) \
+   X(GET_ADVERT_RSSI_THRESHOLD) X(RADIO_TEST_DTM) X(RADIO_TEST_MOD_CARRIER) X(TX_PAYLOAD) \
+   X(REMOTE_MCU_PING_REQUEST) X(REMOTE_MCU_PING_REPLY) X(REMOTE_MCU_RESET_REQUEST) \
+   X(REMOTE_MCU_BOOTLOADER_REQUEST) X(REMOTE_MCU_RESET_NOW) X(REMOTE_BLE_DFU_MODE)
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+typedef enum
+{
+   eWAITING_FOR_HEADER1 = 0,
+   eWAITING_FOR_HEADER2,
+   eWAITING_FOR_LENGTH,
+   eWAITING_FOR_DATA,
+} SimRxState_e;
+
+typedef struct
+{
+   NodeId_t nodeId;
+   uint64_t dueUs;
+} SimPing_t;
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void RxByte(uint8_t ch);
+static void OnCommand(const uint8_t *cmdBuf, size_t cmdLen);
+static size_t BuildResponse(uint8_t cmdId, const uint8_t *cmdBuf, uint8_t *rspBuf);
+static void EmitNodeFound(void);
+static void EmitRxPayload(void);
+static void EmitNodeIdEvent(uint8_t evtId, NodeId_t nodeId);
+static void EmitBleReboot(void);
+static void EmitNodeConnected(NodeId_t nodeId);
+static void EmitNodeDisconnected(NodeId_t nodeId);
+static void EmitRxAck(NodeId_t srcNodeId, uint8_t txSeqNum);
+static void Storm(uint64_t nowUs, uint32_t perSec, uint64_t *sent, void (*emit)(void));
+static uint8_t *EmitBegin(void);
+static void EmitEnd(size_t payloadLen, bool mayCorrupt);
+static void Flush(void);
+static NodeId_t PeerNodeId(uint32_t index);
+static void PutNodeId(uint8_t nodeIdArray[3], NodeId_t nodeId);
+static uint32_t Random(void);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+static DongleSimConfig_t s_config;
+static DongleSimSink_t s_sink = NULL;
+static DongleSimStats_t s_stats;
+
+static SimRxState_e s_rxState = eWAITING_FOR_HEADER1;
+static uint8_t s_rxFrame[MCU_PROTOCOL_FRAME_SIZE_MAX];
+static size_t s_rxLen = 0;
+
+static uint8_t s_out[OUT_BUFFER_SIZE];
+static size_t s_outLen = 0;
+static size_t s_frameStart = 0;
+
+static uint64_t s_startUs = 0;
+static uint64_t s_nowUs = 0;
+static uint64_t s_nodeFoundSent = 0;
+static uint64_t s_rxPayloadSent = 0;
+static uint32_t s_nextPeer = 0;
+static uint32_t s_rxPayloadSeq = 0;
+static uint8_t s_txSeqNum = 0;
+static uint32_t s_random = RANDOM_SEED;
+
+static SimPing_t s_pings[MAX_PINGS];
+static size_t s_pingHead = 0;
+static size_t s_pingCount = 0;
+
+static NodeId_t s_connections[MAX_CONNECTIONS];
+static uint8_t s_connectionCount = 0;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Fill in a config with the simulator defaults: quiet link, no storms or corruption
+ * @param  config - config to fill in
+ * @return None
+ */
+void DongleSim_DefaultConfig(DongleSimConfig_t *config)
+{
+   (void)memset(config, 0, sizeof(*config));
+   config->nodeId = DONGLE_SIM_DEFAULT_NODE_ID;
+   config->nodeCount = DONGLE_SIM_DEFAULT_NODES;
+   config->rxPayloadLen = DONGLE_SIM_DEFAULT_PAYLOAD_LEN;
+}
+
+/**
+ * @brief  Reset the simulator
+ * @param  config - behaviour of the simulated dongle
+ * @param  sink - called with batches of complete frames for the host
+ * @param  nowUs - current time, storm rates are measured from here
+ * @return None
+ */
+void DongleSim_Init(const DongleSimConfig_t *config, DongleSimSink_t sink, uint64_t nowUs)
+{
+   s_config = *config;
+   if (0u == s_config.nodeCount)
+   {
+      s_config.nodeCount = 1u;
+   }
+   if (s_config.nodeCount > DONGLE_SIM_MAX_NODES)
+   {
+      s_config.nodeCount = DONGLE_SIM_MAX_NODES;
+   }
+   if (s_config.rxPayloadLen > (MCU_PROTOCOL_PAYLOAD_MAX - 8u))
+   {
+      s_config.rxPayloadLen = MCU_PROTOCOL_PAYLOAD_MAX - 8u;
+   }
+
+   s_sink = sink;
+   (void)memset(&s_stats, 0, sizeof(s_stats));
+   s_rxState = eWAITING_FOR_HEADER1;
+   s_rxLen = 0;
+   s_outLen = 0;
+   s_startUs = nowUs;
+   s_nowUs = nowUs;
+   s_nodeFoundSent = 0;
+   s_rxPayloadSent = 0;
+   s_nextPeer = 0;
+   s_rxPayloadSeq = 0;
+   s_txSeqNum = 0;
+   s_pingHead = 0;
+   s_pingCount = 0;
+   s_connectionCount = 0;
+   s_random = RANDOM_SEED;
+
+   // a real dongle announces itself on power up
+   EmitBleReboot();
+   Flush();
+}
+
+/**
+ * @brief  Feed bytes written by the host, responses and any resulting events are sent before
+ *         this returns
+ * @param  data - bytes from the host
+ * @param  len - number of bytes in data
+ * @return None
+ */
+void DongleSim_OnRxBlock(const uint8_t *data, size_t len)
+{
+   s_stats.rxBytes += len;
+   for (size_t i = 0; i < len; i++)
+   {
+      RxByte(data[i]);
+   }
+   Flush();
+}
+
+/**
+ * @brief  Generate the events due by nowUs: ping replies and the configured storms
+ * @param  nowUs - current time
+ * @return None
+ */
+void DongleSim_Tick(uint64_t nowUs)
+{
+   s_nowUs = nowUs;
+
+   while ((s_pingCount > 0u) && (s_pings[s_pingHead].dueUs <= nowUs))
+   {
+      EmitNodeIdEvent(MCU_EVT_PING_REPLY, s_pings[s_pingHead].nodeId);
+      s_pingHead = (s_pingHead + 1u) % MAX_PINGS;
+      s_pingCount--;
+   }
+
+   Storm(nowUs, s_config.nodeFoundPerSec, &s_nodeFoundSent, EmitNodeFound);
+   Storm(nowUs, s_config.rxPayloadPerSec, &s_rxPayloadSent, EmitRxPayload);
+   Flush();
+}
+
+/**
+ * @brief  Get the simulator counters
+ * @param  stats - where to copy the counters
+ * @return None
+ */
+void DongleSim_GetStats(DongleSimStats_t *stats)
+{
+   *stats = s_stats;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Command frame state machine, same framing rules as BLEModule_OnRx
+ * @param  ch - byte from the host
+ * @return None
+ */
+static void RxByte(uint8_t ch)
+{
+   switch (s_rxState)
+   {
+      case eWAITING_FOR_HEADER1:
+         if (MCU_PROTOCOL_FRAME_HEADER1 == ch)
+         {
+            s_rxFrame[0] = ch;
+            s_rxState = eWAITING_FOR_HEADER2;
+         }
+         break;
+
+      case eWAITING_FOR_HEADER2:
+         if (MCU_PROTOCOL_FRAME_HEADER2 == ch)
+         {
+            s_rxFrame[1] = ch;
+            s_rxState = eWAITING_FOR_LENGTH;
+         }
+         else if (MCU_PROTOCOL_FRAME_HEADER1 != ch)
+         {
+            s_rxState = eWAITING_FOR_HEADER1;
+         }
+         break;
+
+      case eWAITING_FOR_LENGTH:
+         if ((ch >= MCU_PROTOCOL_LENGTH_FIELD_MIN) && (ch <= MCU_PROTOCOL_LENGTH_FIELD_MAX))
+         {
+            s_rxFrame[2] = ch;
+            s_rxLen = 3u;
+            s_rxState = eWAITING_FOR_DATA;
+         }
+         else
+         {
+            s_rxState = eWAITING_FOR_HEADER1;
+         }
+         break;
+
+      case eWAITING_FOR_DATA:
+         s_rxFrame[s_rxLen++] = ch;
+         if (s_rxLen == (3u + s_rxFrame[2]))
+         {
+            size_t crcLen = s_rxLen - 1u;
+            if (crc8ccitt_block(0, s_rxFrame, crcLen) == s_rxFrame[crcLen])
+            {
+               s_stats.rxFrames++;
+               OnCommand(&s_rxFrame[3], s_rxFrame[2] - 1u);
+            }
+            else
+            {
+               s_stats.rxBadFrames++;
+               LOG_WARN("bad command crc\n");
+            }
+            s_rxState = eWAITING_FOR_HEADER1;
+         }
+         break;
+
+      default:
+         s_rxState = eWAITING_FOR_HEADER1;
+         break;
+   }
+}
+
+/**
+ * @brief  Answer a command and raise the events that follow it on a real dongle
+ * @param  cmdBuf - command payload
+ * @param  cmdLen - number of bytes in cmdBuf
+ * @return None
+ */
+static void OnCommand(const uint8_t *cmdBuf, size_t cmdLen)
+{
+   uint8_t cmdBytes[MCU_PROTOCOL_PAYLOAD_MAX] = {0};
+   uint8_t cmdId = cmdBuf[0];
+
+   // short commands read as zero filled rather than past the frame
+   (void)memcpy(cmdBytes, cmdBuf, cmdLen);
+
+   uint8_t *rsp = EmitBegin();
+   EmitEnd(BuildResponse(cmdId, cmdBytes, rsp), false);
+   s_stats.rspFrames++;
+
+   switch (cmdId)
+   {
+      case MCU_CMD_BLE_REBOOT: {
+         s_connectionCount = 0;
+         EmitBleReboot();
+         break;
+      }
+      case MCU_CMD_SCAN: {
+         // one report per peer, storms add more on top
+         for (uint32_t i = 0; i < s_config.nodeCount; i++)
+         {
+            EmitNodeFound();
+         }
+         break;
+      }
+      case MCU_CMD_CONNECT: {
+         const MCU_CMD_CONNECT_t *cmd = (const MCU_CMD_CONNECT_t *)cmdBytes;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(cmd->nodeId);
+         if (s_connectionCount < MAX_CONNECTIONS)
+         {
+            s_connections[s_connectionCount++] = nodeId;
+            EmitNodeConnected(nodeId);
+         }
+         else
+         {
+            EmitNodeIdEvent(MCU_EVT_NODE_CONNECT_TIMEOUT, nodeId);
+         }
+         break;
+      }
+      case MCU_CMD_DISCONNECT: {
+         const MCU_CMD_DISCONNECT_t *cmd = (const MCU_CMD_DISCONNECT_t *)cmdBytes;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(cmd->nodeId);
+         for (uint8_t i = 0; i < s_connectionCount; i++)
+         {
+            if (s_connections[i] == nodeId)
+            {
+               s_connections[i] = s_connections[--s_connectionCount];
+               EmitNodeDisconnected(nodeId);
+               break;
+            }
+         }
+         break;
+      }
+      case MCU_CMD_TX_PAYLOAD: {
+         const MCU_CMD_TX_PAYLOAD_t *cmd = (const MCU_CMD_TX_PAYLOAD_t *)cmdBytes;
+         if (cmd->ack)
+         {
+            // the peer acks straight away, the response carried the same sequence number
+            EmitRxAck(GetNodeIdFromArrayBytes(cmd->destNodeId), (uint8_t)(s_txSeqNum - 1u));
+         }
+         break;
+      }
+      case MCU_CMD_REMOTE_MCU_PING_REQUEST: {
+         const MCU_CMD_REMOTE_MCU_PING_REQUEST_t *cmd = (const MCU_CMD_REMOTE_MCU_PING_REQUEST_t *)cmdBytes;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(cmd->nodeId);
+         if (s_pingCount < MAX_PINGS)
+         {
+            SimPing_t *ping = &s_pings[(s_pingHead + s_pingCount) % MAX_PINGS];
+            ping->nodeId = nodeId;
+            ping->dueUs = s_nowUs + s_config.pingDelayUs;
+            s_pingCount++;
+         }
+         else
+         {
+            EmitNodeIdEvent(MCU_EVT_PING_REPLY, nodeId);
+         }
+         break;
+      }
+      default: {
+         break;
+      }
+   }
+}
+
+/**
+ * @brief  Build the response to a command
+ * @param  cmdId - command being answered
+ * @param  cmdBuf - command payload, zero filled to MCU_PROTOCOL_PAYLOAD_MAX
+ * @param  rspBuf - where to build the response payload
+ * @return response payload length
+ */
+static size_t BuildResponse(uint8_t cmdId, const uint8_t *cmdBuf, uint8_t *rspBuf)
+{
+   size_t rspLen;
+
+   switch (cmdId)
+   {
+#define SIM_RSP_LEN(name) \
+      case MCU_CMD_##name: \
+         rspLen = sizeof(MCU_RSP_##name##_t); \
+         break;
+      SIM_COMMANDS(SIM_RSP_LEN)
+#undef SIM_RSP_LEN
+      default: {
+         rspBuf[0] = MCU_RSP_UNKNOWN_COMMAND;
+         return 1u;
+      }
+   }
+
+   // every response starts with the response id and status
+   MCU_RSP_NOP_t *generic = (MCU_RSP_NOP_t *)rspBuf;
+   (void)memset(rspBuf, 0, rspLen);
+   rspBuf[0] = (uint8_t)(cmdId | MCU_RSP_MASK);
+   generic->status = STATUS_SUCCESS;
+
+   switch (cmdId)
+   {
+      case MCU_CMD_GET_FW_VERSION: {
+         MCU_RSP_GET_FW_VERSION_t *rsp = (MCU_RSP_GET_FW_VERSION_t *)rspBuf;
+         rsp->fwMajor = SIM_FW_MAJOR;
+         rsp->fwMinor = SIM_FW_MINOR;
+         (void)memset(rsp->hash, 0x5A, sizeof(rsp->hash));
+         (void)memcpy(rsp->sha, "sim00000", sizeof(rsp->sha));
+         break;
+      }
+      case MCU_CMD_GET_NODE_ROLE: {
+         MCU_RSP_GET_NODE_ROLE_t *rsp = (MCU_RSP_GET_NODE_ROLE_t *)rspBuf;
+         rsp->nodeRole = CONFIG_ROLE_CENTRAL;
+         break;
+      }
+      case MCU_CMD_GET_NODE_ID: {
+         MCU_RSP_GET_NODE_ID_t *rsp = (MCU_RSP_GET_NODE_ID_t *)rspBuf;
+         PutNodeId(rsp->nodeId, s_config.nodeId);
+         break;
+      }
+      case MCU_CMD_GET_NODE_TYPE: {
+         MCU_RSP_GET_NODE_TYPE_t *rsp = (MCU_RSP_GET_NODE_TYPE_t *)rspBuf;
+         rsp->nodeType = CONFIG_NODE_TYPE_PC_DONGLE;
+         break;
+      }
+      case MCU_CMD_GET_GAP_EVENT_LENGTH: {
+         MCU_RSP_GET_GAP_EVENT_LENGTH_t *rsp = (MCU_RSP_GET_GAP_EVENT_LENGTH_t *)rspBuf;
+         rsp->units = 6u;
+         break;
+      }
+      case MCU_CMD_GET_SCAN_PARAMS: {
+         MCU_RSP_GET_SCAN_PARAMS_t *rsp = (MCU_RSP_GET_SCAN_PARAMS_t *)rspBuf;
+         rsp->interval[0] = 160u; // 100ms in 0.625ms units
+         rsp->window[0] = 80u;
+         break;
+      }
+      case MCU_CMD_GET_ADV_PARAMS: {
+         MCU_RSP_GET_ADV_PARAMS_t *rsp = (MCU_RSP_GET_ADV_PARAMS_t *)rspBuf;
+         rsp->interval[0] = 64u;
+         break;
+      }
+      case MCU_CMD_GET_PAIR_ENTRY: {
+         MCU_RSP_GET_PAIR_ENTRY_t *rsp = (MCU_RSP_GET_PAIR_ENTRY_t *)rspBuf;
+         rsp->status = STATUS_MCU_BAD_INDEX; // the pair table is always empty
+         break;
+      }
+      case MCU_CMD_GET_CONNECTION_COUNT: {
+         MCU_RSP_GET_CONNECTION_COUNT_t *rsp = (MCU_RSP_GET_CONNECTION_COUNT_t *)rspBuf;
+         rsp->count = s_connectionCount;
+         break;
+      }
+      case MCU_CMD_GET_CONNECTION: {
+         const MCU_CMD_GET_CONNECTION_t *cmd = (const MCU_CMD_GET_CONNECTION_t *)cmdBuf;
+         MCU_RSP_GET_CONNECTION_t *rsp = (MCU_RSP_GET_CONNECTION_t *)rspBuf;
+         rsp->index = cmd->index;
+         if (cmd->index < s_connectionCount)
+         {
+            PutNodeId(rsp->nodeId, s_connections[cmd->index]);
+         }
+         else
+         {
+            rsp->status = STATUS_MCU_BAD_INDEX;
+         }
+         break;
+      }
+      case MCU_CMD_GET_ADVERT_RSSI_THRESHOLD: {
+         MCU_RSP_GET_ADVERT_RSSI_THRESHOLD_t *rsp = (MCU_RSP_GET_ADVERT_RSSI_THRESHOLD_t *)rspBuf;
+         rsp->rssiThreshold = -100;
+         break;
+      }
+      case MCU_CMD_TX_PAYLOAD: {
+         MCU_RSP_TX_PAYLOAD_t *rsp = (MCU_RSP_TX_PAYLOAD_t *)rspBuf;
+         rsp->txSeqNum = s_txSeqNum++;
+         break;
+      }
+      default: {
+         break;
+      }
+   }
+
+   return rspLen;
+}
+
+/**
+ * @brief  Report the next simulated peer, round robin over nodeCount peers
+ * @param  None
+ * @return None
+ */
+static void EmitNodeFound(void)
+{
+   uint32_t index = s_nextPeer;
+   s_nextPeer = (s_nextPeer + 1u) % s_config.nodeCount;
+
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_NODE_FOUND_t *evt = (MCU_EVT_NODE_FOUND_t *)buf;
+   (void)memset(buf, 0, sizeof(*evt));
+   buf[0] = MCU_EVT_NODE_FOUND;
+   evt->nodeType = (uint8_t)(CONFIG_NODE_TYPE_STIMULATOR_PRIMARY + (index % 3u));
+   PutNodeId(evt->nodeId, PeerNodeId(index));
+   evt->advData[0] = (uint8_t)index;
+   evt->advData[1] = (uint8_t)(index >> 8);
+   evt->advData[2] = 0xA5u;
+   evt->rssi = (uint8_t)(int8_t)(-40 - (int)(Random() % 50u));
+   evt->fwVersionMajor = SIM_FW_MAJOR;
+   evt->fwVersionMinor = SIM_FW_MINOR;
+   EmitEnd(sizeof(*evt), true);
+
+   s_stats.nodeFound++;
+}
+
+/**
+ * @brief  Deliver a payload from the next simulated peer. The payload starts with a little
+ *         endian sequence number so a receiver can count gaps, then a counting pattern
+ * @param  None
+ * @return None
+ */
+static void EmitRxPayload(void)
+{
+   uint32_t index = s_nextPeer;
+   s_nextPeer = (s_nextPeer + 1u) % s_config.nodeCount;
+
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_RX_PAYLOAD_t *evt = (MCU_EVT_RX_PAYLOAD_t *)buf;
+   size_t headerLen = offsetof(MCU_EVT_RX_PAYLOAD_t, payloadLen) + 1u;
+   uint8_t *payload = &buf[headerLen];
+   uint32_t seq = s_rxPayloadSeq++;
+
+   (void)memset(buf, 0, headerLen);
+   buf[0] = MCU_EVT_RX_PAYLOAD;
+   PutNodeId(evt->srcNodeId, PeerNodeId(index));
+   evt->rssi = (uint8_t)(int8_t)(-40 - (int)(Random() % 50u));
+   evt->payloadLen = s_config.rxPayloadLen;
+   for (size_t i = 0; i < s_config.rxPayloadLen; i++)
+   {
+      payload[i] = (i < 4u) ? (uint8_t)(seq >> (8u * i)) : (uint8_t)i;
+   }
+   EmitEnd(headerLen + s_config.rxPayloadLen, true);
+
+   s_stats.rxPayload++;
+}
+
+/**
+ * @brief  Emit one of the events whose only content is a node id
+ * @param  evtId - MCU_EVT_xx
+ * @param  nodeId - node the event is about
+ * @return None
+ */
+static void EmitNodeIdEvent(uint8_t evtId, NodeId_t nodeId)
+{
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_PING_REPLY_t *evt = (MCU_EVT_PING_REPLY_t *)buf;
+   (void)memset(buf, 0, sizeof(*evt));
+   buf[0] = evtId;
+   PutNodeId(evt->nodeId, nodeId);
+   EmitEnd(sizeof(*evt), false);
+}
+
+/**
+ * @brief  Announce a (re)boot of the simulated dongle
+ * @param  None
+ * @return None
+ */
+static void EmitBleReboot(void)
+{
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_BLE_REBOOT_t *evt = (MCU_EVT_BLE_REBOOT_t *)buf;
+   (void)memset(buf, 0, sizeof(*evt));
+   buf[0] = MCU_EVT_BLE_REBOOT;
+   evt->nodeRole = CONFIG_ROLE_CENTRAL;
+   evt->nodeType = CONFIG_NODE_TYPE_PC_DONGLE;
+   PutNodeId(evt->nodeId, s_config.nodeId);
+   evt->fwMajor = SIM_FW_MAJOR;
+   evt->fwMinor = SIM_FW_MINOR;
+   EmitEnd(sizeof(*evt), false);
+}
+
+/**
+ * @brief  Report a connection with 7.5ms interval, no latency and a 4s supervision timeout
+ * @param  nodeId - connected node
+ * @return None
+ */
+static void EmitNodeConnected(NodeId_t nodeId)
+{
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_NODE_CONNECTED_t *evt = (MCU_EVT_NODE_CONNECTED_t *)buf;
+   (void)memset(buf, 0, sizeof(*evt));
+   buf[0] = MCU_EVT_NODE_CONNECTED;
+   PutNodeId(evt->nodeId, nodeId);
+   evt->minConnIntvl[0] = 6u;
+   evt->maxConnIntvl[0] = 6u;
+   evt->supTimeout[0] = (uint8_t)400u;
+   evt->supTimeout[1] = (uint8_t)(400u >> 8);
+   EmitEnd(sizeof(*evt), false);
+}
+
+/**
+ * @brief  Report a host initiated disconnection
+ * @param  nodeId - disconnected node
+ * @return None
+ */
+static void EmitNodeDisconnected(NodeId_t nodeId)
+{
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_NODE_DISCONNECTED_t *evt = (MCU_EVT_NODE_DISCONNECTED_t *)buf;
+   (void)memset(buf, 0, sizeof(*evt));
+   buf[0] = MCU_EVT_NODE_DISCONNECTED;
+   PutNodeId(evt->nodeId, nodeId);
+   evt->reason = DISCONNECT_REASON;
+   EmitEnd(sizeof(*evt), false);
+}
+
+/**
+ * @brief  Report the peer acknowledging a payload
+ * @param  srcNodeId - node that acked
+ * @param  txSeqNum - sequence number from the MCU_RSP_TX_PAYLOAD
+ * @return None
+ */
+static void EmitRxAck(NodeId_t srcNodeId, uint8_t txSeqNum)
+{
+   uint8_t *buf = EmitBegin();
+   MCU_EVT_RX_ACK_t *evt = (MCU_EVT_RX_ACK_t *)buf;
+   (void)memset(buf, 0, sizeof(*evt));
+   buf[0] = MCU_EVT_RX_ACK;
+   PutNodeId(evt->srcNodeId, srcNodeId);
+   evt->txSeqNum = txSeqNum;
+   EmitEnd(sizeof(*evt), false);
+}
+
+/**
+ * @brief  Emit however many events of a storm are due so the rate holds on average
+ *         regardless of how often the caller ticks
+ * @param  nowUs - current time
+ * @param  perSec - storm rate, 0 for none
+ * @param  sent - events of this storm emitted so far
+ * @param  emit - emits one event
+ * @return None
+ */
+static void Storm(uint64_t nowUs, uint32_t perSec, uint64_t *sent, void (*emit)(void))
+{
+   if (0u == perSec)
+   {
+      return;
+   }
+
+   uint64_t elapsedUs = nowUs - s_startUs;
+   uint64_t due = ((elapsedUs / 1000000u) * perSec) + (((elapsedUs % 1000000u) * perSec) / 1000000u);
+
+   for (uint32_t count = 0; (*sent < due) && (count < MAX_EVENTS_PER_TICK); count++)
+   {
+      emit();
+      (*sent)++;
+   }
+}
+
+/**
+ * @brief  Reserve room for a frame at the end of the output batch
+ * @param  None
+ * @return where to build the payload, MCU_PROTOCOL_PAYLOAD_MAX bytes
+ */
+static uint8_t *EmitBegin(void)
+{
+   if ((s_outLen + MAX_NOISE_BYTES + MCU_PROTOCOL_FRAME_SIZE_MAX) > sizeof(s_out))
+   {
+      Flush();
+   }
+   s_frameStart = s_outLen;
+   return &s_out[s_outLen + 3u];
+}
+
+/**
+ * @brief  Frame the payload built after EmitBegin. Storm events may be corrupted, at
+ *         corruptPerMille, with either a flipped payload bit (bad CRC) or line noise
+ *         containing a stray header byte ahead of the frame
+ * @param  payloadLen - payload bytes built
+ * @param  mayCorrupt - true for storm events, responses are never corrupted
+ * @return None
+ */
+static void EmitEnd(size_t payloadLen, bool mayCorrupt)
+{
+   uint8_t *frame = &s_out[s_frameStart];
+   bool isEvent = (0u == (frame[3] & MCU_RSP_MASK));
+   bool corrupt = mayCorrupt && ((Random() % 1000u) < s_config.corruptPerMille);
+
+   frame[0] = MCU_PROTOCOL_FRAME_HEADER1;
+   frame[1] = MCU_PROTOCOL_FRAME_HEADER2;
+   frame[2] = (uint8_t)(payloadLen + 1u); // add 1 for CRC
+   frame[3u + payloadLen] = crc8ccitt_block(0, frame, payloadLen + 3u);
+   size_t frameLen = payloadLen + FRAME_OVERHEAD;
+
+   if (corrupt)
+   {
+      uint32_t r = Random();
+      if (0u == (r & 1u))
+      {
+         frame[3u + ((r >> 1) % payloadLen)] ^= (uint8_t)(1u << ((r >> 9) & 7u));
+      }
+      else
+      {
+         size_t noiseLen = 1u + ((r >> 1) % MAX_NOISE_BYTES);
+         (void)memmove(&frame[noiseLen], frame, frameLen);
+         frame[0] = MCU_PROTOCOL_FRAME_HEADER1;
+         for (size_t i = 1; i < noiseLen; i++)
+         {
+            frame[i] = (uint8_t)Random();
+         }
+         frameLen += noiseLen;
+      }
+      s_stats.corruptFrames++;
+   }
+
+   s_outLen += frameLen;
+   if (isEvent)
+   {
+      s_stats.evtFrames++;
+   }
+}
+
+/**
+ * @brief  Hand the batched frames to the sink
+ * @param  None
+ * @return None
+ */
+static void Flush(void)
+{
+   if ((s_outLen > 0u) && (NULL != s_sink))
+   {
+      s_sink(s_out, s_outLen);
+      s_stats.txBytes += s_outLen;
+   }
+   s_outLen = 0;
+}
+
+/**
+ * @brief  Node id of a simulated peer
+ * @param  index - peer number
+ * @return node id
+ */
+static NodeId_t PeerNodeId(uint32_t index)
+{
+   return (NodeId_t)(0x100000u + index);
+}
+
+/**
+ * @brief  Store a node id in its 3 byte wire format
+ * @param  nodeIdArray - where to store it
+ * @param  nodeId - node id
+ * @return None
+ */
+static void PutNodeId(uint8_t nodeIdArray[3], NodeId_t nodeId)
+{
+   nodeIdArray[0] = GetArrayByteFromNodeId(0, nodeId);
+   nodeIdArray[1] = GetArrayByteFromNodeId(1, nodeId);
+   nodeIdArray[2] = GetArrayByteFromNodeId(2, nodeId);
+}
+
+/**
+ * @brief  xorshift32, repeatable from run to run
+ * @param  None
+ * @return next pseudo random number
+ */
+static uint32_t Random(void)
+{
+   s_random ^= s_random << 13;
+   s_random ^= s_random >> 17;
+   s_random ^= s_random << 5;
+   return s_random;
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,93 @@
+/**
+ *  @File: dongle_sim.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      dongle_sim.h
+ *
+ *  @brief     Defines the OML BLE dongle simulator API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "../../OML BLE App/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define DONGLE_SIM_DEFAULT_NODE_ID     0x00A001u
+#define DONGLE_SIM_DEFAULT_NODES       16u
+#define DONGLE_SIM_DEFAULT_PAYLOAD_LEN 32u
+#define DONGLE_SIM_MAX_NODES           4096u
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+typedef void (*DongleSimSink_t)(const void *data, size_t len);
+
+typedef struct
+{
+   NodeId_t nodeId;           // the simulated dongle's own node id
+   uint32_t nodeCount;        // peers reported by NODE_FOUND and used as RX_PAYLOAD sources
+   uint32_t nodeFoundPerSec;  // MCU_EVT_NODE_FOUND storm rate, 0 for none
+   uint32_t rxPayloadPerSec;  // MCU_EVT_RX_PAYLOAD flood rate, 0 for none
+   uint8_t rxPayloadLen;      // bytes of payload per RX_PAYLOAD, starts with a 32 bit sequence
+   uint32_t corruptPerMille;  // storm events sent with a flipped bit or preceded by noise
+   uint32_t pingDelayUs;      // time before a ping request is answered with MCU_EVT_PING_REPLY
+} DongleSimConfig_t;
+
+typedef struct
+{
+   uint64_t rxBytes;
+   uint64_t rxFrames;         // valid command frames from the host
+   uint64_t rxBadFrames;      // command frames with a bad CRC
+   uint64_t txBytes;
+   uint64_t rspFrames;
+   uint64_t evtFrames;
+   uint64_t corruptFrames;    // events deliberately damaged
+   uint64_t nodeFound;
+   uint64_t rxPayload;
+} DongleSimStats_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+void DongleSim_DefaultConfig(DongleSimConfig_t *config);
+void DongleSim_Init(const DongleSimConfig_t *config, DongleSimSink_t sink, uint64_t nowUs);
+void DongleSim_OnRxBlock(const uint8_t *data, size_t len);
+void DongleSim_Tick(uint64_t nowUs);
+void DongleSim_GetStats(DongleSimStats_t *stats);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
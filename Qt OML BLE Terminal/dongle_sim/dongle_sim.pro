@@ -0,0 +1,21 @@
+# OML BLE dongle simulator, a console tool that speaks the MCU protocol on a pseudo-terminal.
+# POSIX only (posix_openpt), builds no Qt code.
+TEMPLATE = app
+CONFIG += console c++14
+CONFIG -= app_bundle qt
+
+INCLUDEPATH += ../terminal/includes
+
+SOURCES += \
+    ../terminal/includes/crc8.cpp \
+    ../terminal/includes/debug.c \
+    ../terminal/includes/timer.c \
+    ../terminal/includes/utils.c \
+    dongle_sim.c \
+    main.c
+
+HEADERS += \
+    dongle_sim.h
+
+unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
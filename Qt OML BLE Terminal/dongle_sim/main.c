@@ -0,0 +1,309 @@
+/**
+ *  @File: main.c
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      main.c
+ *
+ *  @brief     OML BLE dongle simulator. Creates a pseudo-terminal that behaves like the Nordic
+ *             dongle so the terminal can be driven and load tested without hardware. Connect the
+ *             terminal (termios or qt backend) to the printed slave path or to the --link name
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#define _GNU_SOURCE // posix_openpt, ptsname, cfmakeraw
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "dongle_sim.h"
+#include "debug.h"
+#include "timer.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define STORM_TICK_MS      1     // how often storms are topped up while they are running
+#define IDLE_TICK_MS       10
+#define WRITE_WAIT_MS      100   // output the host does not read within this is dropped
+#define DEFAULT_STATS_MS   1000u
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void Usage(const char *prog);
+static int OpenPty(char *slavePath, size_t slavePathLen, int *slaveFd);
+static void WriteToHost(const void *data, size_t len);
+static void PrintStats(void);
+static void OnSignal(int sig);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+static int s_masterFd = -1;
+static uint64_t s_droppedBytes = 0;
+static volatile sig_atomic_t s_quit = 0;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   static const struct option options[] = {
+      { "link",          required_argument, NULL, 'l' },
+      { "node-id",       required_argument, NULL, 'i' },
+      { "nodes",         required_argument, NULL, 'n' },
+      { "found-rate",    required_argument, NULL, 'f' },
+      { "payload-rate",  required_argument, NULL, 'p' },
+      { "payload-len",   required_argument, NULL, 'L' },
+      { "corrupt",       required_argument, NULL, 'c' },
+      { "ping-delay-us", required_argument, NULL, 'd' },
+      { "stats-ms",      required_argument, NULL, 's' },
+      { "help",          no_argument,       NULL, 'h' },
+      { NULL, 0, NULL, 0 }
+   };
+
+   DongleSimConfig_t config;
+   const char *link = NULL;
+   uint32_t statsMs = DEFAULT_STATS_MS;
+   int opt;
+
+   DongleSim_DefaultConfig(&config);
+   while ((opt = getopt_long(argc, argv, "l:i:n:f:p:L:c:d:s:h", options, NULL)) != -1)
+   {
+      switch (opt)
+      {
+         case 'l': link = optarg; break;
+         case 'i': config.nodeId = (NodeId_t)strtoul(optarg, NULL, 0); break;
+         case 'n': config.nodeCount = (uint32_t)strtoul(optarg, NULL, 0); break;
+         case 'f': config.nodeFoundPerSec = (uint32_t)strtoul(optarg, NULL, 0); break;
+         case 'p': config.rxPayloadPerSec = (uint32_t)strtoul(optarg, NULL, 0); break;
+         case 'L': config.rxPayloadLen = (uint8_t)strtoul(optarg, NULL, 0); break;
+         case 'c': config.corruptPerMille = (uint32_t)strtoul(optarg, NULL, 0); break;
+         case 'd': config.pingDelayUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+         case 's': statsMs = (uint32_t)strtoul(optarg, NULL, 0); break;
+         default: Usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+   }
+
+   char slavePath[128];
+   int slaveFd = -1;
+   s_masterFd = OpenPty(slavePath, sizeof(slavePath), &slaveFd);
+   if (s_masterFd < 0)
+   {
+      return EXIT_FAILURE;
+   }
+
+   if (NULL != link)
+   {
+      (void)unlink(link);
+      if (symlink(slavePath, link) != 0)
+      {
+         LOG_ERROR("symlink %s: %s\n", link, strerror(errno));
+         link = NULL;
+      }
+   }
+
+   (void)signal(SIGINT, OnSignal);
+   (void)signal(SIGTERM, OnSignal);
+   (void)signal(SIGPIPE, SIG_IGN);
+
+   TIMER_Init();
+   DongleSim_Init(&config, WriteToHost, TIMER_NowUs());
+   LOG_INFO("dongle simulator on %s%s%s, node id %u, %u peers, NODE_FOUND %u/s, RX_PAYLOAD %u/s x %u bytes, corrupt %u/1000\n",
+            slavePath, link ? " -> " : "", link ? link : "", (unsigned)config.nodeId, (unsigned)config.nodeCount,
+            (unsigned)config.nodeFoundPerSec, (unsigned)config.rxPayloadPerSec, (unsigned)config.rxPayloadLen,
+            (unsigned)config.corruptPerMille);
+
+   bool storming = (config.nodeFoundPerSec > 0u) || (config.rxPayloadPerSec > 0u);
+   uint64_t nextStatsMs = TIMER_NowMs() + statsMs;
+
+   while (!s_quit)
+   {
+      struct pollfd pfd = { s_masterFd, POLLIN, 0 };
+      int ready = poll(&pfd, 1, storming ? STORM_TICK_MS : IDLE_TICK_MS);
+      if ((ready < 0) && (errno != EINTR))
+      {
+         LOG_ERROR("poll: %s\n", strerror(errno));
+         break;
+      }
+
+      if ((ready > 0) && (pfd.revents & POLLIN))
+      {
+         uint8_t buf[4096];
+         ssize_t n = read(s_masterFd, buf, sizeof(buf));
+         if (n > 0)
+         {
+            DongleSim_OnRxBlock(buf, (size_t)n);
+         }
+      }
+
+      DongleSim_Tick(TIMER_NowUs());
+
+      if ((statsMs > 0u) && (TIMER_NowMs() >= nextStatsMs))
+      {
+         PrintStats();
+         nextStatsMs += statsMs;
+      }
+   }
+
+   PrintStats();
+   if (NULL != link)
+   {
+      (void)unlink(link);
+   }
+   close(slaveFd);
+   close(s_masterFd);
+   return EXIT_SUCCESS;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Print the command line options
+ * @param  prog - program name
+ * @return None
+ */
+static void Usage(const char *prog)
+{
+   printf("usage: %s [options]\n"
+          "  -l, --link PATH          symlink the pty slave to PATH, e.g. /tmp/ttyOML\n"
+          "  -i, --node-id ID         node id of the simulated dongle (default 0x%06X)\n"
+          "  -n, --nodes N            simulated peers, max %u (default %u)\n"
+          "  -f, --found-rate N       MCU_EVT_NODE_FOUND per second (default 0)\n"
+          "  -p, --payload-rate N     MCU_EVT_RX_PAYLOAD per second (default 0)\n"
+          "  -L, --payload-len N      RX_PAYLOAD payload bytes (default %u)\n"
+          "  -c, --corrupt N          storm frames per 1000 corrupted (default 0)\n"
+          "  -d, --ping-delay-us N    ping reply delay (default 0)\n"
+          "  -s, --stats-ms N         stats print interval, 0 for none (default %u)\n",
+          prog, DONGLE_SIM_DEFAULT_NODE_ID, DONGLE_SIM_MAX_NODES, DONGLE_SIM_DEFAULT_NODES,
+          DONGLE_SIM_DEFAULT_PAYLOAD_LEN, DEFAULT_STATS_MS);
+}
+
+/**
+ * @brief  Create the pseudo-terminal. The slave is held open and left raw so the pty survives
+ *         the host reconnecting and never echoes frames back before the host configures it
+ * @param  slavePath - where to store the slave device path
+ * @param  slavePathLen - size of slavePath
+ * @param  slaveFd - where to store the held slave fd
+ * @return non-blocking master fd, -1 on error
+ */
+static int OpenPty(char *slavePath, size_t slavePathLen, int *slaveFd)
+{
+   int fd = posix_openpt(O_RDWR | O_NOCTTY);
+   if ((fd < 0) || (grantpt(fd) != 0) || (unlockpt(fd) != 0) || (ptsname_r(fd, slavePath, slavePathLen) != 0))
+   {
+      LOG_ERROR("pty: %s\n", strerror(errno));
+      if (fd >= 0)
+      {
+         close(fd);
+      }
+      return -1;
+   }
+
+   *slaveFd = open(slavePath, O_RDWR | O_NOCTTY);
+   if (*slaveFd >= 0)
+   {
+      struct termios tio;
+      if (tcgetattr(*slaveFd, &tio) == 0)
+      {
+         cfmakeraw(&tio);
+         (void)tcsetattr(*slaveFd, TCSANOW, &tio);
+      }
+   }
+
+   (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+   return fd;
+}
+
+/**
+ * @brief  Simulator sink, writes a batch of frames to the host
+ * @param  data - frames
+ * @param  len - number of bytes in data
+ * @return None
+ */
+static void WriteToHost(const void *data, size_t len)
+{
+   const uint8_t *pos = (const uint8_t *)data;
+
+   while (len > 0u)
+   {
+      ssize_t n = write(s_masterFd, pos, len);
+      if (n > 0)
+      {
+         pos += n;
+         len -= (size_t)n;
+      }
+      else if ((n < 0) && (errno == EINTR))
+      {
+         continue;
+      }
+      else
+      {
+         // host not reading (or not connected), do not let the storm block command handling
+         struct pollfd pfd = { s_masterFd, POLLOUT, 0 };
+         if ((n < 0) && (errno == EAGAIN) && (poll(&pfd, 1, WRITE_WAIT_MS) > 0))
+         {
+            continue;
+         }
+         s_droppedBytes += len;
+         break;
+      }
+   }
+}
+
+/**
+ * @brief  Print the simulator counters
+ * @param  None
+ * @return None
+ */
+static void PrintStats(void)
+{
+   DongleSimStats_t stats;
+   DongleSim_GetStats(&stats);
+   LOG_INFO("cmds %llu (bad %llu), rsps %llu, evts %llu (found %llu, payload %llu, corrupt %llu), tx %llu bytes, dropped %llu bytes\n",
+            (unsigned long long)stats.rxFrames, (unsigned long long)stats.rxBadFrames,
+            (unsigned long long)stats.rspFrames, (unsigned long long)stats.evtFrames,
+            (unsigned long long)stats.nodeFound, (unsigned long long)stats.rxPayload,
+            (unsigned long long)stats.corruptFrames, (unsigned long long)stats.txBytes,
+            (unsigned long long)s_droppedBytes);
+}
+
+/**
+ * @brief  SIGINT/SIGTERM handler
+ * @param  sig - signal number
+ * @return None
+ */
+static void OnSignal(int sig)
+{
+   (void)sig;
+   s_quit = 1;
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,14 @@
+# Builds the terminal and its tools
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    capture_analyzer \
+    oml_core \
+    terminal \
+    terminal_cli
+
+capture_analyzer.depends = oml_core
+terminal.depends = oml_core
+terminal_cli.depends = oml_core
+
+unix: SUBDIRS += dongle_sim
@@ -0,0 +1,13 @@
+# Links oml_core into a project one directory below the top level, as the terminal and the
+# headless terminal are. The library is built first by oml_ble_terminal.pro.
+QT += serialport
+INCLUDEPATH += $$PWD/../terminal/includes
+DEPENDPATH += $$PWD/../terminal/includes
+
+win32:CONFIG(release, debug|release): OML_CORE_DIR = $$OUT_PWD/../oml_core/release
+else:win32:CONFIG(debug, debug|release): OML_CORE_DIR = $$OUT_PWD/../oml_core/debug
+else: OML_CORE_DIR = $$OUT_PWD/../oml_core
+
+LIBS += -L$$OML_CORE_DIR -loml_core
+win32-msvc*: PRE_TARGETDEPS += $$OML_CORE_DIR/oml_core.lib
+else: PRE_TARGETDEPS += $$OML_CORE_DIR/liboml_core.a
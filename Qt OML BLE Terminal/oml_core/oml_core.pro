@@ -0,0 +1,54 @@
+# OML protocol core: serial transports, framing, decoding, command tracking, capture and the
+# link benchmarks. Qt Core only, no widgets, so the terminal, the headless terminal and any
+# benchmark or test harness link the same code. Output reaches the user through callbacks,
+# see BLEModule_SetTxSink, BLEModule_SetLogSink and BLERecord_SetNotify.
+# Link it with include(../oml_core/oml_core.pri).
+TEMPLATE = lib
+TARGET = oml_core
+QT = core serialport
+CONFIG += staticlib c++14
+
+SOURCES += \
+    ../terminal/includes/ackbench.cpp \
+    ../terminal/includes/benchmark.c \
+    ../terminal/includes/ble_module.c \
+    ../terminal/includes/blerecord.cpp \
+    ../terminal/includes/capture.cpp \
+    ../terminal/includes/cmdqueue.cpp \
+    ../terminal/includes/cmdtracker.cpp \
+    ../terminal/includes/crc8.cpp \
+    ../terminal/includes/debug.c \
+    ../terminal/includes/oml_interface.c \
+    ../terminal/includes/omllinks.cpp \
+    ../terminal/includes/payloadstats.cpp \
+    ../terminal/includes/pingbench.cpp \
+    ../terminal/includes/serial.cpp \
+    ../terminal/includes/seriallink.cpp \
+    ../terminal/includes/serialtransport_qt.cpp \
+    ../terminal/includes/serialtransport_termios.cpp \
+    ../terminal/includes/spscring.cpp \
+    ../terminal/includes/terminalcommands.cpp \
+    ../terminal/includes/timer.c \
+    ../terminal/includes/utils.c
+
+HEADERS += \
+    ../terminal/includes/ackbench.h \
+    ../terminal/includes/benchmark.h \
+    ../terminal/includes/ble_module.h \
+    ../terminal/includes/blerecord.h \
+    ../terminal/includes/capture.h \
+    ../terminal/includes/cmdqueue.h \
+    ../terminal/includes/cmdtracker.h \
+    ../terminal/includes/crc8.h \
+    ../terminal/includes/debug.h \
+    ../terminal/includes/oml_interface.h \
+    ../terminal/includes/omllinks.h \
+    ../terminal/includes/payloadstats.h \
+    ../terminal/includes/pingbench.h \
+    ../terminal/includes/serial.h \
+    ../terminal/includes/seriallink.h \
+    ../terminal/includes/serialtransport.h \
+    ../terminal/includes/spscring.h \
+    ../terminal/includes/terminalcommands.h \
+    ../terminal/includes/timer.h \
+    ../terminal/includes/utils.h
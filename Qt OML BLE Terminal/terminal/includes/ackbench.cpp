@@ -0,0 +1,349 @@
+/**
+ *  @File: ackbench.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      ackbench.cpp
+ *
+ *  @brief     Implements the acknowledged payload throughput benchmark API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "ackbench.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "cmdtracker.h"
+#include "timer.h"
+#include "utils.h"
+#include <algorithm>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define TX_PAYLOAD_HEADER 6u   // cmdId, destNodeId, ack, payloadLen
+#define PAYLOAD_LEN_MAX   (MCU_PROTOCOL_PAYLOAD_MAX - TX_PAYLOAD_HEADER)
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+typedef struct
+{
+   uint32_t token;      // passed to the command tracker to find the payload again
+   uint64_t sentUs;
+   bool accepted;       // txSeqNum is valid
+   uint8_t txSeqNum;
+} Pending_t;
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void OnTxResponse(void *ctx, CmdTrackerStatus_e status, const uint8_t *rsp, size_t rspLen, uint64_t rttUs);
+static uint64_t Percentile(const std::vector<uint64_t> &sorted, uint32_t percent);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Payloads are sent from the GUI, responses and acks arrive on the rx decode thread. The
+// window is small, so the payloads in it are kept in a vector and searched
+static std::mutex s_lock;
+static bool s_running = false;
+static NodeId_t s_nodeId = 0;
+static uint32_t s_count = 0;
+static uint32_t s_payloadLen = 0;
+static uint32_t s_window = 0;
+static uint64_t s_timeoutUs = 0;
+static uint64_t s_startUs = 0;
+static uint64_t s_endUs = 0;
+static uint32_t s_sent = 0;
+static uint32_t s_accepted = 0;
+static uint32_t s_rejected = 0;
+static uint32_t s_lost = 0;
+static uint32_t s_late = 0;
+static uint32_t s_windowMax = 0;
+static uint64_t s_ackedBytes = 0;
+static uint32_t s_nextToken = 0;  // never reset, so a response from an earlier run is not matched
+static std::vector<Pending_t> s_pending;
+static std::vector<uint64_t> s_ackUs;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Start streaming acknowledged payloads to a node, discarding the results of any
+ *         previous run
+ * @param  nodeId - node to send to
+ * @param  count - number of payloads
+ * @param  payloadLen - bytes per payload, limited to what fits in a frame
+ * @param  window - payloads sent ahead of their acks, 1 to ACK_BENCH_MAX_WINDOW
+ * @param  timeoutMs - time after which an unacknowledged payload counts as lost
+ * @return false if count or payloadLen is 0
+ */
+bool AckBench_Start(NodeId_t nodeId, uint32_t count, uint32_t payloadLen, uint32_t window, uint32_t timeoutMs)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if ((count == 0u) || (payloadLen == 0u))
+   {
+      return false;
+   }
+
+   s_nodeId = nodeId;
+   s_count = count;
+   s_payloadLen = std::min<uint32_t>(payloadLen, PAYLOAD_LEN_MAX);
+   s_window = std::min<uint32_t>(std::max<uint32_t>(window, 1u), ACK_BENCH_MAX_WINDOW);
+   s_timeoutUs = (uint64_t)((timeoutMs > 0u) ? timeoutMs : ACK_BENCH_DEFAULT_TIMEOUT_MS) * 1000u;
+   s_startUs = TIMER_NowUs();
+   s_endUs = s_startUs;
+   s_sent = 0;
+   s_accepted = 0;
+   s_rejected = 0;
+   s_lost = 0;
+   s_late = 0;
+   s_windowMax = 0;
+   s_ackedBytes = 0;
+   s_pending.clear();
+   s_ackUs.clear();
+   s_ackUs.reserve(count);
+   s_running = true;
+
+   return true;
+}
+
+/**
+ * @brief  Stop sending, payloads still waiting for an ack count as lost
+ * @param  None
+ * @return None
+ */
+void AckBench_Stop(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (s_running)
+   {
+      s_lost += (uint32_t)s_pending.size();
+      s_pending.clear();
+      s_endUs = TIMER_NowUs();
+      s_running = false;
+   }
+}
+
+/**
+ * @brief  Expire lost payloads and fill the window, call often as the window only moves here
+ * @param  None
+ * @return true while the benchmark is running
+ */
+bool AckBench_Poll(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (!s_running)
+   {
+      return false;
+   }
+
+   // payloads the dongle never answered are expired by the command tracker
+   uint64_t nowUs = TIMER_NowUs();
+   auto expired = std::remove_if(s_pending.begin(), s_pending.end(), [nowUs](const Pending_t &pending)
+   {
+      return pending.accepted && ((nowUs - pending.sentUs) >= s_timeoutUs);
+   });
+   s_lost += (uint32_t)(s_pending.end() - expired);
+   s_pending.erase(expired, s_pending.end());
+
+   while ((s_sent < s_count) && (s_pending.size() < s_window))
+   {
+      uint8_t frame[MCU_PROTOCOL_PAYLOAD_MAX];
+      MCU_CMD_TX_PAYLOAD_t *cmd = (MCU_CMD_TX_PAYLOAD_t *)frame;
+      cmd->cmdId = MCU_CMD_TX_PAYLOAD;
+      cmd->destNodeId[0] = GetArrayByteFromNodeId(0, s_nodeId);
+      cmd->destNodeId[1] = GetArrayByteFromNodeId(1, s_nodeId);
+      cmd->destNodeId[2] = GetArrayByteFromNodeId(2, s_nodeId);
+      cmd->ack = 1u;
+      cmd->payloadLen = (uint8_t)s_payloadLen;
+
+      // the payload counts up from the send number so a capture shows which one it was
+      uint8_t *payload = &cmd->payloadLen + 1u;
+      for (uint32_t i = 0; i < s_payloadLen; i++)
+      {
+         payload[i] = (uint8_t)(s_sent + i);
+      }
+
+      Pending_t pending;
+      pending.token = s_nextToken;
+      pending.sentUs = TIMER_NowUs();
+      pending.accepted = false;
+      pending.txSeqNum = 0;
+      if (CmdTracker_Send(cmd, TX_PAYLOAD_HEADER + s_payloadLen, (uint32_t)(s_timeoutUs / 1000u), OnTxResponse,
+                          (void *)(uintptr_t)pending.token) == 0u)
+      {
+         break; // too many commands outstanding, try again next poll
+      }
+      s_nextToken++;
+      s_pending.push_back(pending);
+      s_sent++;
+      s_windowMax = std::max<uint32_t>(s_windowMax, (uint32_t)s_pending.size());
+   }
+
+   if ((s_sent == s_count) && s_pending.empty())
+   {
+      s_running = false;
+   }
+   return s_running;
+}
+
+/**
+ * @brief  Called on MCU_EVT_RX_ACK, completes the payload with that sequence number
+ * @param  nodeId - node that acknowledged
+ * @param  txSeqNum - from the payload's MCU_RSP_TX_PAYLOAD
+ * @param  nowUs - TIMER_NowUs time the ack frame arrived
+ * @return None
+ */
+void AckBench_OnAck(NodeId_t nodeId, uint8_t txSeqNum, uint64_t nowUs)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (!s_running || (nodeId != s_nodeId))
+   {
+      return;
+   }
+
+   auto it = std::find_if(s_pending.begin(), s_pending.end(), [txSeqNum](const Pending_t &pending)
+   {
+      return pending.accepted && (pending.txSeqNum == txSeqNum);
+   });
+   if (it == s_pending.end())
+   {
+      s_late++;
+      return;
+   }
+
+   s_ackUs.push_back(nowUs - it->sentUs);
+   s_ackedBytes += s_payloadLen;
+   s_endUs = nowUs;
+   s_pending.erase(it);
+}
+
+/**
+ * @brief  Get the results so far
+ * @param  result - filled with the counters, ack latency and throughput
+ * @return None
+ */
+void AckBench_GetResult(AckBenchResult_t *result)
+{
+   std::vector<uint64_t> sorted;
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      result->running = s_running;
+      result->sent = s_sent;
+      result->accepted = s_accepted;
+      result->rejected = s_rejected;
+      result->acked = (uint32_t)s_ackUs.size();
+      result->lost = s_lost;
+      result->late = s_late;
+      result->outstanding = (uint32_t)s_pending.size();
+      result->windowMax = s_windowMax;
+      result->elapsedUs = (s_running ? TIMER_NowUs() : s_endUs) - s_startUs;
+      result->ackedBytes = s_ackedBytes;
+      result->offeredBytesPerSec = (result->elapsedUs > 0u) ? (uint32_t)(((uint64_t)s_sent * s_payloadLen * 1000000u) / result->elapsedUs) : 0u;
+      result->goodputBytesPerSec = (result->elapsedUs > 0u) ? (uint32_t)((s_ackedBytes * 1000000u) / result->elapsedUs) : 0u;
+      sorted = s_ackUs;
+   }
+
+   std::sort(sorted.begin(), sorted.end());
+   uint64_t totalUs = 0;
+   for (uint64_t ackUs : sorted)
+   {
+      totalUs += ackUs;
+   }
+
+   result->ackMinUs = sorted.empty() ? 0u : sorted.front();
+   result->ackMaxUs = sorted.empty() ? 0u : sorted.back();
+   result->ackMeanUs = sorted.empty() ? 0u : (totalUs / sorted.size());
+   result->ackP50Us = Percentile(sorted, 50u);
+   result->ackP99Us = Percentile(sorted, 99u);
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Command tracker completion of a payload command, records the txSeqNum the dongle
+ *         gave it or counts it rejected
+ * @param  ctx - token of the payload
+ * @param  status - eCMD_TRACKER_xx
+ * @param  rsp - MCU_RSP_TX_PAYLOAD, NULL unless status is eCMD_TRACKER_OK
+ * @param  rspLen - number of rsp bytes
+ * @param  rttUs - not used
+ * @return None
+ */
+static void OnTxResponse(void *ctx, CmdTrackerStatus_e status, const uint8_t *rsp, size_t rspLen, uint64_t rttUs)
+{
+   (void)rspLen;
+   (void)rttUs;
+   uint32_t token = (uint32_t)(uintptr_t)ctx;
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   auto it = std::find_if(s_pending.begin(), s_pending.end(), [token](const Pending_t &pending)
+   {
+      return pending.token == token;
+   });
+   if (it == s_pending.end())
+   {
+      return; // stopped or restarted since it was sent
+   }
+
+   const MCU_RSP_TX_PAYLOAD_t *txRsp = (const MCU_RSP_TX_PAYLOAD_t *)rsp;
+   if ((status == eCMD_TRACKER_OK) && (txRsp->status == STATUS_SUCCESS))
+   {
+      it->accepted = true;
+      it->txSeqNum = txRsp->txSeqNum;
+      s_accepted++;
+   }
+   else
+   {
+      s_rejected++;
+      s_pending.erase(it);
+   }
+}
+
+/**
+ * @brief  Nearest-rank percentile
+ * @param  sorted - samples in ascending order
+ * @param  percent - 0 to 100
+ * @return the sample at the percentile, 0 if there are none
+ */
+static uint64_t Percentile(const std::vector<uint64_t> &sorted, uint32_t percent)
+{
+   if (sorted.empty())
+   {
+      return 0;
+   }
+   size_t rank = ((sorted.size() * percent) + 99u) / 100u;
+   return sorted[(rank > 0u) ? (rank - 1u) : 0u];
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,93 @@
+/**
+ *  @File: ackbench.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      ackbench.h
+ *
+ *  @brief     Defines the acknowledged payload throughput benchmark API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "../../OML BLE App/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define ACK_BENCH_DEFAULT_COUNT      1000u
+#define ACK_BENCH_DEFAULT_LEN        20u
+#define ACK_BENCH_DEFAULT_WINDOW     4u
+#define ACK_BENCH_MAX_WINDOW         32u     // half the command tracker's outstanding limit
+#define ACK_BENCH_DEFAULT_TIMEOUT_MS 2000u
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+// Each payload is sent with ack = 1. MCU_RSP_TX_PAYLOAD gives it a txSeqNum and the remote
+// node's MCU_EVT_RX_ACK for that txSeqNum completes it. Ack latency runs from the command
+// being written to the ack frame arriving
+typedef struct
+{
+   bool running;
+   uint32_t sent;            // payload commands written
+   uint32_t accepted;        // given a txSeqNum by the dongle
+   uint32_t rejected;        // error status or no response from the dongle
+   uint32_t acked;
+   uint32_t lost;            // accepted but not acked before the timeout
+   uint32_t late;            // acks for no outstanding txSeqNum, after the timeout or duplicated
+   uint32_t outstanding;
+   uint32_t windowMax;       // most payloads unacknowledged at once
+   uint64_t ackMinUs;
+   uint64_t ackMeanUs;
+   uint64_t ackP50Us;
+   uint64_t ackP99Us;
+   uint64_t ackMaxUs;
+   uint64_t elapsedUs;       // start to the last ack
+   uint64_t ackedBytes;
+   uint32_t offeredBytesPerSec;  // payload bytes written per second
+   uint32_t goodputBytesPerSec;  // payload bytes acked per second
+} AckBenchResult_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+bool AckBench_Start(NodeId_t nodeId, uint32_t count, uint32_t payloadLen, uint32_t window, uint32_t timeoutMs);
+void AckBench_Stop(void);
+bool AckBench_Poll(void);
+void AckBench_OnAck(NodeId_t nodeId, uint8_t txSeqNum, uint64_t nowUs);
+void AckBench_GetResult(AckBenchResult_t *result);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
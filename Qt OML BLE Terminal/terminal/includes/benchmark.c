@@ -0,0 +1,409 @@
+/**
+ *  @File: benchmark.c
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      benchmark.c
+ *
+ *  @brief     Implements the link performance benchmark API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // posix_openpt and cfmakeraw
+#endif
+#include "benchmark.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "ble_module.h"
+#include "crc8.h"
+#include "timer.h"
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define RX_BLOCK_SIZE         512u // a typical serial read at 1 Mbaud
+#define CAPTURE_PAYLOAD_MIN   2u
+#define CAPTURE_PAYLOAD_MAX   64u
+#define CAPTURE_NOISE_EVERY   16u  // insert a junk byte between frames every n frames
+#define TIME_CHECK_BYTES      65536u // read the clock about once per this many bytes
+#define TX_BURST_FRAMES       32u  // frames committed between flushes in the tx benchmark
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+static volatile uint8_t s_crcSink = 0; // keeps the CRC benchmark loop from being optimised away
+#ifndef _WIN32
+static int s_ptyMaster = -1;
+static int s_ptySlave = -1;
+static uint64_t s_txWrites = 0;
+static bool s_txSplit = false;
+#endif
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void CountFrame(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+static size_t MakeFrame(uint8_t *frame, uint8_t payloadLen, uint32_t frameNum);
+#ifndef _WIN32
+static void PtyWrite(const void *data, size_t len);
+static bool PtySink(const void *data, size_t len);
+#endif
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Fill a buffer with a synthetic capture of valid frames and occasional line noise,
+ *         used when no recorded capture is available
+ * @param  buf - buffer to fill
+ * @param  size - size of buf in bytes
+ * @return number of bytes written, always a whole number of frames
+ */
+size_t Benchmark_MakeCapture(uint8_t *buf, size_t size)
+{
+   size_t used = 0;
+   uint8_t payloadLen = CAPTURE_PAYLOAD_MIN;
+   uint32_t frameNum = 0;
+
+   while ((used + 4u + CAPTURE_PAYLOAD_MAX + 1u) <= size)
+   {
+      if (0u == (frameNum % CAPTURE_NOISE_EVERY))
+      {
+         buf[used++] = 0x00;
+      }
+
+      used += MakeFrame(&buf[used], payloadLen, frameNum);
+
+      payloadLen = (payloadLen >= CAPTURE_PAYLOAD_MAX) ? CAPTURE_PAYLOAD_MIN : (uint8_t)(payloadLen + 1u);
+      frameNum++;
+   }
+
+   return used;
+}
+
+/**
+ * @brief  Feed a capture through the frame decoder repeatedly for at least
+ *         BENCHMARK_MIN_DURATION_MS, counting valid frames instead of handling them
+ * @param  capture - raw received bytes
+ * @param  len - number of bytes in capture
+ * @param  perByte - true to feed the decoder a byte at a time as BLEModule_OnRx does, false
+ *         to feed it blocks as BLEModule_OnRxBlock does
+ * @param  result - filled with the benchmark figures
+ * @return None
+ */
+void Benchmark_RxDecoder(const uint8_t *capture, size_t len, bool perByte, BenchmarkResult_t *result)
+{
+   BLEDecoder_t decoder;
+
+   (void)memset(result, 0, sizeof(*result));
+   BLEDecoder_Init(&decoder, CountFrame, NULL);
+
+   uint64_t startMs = TIMER_NowMs();
+   do
+   {
+      if (perByte)
+      {
+         for (size_t i = 0; i < len; i++)
+         {
+            BLEDecoder_OnRxBlock(&decoder, &capture[i], 1u, BLE_DECODER_NOW);
+         }
+      }
+      else
+      {
+         for (size_t offset = 0; offset < len; offset += RX_BLOCK_SIZE)
+         {
+            size_t blockLen = ((len - offset) < RX_BLOCK_SIZE) ? (len - offset) : RX_BLOCK_SIZE;
+            BLEDecoder_OnRxBlock(&decoder, &capture[offset], blockLen, BLE_DECODER_NOW);
+         }
+      }
+      result->iterations++;
+      result->bytes += len;
+      result->elapsedMs = TIMER_NowMs() - startMs;
+   } while ((len > 0u) && (result->elapsedMs < BENCHMARK_MIN_DURATION_MS));
+
+   result->frames = decoder.stats.frames;
+}
+
+/**
+ * @brief  Time from handing the decoder the last byte of a max-length frame to the frame
+ *         handler returning, one byte at a time as the serial port would deliver them
+ * @param  rewalk - true to add a table CRC over the whole frame at completion, which is
+ *         what the decoder did before the CRC was accumulated as bytes arrived
+ * @param  frames - number of frames to time
+ * @param  nowNs - monotonic nanosecond clock
+ * @param  result - filled with the latency figures
+ * @return None
+ */
+void Benchmark_RxLatency(bool rewalk, uint32_t frames, BenchmarkNowNs_t nowNs, BenchmarkLatency_t *result)
+{
+   uint8_t frame[MCU_PROTOCOL_FRAME_SIZE_MAX];
+   size_t frameLen = MakeFrame(frame, (uint8_t)(MCU_PROTOCOL_LENGTH_FIELD_MAX - 1u), 0);
+   BLEDecoder_t decoder;
+
+   (void)memset(result, 0, sizeof(*result));
+   result->minNs = UINT64_MAX;
+
+   BLEDecoder_Init(&decoder, CountFrame, NULL);
+
+   for (uint32_t f = 0; f < frames; f++)
+   {
+      for (size_t i = 0; i < (frameLen - 1u); i++)
+      {
+         BLEDecoder_OnRxBlock(&decoder, &frame[i], 1u, BLE_DECODER_NOW);
+      }
+
+      uint64_t startNs = nowNs();
+      if (rewalk)
+      {
+         s_crcSink = crc8ccitt_block_impl(eCRC8_IMPL_TABLE, 0, frame, frameLen - 1u);
+      }
+      BLEDecoder_OnRxBlock(&decoder, &frame[frameLen - 1u], 1u, BLE_DECODER_NOW);
+      uint64_t latencyNs = nowNs() - startNs;
+
+      result->count++;
+      result->totalNs += latencyNs;
+      result->minNs = (latencyNs < result->minNs) ? latencyNs : result->minNs;
+      result->maxNs = (latencyNs > result->maxNs) ? latencyNs : result->maxNs;
+   }
+}
+
+/**
+ * @brief  Run one CRC-8 implementation over a buffer repeatedly for at least
+ *         BENCHMARK_MIN_DURATION_MS
+ * @param  impl - implementation, must be supported
+ * @param  buf - data to checksum
+ * @param  len - number of bytes in buf
+ * @param  result - filled with the benchmark figures, frames holds the number of calls
+ * @return None
+ */
+void Benchmark_Crc8(Crc8Impl_e impl, const uint8_t *buf, size_t len, BenchmarkResult_t *result)
+{
+   (void)memset(result, 0, sizeof(*result));
+
+   uint32_t callsPerCheck = (uint32_t)(TIME_CHECK_BYTES / (len + 1u)) + 1u;
+   uint8_t crc = 0;
+   uint64_t startMs = TIMER_NowMs();
+   do
+   {
+      for (uint32_t i = 0; i < callsPerCheck; i++)
+      {
+         crc = crc8ccitt_block_impl(impl, crc, buf, len);
+      }
+      result->iterations++;
+      result->frames += callsPerCheck;
+      result->bytes += (uint64_t)callsPerCheck * len;
+      result->elapsedMs = TIMER_NowMs() - startMs;
+   } while (result->elapsedMs < BENCHMARK_MIN_DURATION_MS);
+
+   s_crcSink = crc;
+}
+
+/**
+ * @brief  Transmit frames through a pseudo terminal with the slave side in raw mode and
+ *         drained as it fills, so each write costs what a write to a serial port would
+ * @param  mode - how frames are handed to the kernel
+ * @param  payloadLen - payload bytes per frame, 1 to MCU_PROTOCOL_PAYLOAD_MAX
+ * @param  result - filled with the benchmark figures, iterations holds the number of bursts
+ * @return false if no pseudo terminal is available on this platform
+ */
+bool Benchmark_TxPty(BenchmarkTxMode_e mode, uint8_t payloadLen, BenchmarkResult_t *result)
+{
+   (void)memset(result, 0, sizeof(*result));
+
+#ifdef _WIN32
+   (void)mode;
+   (void)payloadLen;
+   return false;
+#else
+   s_ptyMaster = posix_openpt(O_RDWR | O_NOCTTY);
+   if ((s_ptyMaster < 0) || (grantpt(s_ptyMaster) != 0) || (unlockpt(s_ptyMaster) != 0))
+   {
+      if (s_ptyMaster >= 0)
+      {
+         (void)close(s_ptyMaster);
+      }
+      s_ptyMaster = -1;
+      return false;
+   }
+
+   s_ptySlave = open(ptsname(s_ptyMaster), O_RDWR | O_NOCTTY | O_NONBLOCK);
+   if (s_ptySlave < 0)
+   {
+      (void)close(s_ptyMaster);
+      s_ptyMaster = -1;
+      return false;
+   }
+
+   struct termios tio;
+   if (tcgetattr(s_ptySlave, &tio) == 0)
+   {
+      cfmakeraw(&tio);
+      (void)tcsetattr(s_ptySlave, TCSANOW, &tio);
+   }
+
+   uint8_t payload[MCU_PROTOCOL_PAYLOAD_MAX];
+   payloadLen = (payloadLen > MCU_PROTOCOL_PAYLOAD_MAX) ? MCU_PROTOCOL_PAYLOAD_MAX : payloadLen;
+   payloadLen = (payloadLen == 0u) ? 1u : payloadLen;
+   (void)memset(payload, 0, sizeof(payload));
+   payload[0] = MCU_CMD_NOP;
+
+   s_txWrites = 0;
+   s_txSplit = (mode == eBENCHMARK_TX_SPLIT);
+   BLEModule_SetTxSink(PtySink);
+   BLEModule_TxSetCoalesce(mode == eBENCHMARK_TX_COALESCE);
+
+   uint64_t startMs = TIMER_NowMs();
+   do
+   {
+      for (uint32_t i = 0; i < TX_BURST_FRAMES; i++)
+      {
+         BLEModule_Tx(payload, payloadLen);
+      }
+      BLEModule_TxFlush();
+
+      result->iterations++;
+      result->frames += TX_BURST_FRAMES;
+      result->bytes += (uint64_t)TX_BURST_FRAMES * (4u + payloadLen);
+      result->elapsedMs = TIMER_NowMs() - startMs;
+   } while (result->elapsedMs < BENCHMARK_MIN_DURATION_MS);
+
+   result->writes = s_txWrites;
+
+   BLEModule_TxSetCoalesce(false);
+   BLEModule_SetTxSink(NULL);
+   (void)close(s_ptySlave);
+   (void)close(s_ptyMaster);
+   s_ptySlave = -1;
+   s_ptyMaster = -1;
+
+   return true;
+#endif
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Build a valid frame carrying a response with a filler payload
+ * @param  frame - storage for the frame, at least payloadLen + 4 bytes
+ * @param  payloadLen - number of payload bytes, response id included
+ * @param  frameNum - varies the filler
+ * @return number of bytes in the frame
+ */
+static size_t MakeFrame(uint8_t *frame, uint8_t payloadLen, uint32_t frameNum)
+{
+   frame[0] = MCU_PROTOCOL_FRAME_HEADER1;
+   frame[1] = MCU_PROTOCOL_FRAME_HEADER2;
+   frame[2] = (uint8_t)(payloadLen + 1u); // add 1 for CRC
+   frame[3] = MCU_RSP_NOP;
+   for (uint8_t i = 1u; i < payloadLen; i++)
+   {
+      frame[3u + i] = (uint8_t)(frameNum + i);
+   }
+   frame[3u + payloadLen] = crc8ccitt_block(0, frame, 3u + payloadLen);
+
+   return 4u + payloadLen;
+}
+
+/**
+ * @brief  Frame handler used while benchmarking, does nothing so only the decoder is timed.
+ *         The decoder counts the frames
+ * @param  dec - benchmark decoder
+ * @param  buf - payload data
+ * @param  bufLen - number of payload bytes
+ * @return None
+ */
+static void CountFrame(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen)
+{
+   (void)dec;
+   (void)buf;
+   (void)bufLen;
+}
+
+#ifndef _WIN32
+/**
+ * @brief  Write all of a buffer to the pty master, draining the slave when the pty is full
+ * @param  data - bytes to write
+ * @param  len - number of bytes
+ * @return None
+ */
+static void PtyWrite(const void *data, size_t len)
+{
+   const uint8_t *p = (const uint8_t *)data;
+   uint8_t drain[4096];
+
+   while (len > 0u)
+   {
+      ssize_t n = write(s_ptyMaster, p, len);
+      s_txWrites++;
+      if (n > 0)
+      {
+         p += n;
+         len -= (size_t)n;
+      }
+      while (read(s_ptySlave, drain, sizeof(drain)) > 0)
+      {
+      }
+   }
+}
+
+/**
+ * @brief  Tx sink used while benchmarking, optionally splitting each frame the way the
+ *         transmit path used to write it
+ * @param  data - framed bytes
+ * @param  len - number of bytes
+ * @return true, PtyWrite writes everything
+ */
+static bool PtySink(const void *data, size_t len)
+{
+   const uint8_t *frame = (const uint8_t *)data;
+
+   if (s_txSplit && (len > 4u))
+   {
+      PtyWrite(frame, 3u);
+      PtyWrite(&frame[3], len - 4u);
+      PtyWrite(&frame[len - 1u], 1u);
+   }
+   else
+   {
+      PtyWrite(frame, len);
+   }
+   return true;
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
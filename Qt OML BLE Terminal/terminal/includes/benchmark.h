@@ -0,0 +1,92 @@
+/**
+ *  @File: benchmark.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      benchmark.h
+ *
+ *  @brief     Defines the link performance benchmark API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "crc8.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define BENCHMARK_MIN_DURATION_MS 1000u
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+typedef struct
+{
+   uint32_t iterations; // passes over the capture
+   uint64_t bytes;      // bytes fed to the decoder
+   uint64_t frames;     // valid frames handed out by the decoder
+   uint64_t writes;     // write system calls made, tx benchmarks only
+   uint64_t elapsedMs;  // wall time of all passes
+} BenchmarkResult_t;
+
+typedef enum
+{
+   eBENCHMARK_TX_SPLIT,    // header, payload and CRC written separately as BLEModule_Tx used to
+   eBENCHMARK_TX_SINGLE,   // one write per frame
+   eBENCHMARK_TX_COALESCE, // frames packed into one write per burst
+   eBENCHMARK_TX_COUNT
+} BenchmarkTxMode_e;
+
+typedef struct
+{
+   uint32_t count;   // frames timed
+   uint64_t minNs;
+   uint64_t maxNs;
+   uint64_t totalNs;
+} BenchmarkLatency_t;
+
+typedef uint64_t (*BenchmarkNowNs_t)(void);
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+size_t Benchmark_MakeCapture(uint8_t *buf, size_t size);
+void Benchmark_RxDecoder(const uint8_t *capture, size_t len, bool perByte, BenchmarkResult_t *result);
+void Benchmark_RxLatency(bool rewalk, uint32_t frames, BenchmarkNowNs_t nowNs, BenchmarkLatency_t *result);
+void Benchmark_Crc8(Crc8Impl_e impl, const uint8_t *buf, size_t len, BenchmarkResult_t *result);
+bool Benchmark_TxPty(BenchmarkTxMode_e mode, uint8_t payloadLen, BenchmarkResult_t *result);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -25,82 +25,101 @@
  * Module includes
  **********************************************************************************************/
 #include "ble_module.h"
-#include "..\..\OML BLE App\mcu_cmds.h"
-#include "..\..\OML BLE App\utils.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "../../OML BLE App/utils.h"
+#include "ackbench.h"
+#include "cmdtracker.h"
 #include "crc8.h"
 #include "debug.h"
+#include "payloadstats.h"
+#include "pingbench.h"
 #include "serial.h"
 #include "timer.h"
 #include <assert.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <string.h>
-#include "debug_signals_wrapper.h"
 //#include <QDebug>
 
 /**********************************************************************************************
  * Module constant defines
  **********************************************************************************************/
+#define TX_POOL_FRAMES   4u
+#define TX_COALESCE_SIZE 4096u
 
 /**********************************************************************************************
  * External functions
  **********************************************************************************************/
-//#define DBG_Evt(...) \
-//    do { \
-//        char buffer[256]; \
-//        snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
-//        emitDebugEvent(buffer); \
-//    } while(0)
-
-//#define DBG_Rsp(status, ...) \
-//    do { \
-//        char buffer[256]; \
-//        snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
-//        emitDebugResponse(buffer); \
-//    } while(0)
-
-
-#define DBG_Evt(...) \
+// Record text is produced into the caller's buffer when the record is displayed, see
+// BLEModule_FormatRecord, never on the rx path
+#define FMT(...) (void)snprintf(buf, size, __VA_ARGS__)
+
+// Responses carrying a status byte, every one but MCU_RSP_UNKNOWN_COMMAND
+#define RSP_WITH_STATUS(X) \
+   X(NOP) \
+   X(ON_MCU_RESET) \
+   X(ON_MCU_BOOTLOADER) \
+   X(ON_MCU_SLEEP) \
+   X(BLE_REBOOT) \
+   X(BLE_POWEROFF) \
+   X(BLE_UARTOFF) \
+   X(BLE_FACTORY_RESET) \
+   X(BLE_DFU_MODE) \
+   X(GET_FW_VERSION) \
+   X(SET_AUTH_KEY) \
+   X(SET_TX_POWER) \
+   X(SET_NODE_ROLE) \
+   X(GET_NODE_ROLE) \
+   X(SET_NODE_ID) \
+   X(GET_NODE_ID) \
+   X(SET_NODE_TYPE) \
+   X(GET_NODE_TYPE) \
+   X(SET_CONNECTION_PARAMS) \
+   X(SET_GAP_EVENT_LENGTH) \
+   X(GET_GAP_EVENT_LENGTH) \
+   X(SET_SCAN_PARAMS) \
+   X(GET_SCAN_PARAMS) \
+   X(SCAN) \
+   X(SET_ADV_PARAMS) \
+   X(GET_ADV_PARAMS) \
+   X(ADVERTISE) \
+   X(SET_ADVERT_DATA) \
+   X(GET_ADVERT_DATA) \
+   X(SAVE_CONFIG) \
+   X(CONNECT) \
+   X(DISCONNECT) \
+   X(PAIR) \
+   X(UNPAIR) \
+   X(UNPAIR_ALL) \
+   X(GET_PAIR_ENTRY_COUNT) \
+   X(GET_PAIR_ENTRY) \
+   X(GET_CONNECTION_COUNT) \
+   X(GET_CONNECTION) \
+   X(SET_ADVERT_RSSI_THRESHOLD) \
+   X(GET_ADVERT_RSSI_THRESHOLD) \
+   X(RADIO_TEST_DTM) \
+   X(RADIO_TEST_MOD_CARRIER) \
+   X(TX_PAYLOAD) \
+   X(REMOTE_MCU_PING_REQUEST) \
+   X(REMOTE_MCU_PING_REPLY) \
+   X(REMOTE_MCU_RESET_REQUEST) \
+   X(REMOTE_MCU_BOOTLOADER_REQUEST) \
+   X(REMOTE_MCU_RESET_NOW) \
+   X(REMOTE_BLE_DFU_MODE)
+
+#define DBG(level, ...) \
     do { \
-        char buffer[256]; \
-        int ret = snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
-        if (ret >= 0 && ret < sizeof(buffer)) { \
-            emitDebugEvent(buffer); \
-        } else { \
-            emitDebugEvent("Buffer overflow in DBG_Evt"); \
+        if (((level) >= DEBUG_LEVEL_ENABLED) && (NULL != s_logSink)) { \
+            char buffer[256]; \
+            int ret = snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
+            if (ret >= 0 && ret < sizeof(buffer)) { \
+                s_logSink((level), buffer); \
+            } else { \
+                s_logSink((level), "Buffer overflow in DBG"); \
+            } \
         } \
     } while(0)
-#define DBG(...) \
-    do { \
-        char buffer[256]; \
-        int ret = snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
-        if (ret >= 0 && ret < sizeof(buffer)) { \
-            emitDebugMain(buffer); \
-        } else { \
-            emitDebugMain("Buffer overflow in DBG_Evt"); \
-        } \
-    } while(0)
-
 
-#define DBG_Rsp(status, ...) \
-    do { \
-        char buffer[256]; \
-        int ret = snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
-        if (ret >= 0 && ret < sizeof(buffer)) { \
-            emitDebugResponse(buffer); \
-        } else { \
-            emitDebugResponse("Buffer overflow in DBG_Rsp"); \
-        } \
-    } while(0)
-#define DBG_Hex(status, ...) \
-    do { \
-        char buffer[256]; \
-        int ret = snprintf(buffer, sizeof(buffer), __VA_ARGS__); \
-        if (ret >= 0 && ret < sizeof(buffer)) { \
-            emitDebugHex(buffer); \
-        } else { \
-            emitDebugHex("Buffer overflow in DBG_Rsp"); \
-        } \
-    } while(0)
 /**********************************************************************************************
  * Module type definitions
  **********************************************************************************************/
@@ -127,169 +146,395 @@ typedef enum
 
 #pragma pack(pop)
 
+typedef struct
+{
+   bool inUse;
+   uint8_t frame[MCU_PROTOCOL_FRAME_SIZE_MAX];
+} TxFrame_t;
+
 /**********************************************************************************************
  * Module static variables
  **********************************************************************************************/
-static MCURXState_e s_rxState = eWAITING_FOR_HEADER1;
-static uint8_t s_rxFrame[MCU_PROTOCOL_FRAME_SIZE_MAX] = {0};
+static BLEDecoder_t s_decoder = { .state = eWAITING_FOR_HEADER1, .handler = BLEModule_Handler }; // the dongle link
+static TxFrame_t s_txPool[TX_POOL_FRAMES];
+static BLEModuleTxSink_t s_txSink = SerialWriteBytes;
+static BLEModuleLogSink_t s_logSink = NULL;
+static bool s_txCoalesce = false;
+static uint8_t s_txCoalesceBuf[TX_COALESCE_SIZE];
+static size_t s_txCoalesceLen = 0;
+static BLEModuleTxStats_t s_txStats = {0};
 
 /**********************************************************************************************
  * Module static function prototypes
  **********************************************************************************************/
+static void RxByte(BLEDecoder_t *dec, const uint8_t ch);
+static void OnRxFrame(BLEDecoder_t *dec, const uint8_t *frame, uint8_t calcCS);
+static void PublishRecord(const uint8_t *buf, size_t bufLen, uint8_t link, uint64_t timeUs);
+static size_t FinishFrame(uint8_t *frame, size_t payloadLen);
+static void GetRspFields(BLERecord_t *rec);
+static void GetEvtFields(BLERecord_t *rec);
+static void FormatRsp(const uint8_t *rspBuf, char *buf, size_t size);
+static void FormatEvt(const uint8_t *evtBuf, char *buf, size_t size);
 static void GetDataAsHex(const void *const data, size_t len, char *const buffer);
+static void AppendHex(char *buf, size_t size, int used, const void *data, size_t len);
 
 /**********************************************************************************************
  * Module externally exported functions
  **********************************************************************************************/
 
 /**
- * @brief  Reset the state machine
+ * @brief  Set up a decoder for a new byte stream
+ * @param  dec - decoder to set up
+ * @param  handler - called with the payload of every valid frame, BLEModule_Handler to run
+ *         the module's response and event handling
+ * @param  ctx - left in dec->ctx for the handler
+ * @return None
+ */
+void BLEDecoder_Init(BLEDecoder_t *dec, BLEDecoderFrameHandler_t handler, void *ctx)
+{
+   (void)memset(dec, 0, sizeof(*dec));
+   dec->state = eWAITING_FOR_HEADER1;
+   dec->handler = handler;
+   dec->ctx = ctx;
+}
+
+/**
+ * @brief  Drop any partly received frame, so the next byte is searched for a header. The
+ *         handler, context and counters are kept
+ * @param  dec - decoder to reset
+ * @return None
+ */
+void BLEDecoder_Reset(BLEDecoder_t *dec)
+{
+   dec->state = eWAITING_FOR_HEADER1;
+   dec->count = 0;
+   dec->rem = 0;
+   dec->crc = 0;
+}
+
+/**
+ * @brief  Set the link a decoder's stream comes from. BLEModule_Handler tags the records of
+ *         the stream with it and only runs the command tracking and benchmarks for link 0,
+ *         the primary dongle that commands are sent to
+ * @param  dec - decoder
+ * @param  link - link id, 0 after BLEDecoder_Init
+ * @return None
+ */
+void BLEDecoder_SetLink(BLEDecoder_t *dec, uint8_t link)
+{
+   dec->link = link;
+}
+
+/**
+ * @brief  Check whether a decoder is between frames. Two decoders that are both between frames
+ *         at the same point of a stream find the same frames in the rest of it, which is how
+ *         a stream cut into pieces decoded apart is joined up again
+ * @param  dec - decoder
+ * @return true if no frame is partly received
+ */
+bool BLEDecoder_IsIdle(const BLEDecoder_t *dec)
+{
+   return eWAITING_FOR_HEADER1 == dec->state;
+}
+
+/**
+ * @brief  Parse and validate a block of received bytes. Line noise between frames is skipped
+ *         with memchr and frames that arrive whole within the block are validated in place,
+ *         anything else falls through to the byte state machine so partial frames carry over
+ *         to the next call unchanged
+ * @param  dec - decoder of the stream the bytes came from
+ * @param  data - received bytes
+ * @param  len - number of bytes in data
+ * @param  timeUs - arrival time of the block, given to the handler as the frame time of every
+ *         frame completed by it. BLE_DECODER_NOW to read TIMER_NowUs as each frame completes
+ * @return None
+ */
+void BLEDecoder_OnRxBlock(BLEDecoder_t *dec, const uint8_t *data, size_t len, uint64_t timeUs)
+{
+   const uint8_t *pos = data;
+   const uint8_t *end = data + len;
+
+   DBG_TRACE(DEBUG_TRACE_RX, data, len);
+
+   dec->timeUs = timeUs;
+   dec->stats.bytes += len;
+
+   while (pos < end)
+   {
+      if (eWAITING_FOR_HEADER1 == dec->state)
+      {
+         pos = (const uint8_t *)memchr(pos, MCU_PROTOCOL_FRAME_HEADER1, (size_t)(end - pos));
+         if (NULL == pos)
+         {
+            break;
+         }
+
+         size_t avail = (size_t)(end - pos);
+         if ((avail >= sizeof(MCUProtocolHeader_t)) &&
+             (MCU_PROTOCOL_FRAME_HEADER2 == pos[1]) &&
+             (pos[2] >= MCU_PROTOCOL_LENGTH_FIELD_MIN) &&
+             (pos[2] <= MCU_PROTOCOL_LENGTH_FIELD_MAX) &&
+             (avail >= (sizeof(MCUProtocolHeader_t) + pos[2])))
+         {
+            // whole frame is in the block, no need to copy it into dec->frame
+            OnRxFrame(dec, pos, crc8ccitt_block(0, pos, pos[2] + 2u)); // 2 bytes being 2 header bytes and length byte less CRC byte
+            pos += sizeof(MCUProtocolHeader_t) + pos[2];
+            continue;
+         }
+      }
+
+      RxByte(dec, *pos++);
+   }
+}
+
+/**
+ * @brief  Reset the dongle link decoder
  * @param  None
  * @return None
  */
 void BLEModule_Init(void)
 {
-   s_rxState = eWAITING_FOR_HEADER1;
+   BLEDecoder_Init(&s_decoder, BLEModule_Handler, NULL);
 }
 
 /**
- * @brief  Parse and validate a recieved MCU Frame
+ * @brief  Parse and validate a recieved MCU Frame from the dongle link, one byte at a time
  * @param  ch - byte to process
- * @param  s_rxFrame - address of storage for rx frame
  * @return None
  */
 void BLEModule_OnRx(const uint8_t ch)
 {
-   static uint8_t lengthField = 0;
-   static uint8_t rxCount = 0;
-   static uint8_t rxRem = 0;
+   BLEDecoder_OnRxBlock(&s_decoder, &ch, 1u, BLE_DECODER_NOW);
+}
+
+/**
+ * @brief  Parse and validate a block of bytes received from the dongle link. Only the link's
+ *         rx thread may call this, other streams need a BLEDecoder_t of their own
+ * @param  data - received bytes
+ * @param  len - number of bytes in data
+ * @return None
+ */
+void BLEModule_OnRxBlock(const uint8_t *data, size_t len)
+{
+   BLEDecoder_OnRxBlock(&s_decoder, data, len, BLE_DECODER_NOW);
+}
+
+/**
+ * @brief  Transmit a payload to OMLBLE module in protocol frame format. Callers that build the
+ *         payload themselves should use BLEModule_TxAlloc/BLEModule_TxCommit to skip the copy
+ * @param  payload - payload data
+ * @param  payloadLen - number of payload bytes
+ * @return false if the frame was not sent: bad payload size, tx pool empty or port not open
+ */
+bool BLEModule_Tx(const void *payload, size_t payloadLen)
+{
+   bool sent = false;
 
-   switch (s_rxState)
+   if (payloadLen <= MCU_PROTOCOL_PAYLOAD_MAX)
    {
-      case eWAITING_FOR_HEADER1: {
-         if (MCU_PROTOCOL_FRAME_HEADER1 == ch)
-         {
-            rxCount = 0;
-            s_rxFrame[rxCount++] = ch;
-            s_rxState = eWAITING_FOR_HEADER2;
-         }
-         break;
+      uint8_t *txPayload = BLEModule_TxAlloc();
+      if (NULL != txPayload)
+      {
+         (void)memcpy(txPayload, payload, payloadLen);
+         sent = BLEModule_TxCommit(txPayload, payloadLen);
       }
-      case eWAITING_FOR_HEADER2: {
-         if (MCU_PROTOCOL_FRAME_HEADER2 == ch)
-         {
-            s_rxFrame[rxCount++] = ch;
-            s_rxState = eWAITING_FOR_LENGTH;
-         }
-         else
-         {
-            s_rxState = eWAITING_FOR_HEADER1;
-            DBG(DEBUG_LEVEL_ERROR, "%s() bad header\n", __func__);
-         }
-         break;
+      else
+      {
+         DBG(DEBUG_LEVEL_ERROR, "%s() error. tx pool empty\n", __func__);
       }
+   }
+   else
+   {
+      DBG(DEBUG_LEVEL_ERROR, "%s() error. bad payload size:%d\n", __func__, (int)payloadLen);
+   }
+   return sent;
+}
 
-      case eWAITING_FOR_LENGTH: {
-         if ((ch >= MCU_PROTOCOL_LENGTH_FIELD_MIN) &&
-             (ch <= MCU_PROTOCOL_LENGTH_FIELD_MAX))
-         {
-            s_rxFrame[rxCount++] = ch;
-            lengthField = ch;
-            rxRem = ch;
-            s_rxState = eWAITING_FOR_DATA;
-         }
-         else
-         {
-            // bad length
-            s_rxState = eWAITING_FOR_HEADER1;
-            DBG(DEBUG_LEVEL_ERROR, "%s() bad length\n", __func__);
-         }
+/**
+ * @brief  Take a frame buffer from the tx pool with the header space already reserved
+ * @param  None
+ * @return where to encode the payload, MCU_PROTOCOL_PAYLOAD_MAX bytes, NULL if the pool is empty
+ */
+void *BLEModule_TxAlloc(void)
+{
+   void *payload = NULL;
+
+   SerialTxLock();
+   for (size_t i = 0; i < TX_POOL_FRAMES; i++)
+   {
+      if (!s_txPool[i].inUse)
+      {
+         s_txPool[i].inUse = true;
+         payload = &s_txPool[i].frame[sizeof(MCUProtocolHeader_t)];
          break;
       }
+   }
+   SerialTxUnlock();
 
-      case eWAITING_FOR_DATA: {
-         s_rxFrame[rxCount++] = ch;
-         rxRem--;
+   if (NULL == payload)
+   {
+      DBG(DEBUG_LEVEL_ERROR, "%s() error. tx pool empty\n", __func__);
+   }
+   return payload;
+}
 
-         // check if we have received all the data
-         if (0 == rxRem)
+/**
+ * @brief  Frame a payload encoded in a BLEModule_TxAlloc buffer, send it with a single write
+ *         (or queue it when coalescing) and return the buffer to the pool
+ * @param  payload - buffer from BLEModule_TxAlloc
+ * @param  payloadLen - number of payload bytes encoded, 0 to just free the buffer
+ * @return false if the frame was not written, a coalesced frame counts as sent once queued
+ */
+bool BLEModule_TxCommit(void *payload, size_t payloadLen)
+{
+   TxFrame_t *tx = (TxFrame_t *)((uint8_t *)payload - sizeof(MCUProtocolHeader_t) - offsetof(TxFrame_t, frame));
+   bool sent = false;
+
+   SerialTxLock();
+   if ((payloadLen > 0u) && (payloadLen <= MCU_PROTOCOL_PAYLOAD_MAX))
+   {
+      size_t frameLen = FinishFrame(tx->frame, payloadLen);
+
+      DBG_TRACE(DEBUG_TRACE_TX, payload, payloadLen);
+
+      if (s_txCoalesce)
+      {
+         if ((s_txCoalesceLen + frameLen) > sizeof(s_txCoalesceBuf))
          {
-            uint8_t suppliedCS = ch;
-            uint8_t calcCS = crc8ccitt_block(0, s_rxFrame, lengthField + 2u); // 2 bytes being 2 header bytes and length byte less CRC byte
-            if (suppliedCS == calcCS)
-            {
-               // We have received a valid frame from MCU, extract command and call handler
-               BLEModule_Handler(&s_rxFrame[3], s_rxFrame[2] - 1u);
-            }
-            else
-            {
-               // bad checksum
-               DBG(DEBUG_LEVEL_ERROR, "%s() bad crc\n", __func__);
-            }
-            s_rxState = eWAITING_FOR_HEADER1;
-         }
-         else
-         { // carry on receiving
+            BLEModule_TxFlush();
          }
-         break;
+         (void)memcpy(&s_txCoalesceBuf[s_txCoalesceLen], tx->frame, frameLen);
+         s_txCoalesceLen += frameLen;
+         sent = true;
       }
-
-      default: {
-         s_rxState = eWAITING_FOR_HEADER1;
-         break;
+      else
+      {
+         sent = s_txSink(tx->frame, frameLen);
+         s_txStats.writes++;
       }
+      if (sent)
+      {
+         s_txStats.frames++;
+         s_txStats.bytes += frameLen;
+      }
+   }
+   else if (payloadLen > 0u)
+   {
+      DBG(DEBUG_LEVEL_ERROR, "%s() error. bad payload size:%d\n", __func__, (int)payloadLen);
    }
+
+   tx->inUse = false;
+   SerialTxUnlock();
+   return sent;
+}
+
+/**
+ * @brief  Enable or disable packing committed frames into one write per BLEModule_TxFlush
+ * @param  enable - true to coalesce, false to write each frame as it is committed
+ * @return None
+ */
+void BLEModule_TxSetCoalesce(bool enable)
+{
+   SerialTxLock();
+   if (!enable)
+   {
+      BLEModule_TxFlush();
+   }
+   s_txCoalesce = enable;
+   SerialTxUnlock();
+}
+
+/**
+ * @brief  Write any coalesced frames in a single write
+ * @param  None
+ * @return None
+ */
+void BLEModule_TxFlush(void)
+{
+   SerialTxLock();
+   if (s_txCoalesceLen > 0u)
+   {
+      (void)s_txSink(s_txCoalesceBuf, s_txCoalesceLen);
+      s_txStats.writes++;
+      s_txCoalesceLen = 0;
+   }
+   SerialTxUnlock();
 }
 
 /**
- * @brief  Transmit a payload to OMLBLE module in protocol frame format
+ * @brief  Frame a payload into a buffer of the caller's, for links other than the one
+ *         BLEModule_Tx writes to
+ * @param  frame - where to build the frame, MCU_PROTOCOL_FRAME_SIZE_MAX bytes
  * @param  payload - payload data
  * @param  payloadLen - number of payload bytes
- * @return STATUS_SUCCESS if payload transmitted, Status_t otherwise, false otherwise
+ * @return number of frame bytes to write, 0 if the payload size is bad
  */
-void BLEModule_Tx(const void *payload, size_t payloadLen)
+size_t BLEModule_EncodeFrame(uint8_t *frame, const void *payload, size_t payloadLen)
 {
-   bool ret = false;
-
-   if (payloadLen <= MCU_PROTOCOL_PAYLOAD_MAX)
+   if ((0u == payloadLen) || (payloadLen > MCU_PROTOCOL_PAYLOAD_MAX))
    {
-      MCUProtocolHeader_t header;
-      header.frameHdr1 = MCU_PROTOCOL_FRAME_HEADER1;
-      header.frameHdr2 = MCU_PROTOCOL_FRAME_HEADER2;
-      header.payloadLen = (uint8_t)(payloadLen + 1u); // add 1 for CRC
+      DBG(DEBUG_LEVEL_ERROR, "%s() error. bad payload size:%d\n", __func__, (int)payloadLen);
+      return 0;
+   }
 
-      // transmit header
-      SerialWriteBytes(&header, sizeof(header));
+   (void)memcpy(&frame[sizeof(MCUProtocolHeader_t)], payload, payloadLen);
+   return FinishFrame(frame, payloadLen);
+}
 
-      // transmit payload
-      SerialWriteBytes(payload, payloadLen);
+/**
+ * @brief  Install where framed bytes are written
+ * @param  sink - write function, NULL restores SerialWriteBytes
+ * @return None
+ */
+void BLEModule_SetTxSink(BLEModuleTxSink_t sink)
+{
+   s_txSink = (NULL != sink) ? sink : SerialWriteBytes;
+}
 
-      // calc and transmit CRC
-      uint8_t crc = crc8ccitt_block(0, &header, sizeof(header));
-      crc = crc8ccitt_block(crc, payload, payloadLen);
-      SerialWriteBytes(&crc, 1u);
-   }
-   else
+/**
+ * @brief  Install where diagnostics such as bad frames are reported
+ * @param  sink - log function, NULL to drop them
+ * @return None
+ */
+void BLEModule_SetLogSink(BLEModuleLogSink_t sink)
+{
+   s_logSink = sink;
+}
+
+/**
+ * @brief  Get and optionally clear the transmit counters
+ * @param  stats - filled with the counters
+ * @param  clear - true to zero the counters afterwards
+ * @return None
+ */
+void BLEModule_GetTxStats(BLEModuleTxStats_t *stats, bool clear)
+{
+   SerialTxLock();
+   *stats = s_txStats;
+   if (clear)
    {
-      DBG(DEBUG_LEVEL_ERROR, "%s() error. bad payload size:%d\n", __func__, (int)payloadLen);
+      (void)memset(&s_txStats, 0, sizeof(s_txStats));
    }
+   SerialTxUnlock();
 }
 
 /**
- * @brief  Called on receipt of a payload from OML BLE in a valid packet
+ * @brief  Called on receipt of a payload from OML BLE in a valid packet, the frame handler of
+ *         the dongle link
+ * @param  dec - decoder that validated the frame
  * @param  buf - payload data
  * @param  bufLen - number of payload bytes
  * @return None
  */
-void BLEModule_Handler(const uint8_t *buf, size_t bufLen)
+void BLEModule_Handler(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen)
 {
    if (buf[0] & MCU_RSP_MASK)
    {
-      BLEModule_RspHandler(buf, bufLen);
+      BLEModule_RspHandler(buf, bufLen, dec->link, dec->frameUs);
    }
    else
    {
-      BLEModule_EvtHandler(buf, bufLen);
+      BLEModule_EvtHandler(buf, bufLen, dec->link, dec->frameUs);
    }
 }
 
@@ -297,876 +542,1307 @@ void BLEModule_Handler(const uint8_t *buf, size_t bufLen)
  * @brief  Called on receipt of a command response from the OM BLE module
  * @param  rspBuf - response payload data
  * @param  rspBufLen - size of rspBuf in bytes
+ * @param  link - dongle the response came from, commands are only tracked on link 0
+ * @param  rxUs - time the frame arrived
  * @return None
  */
-void BLEModule_RspHandler(const uint8_t *rspBuf, size_t rspBufLen)
+void BLEModule_RspHandler(const uint8_t *rspBuf, size_t rspBufLen, uint8_t link, uint64_t rxUs)
 {
    assert(0 != (rspBuf[0] & MCU_RSP_MASK));
 
-   switch (rspBuf[0])
+   if (0u == link)
    {
-      case MCU_RSP_NOP: {
-         const MCU_RSP_NOP_t *rsp = (MCU_RSP_NOP_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_NOP. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      (void)CmdTracker_OnResponse(rspBuf, rspBufLen, rxUs);
+   }
+
+   PublishRecord(rspBuf, rspBufLen, link, rxUs);
+}
+
+/**
+ * @brief  Called on receipt of an event from the OM BLE module
+ * @param  evtBuf - event payload data
+ * @param  evtBufLen - size of evtBuf in bytes
+ * @param  link - dongle the event came from, the benchmarks only run on link 0
+ * @param  rxUs - time the frame arrived
+ * @return None
+ */
+void BLEModule_EvtHandler(const uint8_t *evtBuf, size_t evtBufLen, uint8_t link, uint64_t rxUs)
+{
+   assert(0 == (evtBuf[0] & MCU_RSP_MASK));
+
+   // the benchmarks drive link 0, payload statistics are per node whichever link heard it
+   if ((MCU_EVT_PING_REPLY == evtBuf[0]) && (0u == link))
+   {
+      const MCU_EVT_PING_REPLY_t *evt = (const MCU_EVT_PING_REPLY_t *)evtBuf;
+      PingBench_OnReply(GetNodeIdFromArrayBytes(evt->nodeId), rxUs);
+   }
+   else if ((MCU_EVT_RX_ACK == evtBuf[0]) && (0u == link))
+   {
+      const MCU_EVT_RX_ACK_t *evt = (const MCU_EVT_RX_ACK_t *)evtBuf;
+      AckBench_OnAck(GetNodeIdFromArrayBytes(evt->srcNodeId), evt->txSeqNum, rxUs);
+   }
+   else if (MCU_EVT_RX_PAYLOAD == evtBuf[0])
+   {
+      const MCU_EVT_RX_PAYLOAD_t *evt = (const MCU_EVT_RX_PAYLOAD_t *)evtBuf;
+      PayloadStats_OnRxPayload(GetNodeIdFromArrayBytes(evt->srcNodeId), evt->payloadLen, (int8_t)evt->rssi, rxUs);
+   }
+
+   PublishRecord(evtBuf, evtBufLen, link, rxUs);
+}
+
+/**
+ * @brief  Fill in a record from a frame payload, with the fields the GUI sorts and filters on
+ *         pulled out
+ * @param  rec - record to fill in
+ * @param  buf - frame payload, a response or an event
+ * @param  bufLen - number of bytes in buf
+ * @param  timeUs - frame arrival time
+ * @return None
+ */
+void BLEModule_FillRecord(BLERecord_t *rec, const uint8_t *buf, size_t bufLen, uint64_t timeUs)
+{
+   if (bufLen > sizeof(rec->data))
+   {
+      bufLen = sizeof(rec->data);
+   }
+
+   rec->timeUs = timeUs;
+   rec->link = 0;
+   rec->kind = (buf[0] & MCU_RSP_MASK) ? eBLE_RECORD_RSP : eBLE_RECORD_EVT;
+   rec->id = buf[0];
+   rec->status = STATUS_SUCCESS;
+   rec->rssi = 0;
+   rec->nodeId = 0;
+   rec->nodeType = CONFIG_NODE_TYPE_NONE;
+   rec->len = (uint8_t)bufLen;
+   (void)memcpy(rec->data, buf, bufLen);
+   (void)memset(&rec->data[bufLen], 0, sizeof(rec->data) - bufLen); // short frames read as zero
+
+   if (eBLE_RECORD_RSP == rec->kind)
+   {
+      GetRspFields(rec);
+   }
+   else
+   {
+      GetEvtFields(rec);
+   }
+}
+
+/**
+ * @brief  Format a decoded record as the text the terminal shows for it. Called by the GUI
+ *         when the record is displayed, so the rx path never formats
+ * @param  rec - record from BLERecord_Peek
+ * @param  buf - where to store the text, truncated to fit
+ * @param  size - size of buf in bytes
+ * @return None
+ */
+void BLEModule_FormatRecord(const BLERecord_t *rec, char *buf, size_t size)
+{
+   buf[0] = '\0';
+   if (eBLE_RECORD_RSP == rec->kind)
+   {
+      FormatRsp(rec->data, buf, size);
+   }
+   else
+   {
+      FormatEvt(rec->data, buf, size);
+   }
+}
+
+/**
+ * @brief  Call to get the description of the node type
+ * @param  nodeType - the node type
+ * @return String with description of node type if known
+ */
+const char *BLEModule_GetNodeType(NodeType_t nodeType)
+{
+   const char *ret;
+   switch (nodeType)
+   {
+      case CONFIG_NODE_TYPE_NONE:
+         ret = "None";
          break;
-      }
-      case MCU_RSP_ON_MCU_RESET: {
-         const MCU_RSP_ON_MCU_RESET_t *rsp = (MCU_RSP_ON_MCU_RESET_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_ON_MCU_RESET. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      case CONFIG_NODE_TYPE_STIMULATOR_PRIMARY:
+         ret = "Stim1";
          break;
-      }
-      case MCU_RSP_ON_MCU_BOOTLOADER: {
-         const MCU_RSP_ON_MCU_BOOTLOADER_t *rsp = (MCU_RSP_ON_MCU_BOOTLOADER_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_ON_MCU_BOOTLOADER. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      case CONFIG_NODE_TYPE_STIMULATOR_SECONDARY:
+         ret = "Stim2";
          break;
-      }
-      case MCU_RSP_ON_MCU_SLEEP: {
-         const MCU_RSP_ON_MCU_SLEEP_t *rsp = (MCU_RSP_ON_MCU_SLEEP_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_ON_MCU_SLEEP. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      case CONFIG_NODE_TYPE_FOOTSWITCH:
+         ret = "Foot";
          break;
-      }
-      case MCU_RSP_BLE_REBOOT: {
-         const MCU_RSP_BLE_REBOOT_t *rsp = (MCU_RSP_BLE_REBOOT_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_BLE_REBOOT. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      case CONFIG_NODE_TYPE_PC_DONGLE:
+         ret = "Dongle";
          break;
-      }
-      case MCU_RSP_BLE_POWEROFF: {
-         const MCU_RSP_BLE_POWEROFF_t *rsp = (MCU_RSP_BLE_POWEROFF_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_BLE_POWEROFF. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      case CONFIG_NODE_TYPE_SMARTPHONE:
+         ret = "Phone";
          break;
-      }
-      case MCU_RSP_BLE_UARTOFF: {
-         const MCU_RSP_BLE_UARTOFF_t *rsp = (MCU_RSP_BLE_UARTOFF_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_BLE_UARTOFF. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
-         break;
-      }
-      case MCU_RSP_BLE_FACTORY_RESET: {
-         const MCU_RSP_BLE_FACTORY_RESET_t *rsp = (MCU_RSP_BLE_FACTORY_RESET_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_BLE_FACTORY_RESET. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      case CONFIG_NODE_TYPE_MCU_UPGRADE_TARGET:
+         ret = "MCU Upgrade Mode";
          break;
-      }
-      case MCU_RSP_BLE_DFU_MODE: {
-         const MCU_RSP_BLE_DFU_MODE_t *rsp = (MCU_RSP_BLE_DFU_MODE_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_BLE_DFU_MODE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+
+      default:
+         ret = "Unknown";
          break;
-      }
-      case MCU_RSP_GET_FW_VERSION: {
-         const MCU_RSP_GET_FW_VERSION_t *rsp = (MCU_RSP_GET_FW_VERSION_t *)rspBuf;
+   }
 
-         char hashStr[80];
-         GetDataAsHex(rsp->hash, sizeof(rsp->hash), hashStr);
+   return ret;
+}
 
-         char shaStr[20];
-         (void)memcpy(shaStr, rsp->sha, sizeof(rsp->sha));
-         shaStr[sizeof(rsp->sha)] = '\0';
+/**
+ * @brief  Call to get the description of the node role
+ * @param  nodeRole - the node role
+ * @return String with description of node role if known
+ */
+const char *BLEModule_GetNodeRole(NodeRole_t nodeRole)
+{
+   const char *ret;
+   switch (nodeRole)
+   {
+      case CONFIG_ROLE_CENTRAL:
+         ret = "Central";
+         break;
 
-         if (rsp->shaDirty)
-         {
-            (void)strcat(shaStr, "+");
-         }
+      case CONFIG_ROLE_PERIPHERAL:
+         ret = "Periph";
+         break;
 
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_FW_VERSION.\nVersion:%d.%d\nHash:%s\nSHA:%s\nStatus:x%X (%s)\n", rsp->fwMajor, rsp->fwMinor, hashStr, shaStr, rsp->status, BLEModule_GetStatusString(rsp->status));
+      default:
+         ret = "Unknown";
          break;
-      }
-      case MCU_RSP_SET_AUTH_KEY: {
-         const MCU_RSP_SET_AUTH_KEY_t *rsp = (MCU_RSP_SET_AUTH_KEY_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_AUTH_KEY. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+   }
+   return ret;
+}
+
+/**
+ * @brief  Call to get the description of the disconnect reason
+ * @param  reason - the disconnect reason
+ * @return String with description of disconnect reason if known
+ */
+const char *BLEModule_GetDisconnectReason(uint8_t reason)
+{
+   const char *ret;
+   switch (reason)
+   {
+      case BLE_HCI_STATUS_CODE_SUCCESS:
+         ret = "BLE_HCI_STATUS_CODE_SUCCESS";
          break;
-      }
-      case MCU_RSP_SET_TX_POWER: {
-         const MCU_RSP_SET_TX_POWER_t *rsp = (MCU_RSP_SET_TX_POWER_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_TX_POWER. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_STATUS_CODE_UNKNOWN_BTLE_COMMAND:
+         ret = "BLE_HCI_STATUS_CODE_UNKNOWN_BTLE_COMMAND";
          break;
-      }
-      case MCU_RSP_SET_NODE_ROLE: {
-         const MCU_RSP_SET_NODE_ROLE_t *rsp = (MCU_RSP_SET_NODE_ROLE_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_NODE_ROLE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_STATUS_CODE_UNKNOWN_CONNECTION_IDENTIFIER:
+         ret = "BLE_HCI_STATUS_CODE_UNKNOWN_CONNECTION_IDENTIFIER";
          break;
-      }
-      case MCU_RSP_GET_NODE_ROLE: {
-         const MCU_RSP_GET_NODE_ROLE_t *rsp = (MCU_RSP_GET_NODE_ROLE_t *)rspBuf;
-         NodeRole_t nodeRole = (NodeRole_t)rsp->nodeRole;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_NODE_ROLE. NodeRole:%d (%s), Status:x%X (%s)\n", nodeRole, BLEModule_GetNodeRole(nodeRole), rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_AUTHENTICATION_FAILURE:
+         ret = "BLE_HCI_AUTHENTICATION_FAILURE";
          break;
-      }
-      case MCU_RSP_SET_NODE_ID: {
-         const MCU_RSP_SET_NODE_ID_t *rsp = (MCU_RSP_SET_NODE_ID_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_NODE_ID. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_STATUS_CODE_PIN_OR_KEY_MISSING:
+         ret = "BLE_HCI_STATUS_CODE_PIN_OR_KEY_MISSING";
          break;
-      }
-      case MCU_RSP_GET_NODE_ID: {
-         const MCU_RSP_GET_NODE_ID_t *rsp = (MCU_RSP_GET_NODE_ID_t *)rspBuf;
-         NodeId_t nodeId = (NodeId_t)GetNodeIdFromArrayBytes(rsp->nodeId);
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_NODE_ID. NodeId:%d, Status:x%X (%s)\n", nodeId, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_MEMORY_CAPACITY_EXCEEDED:
+         ret = "BLE_HCI_MEMORY_CAPACITY_EXCEEDED";
          break;
-      }
-      case MCU_RSP_SET_NODE_TYPE: {
-         const MCU_RSP_SET_NODE_TYPE_t *rsp = (MCU_RSP_SET_NODE_TYPE_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_NODE_TYPE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_CONNECTION_TIMEOUT:
+         ret = "BLE_HCI_CONNECTION_TIMEOUT";
          break;
-      }
-      case MCU_RSP_GET_NODE_TYPE: {
-         const MCU_RSP_GET_NODE_TYPE_t *rsp = (MCU_RSP_GET_NODE_TYPE_t *)rspBuf;
-         NodeType_t nodeType = (NodeType_t)rsp->nodeType;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_NODE_TYPE. NodeType:%d (%s), Status:x%X (%s)\n", nodeType, BLEModule_GetNodeType(nodeType), rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_STATUS_CODE_COMMAND_DISALLOWED:
+         ret = "BLE_HCI_STATUS_CODE_COMMAND_DISALLOWED";
          break;
-      }
-      case MCU_RSP_SET_CONNECTION_PARAMS: {
-         const MCU_RSP_SET_CONNECTION_PARAMS_t *rsp = (MCU_RSP_SET_CONNECTION_PARAMS_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_CONNECTION_PARAMS. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_STATUS_CODE_INVALID_BTLE_COMMAND_PARAMETERS:
+         ret = "BLE_HCI_STATUS_CODE_INVALID_BTLE_COMMAND_PARAMETERS";
          break;
-      };
-      case MCU_RSP_SET_GAP_EVENT_LENGTH: {
-         const MCU_RSP_SET_GAP_EVENT_LENGTH_t *rsp = (MCU_RSP_SET_GAP_EVENT_LENGTH_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_GAP_EVENT_LENGTH. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION:
+         ret = "BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION";
          break;
-      }
-      case MCU_RSP_GET_GAP_EVENT_LENGTH: {
-         const MCU_RSP_GET_GAP_EVENT_LENGTH_t *rsp = (MCU_RSP_GET_GAP_EVENT_LENGTH_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_GAP_EVENT_LENGTH. Units:%d. Status:x%X (%s)\n", rsp->units, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_LOW_RESOURCES:
+         ret = "BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_LOW_RESOURCES";
          break;
-      }
-      case MCU_RSP_SET_SCAN_PARAMS: {
-         const MCU_RSP_SET_SCAN_PARAMS_t *rsp = (MCU_RSP_SET_SCAN_PARAMS_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_SCAN_PARAMS. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_POWER_OFF:
+         ret = "BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_POWER_OFF";
          break;
-      }
-      case MCU_RSP_GET_SCAN_PARAMS: {
-         const MCU_RSP_GET_SCAN_PARAMS_t *rsp = (MCU_RSP_GET_SCAN_PARAMS_t *)rspBuf;
-
-         uint16_t timeout = rsp->timeout[1];
-         timeout <<= 8;
-         timeout |= rsp->timeout[0];
-
-         uint16_t window = rsp->window[1];
-         window <<= 8;
-         window |= rsp->window[0];
-
-         uint16_t interval = rsp->interval[1];
-         interval <<= 8;
-         interval |= rsp->interval[0];
-
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_SCAN_PARAMS. Timeout:%d, Window:%d, Interval:%d, Status:x%X (%s)\n",
-                 timeout, window, interval, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION:
+         ret = "BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION";
          break;
-      }
-      case MCU_RSP_SCAN: {
-         const MCU_RSP_SCAN_t *rsp = (MCU_RSP_SCAN_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SCAN. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_UNSUPPORTED_REMOTE_FEATURE:
+         ret = "BLE_HCI_UNSUPPORTED_REMOTE_FEATURE";
          break;
-      }
-      case MCU_RSP_SET_ADV_PARAMS: {
-         const MCU_RSP_SET_ADV_PARAMS_t *rsp = (MCU_RSP_SET_ADV_PARAMS_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_ADV_PARAMS. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case BLE_HCI_STATUS_CODE_LMP_RESPONSE_TIMEOUT:
+         ret = "BLE_HCI_STATUS_CODE_LMP_RESPONSE_TIMEOUT";
          break;
-      }
-      case MCU_RSP_GET_ADV_PARAMS: {
-         const MCU_RSP_GET_ADV_PARAMS_t *rsp = (MCU_RSP_GET_ADV_PARAMS_t *)rspBuf;
-
-         uint32_t interval = rsp->interval[3];
-         interval <<= 8;
-         interval |= rsp->interval[2];
-         interval <<= 8;
-         interval |= rsp->interval[1];
-         interval <<= 8;
-         interval |= rsp->interval[0];
-
-         uint16_t duration = rsp->duration[1];
-         duration <<= 8;
-         duration |= rsp->duration[0];
+      case BLE_HCI_STATUS_CODE_LMP_ERROR_TRANSACTION_COLLISION:
+         ret = "BLE_HCI_STATUS_CODE_LMP_ERROR_TRANSACTION_COLLISION";
+         break;
+      case BLE_HCI_STATUS_CODE_LMP_PDU_NOT_ALLOWED:
+         ret = "BLE_HCI_STATUS_CODE_LMP_PDU_NOT_ALLOWED";
+         break;
+      case BLE_HCI_INSTANT_PASSED:
+         ret = "BLE_HCI_INSTANT_PASSED";
+         break;
+      case BLE_HCI_PAIRING_WITH_UNIT_KEY_UNSUPPORTED:
+         ret = "BLE_HCI_PAIRING_WITH_UNIT_KEY_UNSUPPORTED";
+         break;
+      case BLE_HCI_DIFFERENT_TRANSACTION_COLLISION:
+         ret = "BLE_HCI_DIFFERENT_TRANSACTION_COLLISION";
+         break;
+      case BLE_HCI_PARAMETER_OUT_OF_MANDATORY_RANGE:
+         ret = "BLE_HCI_PARAMETER_OUT_OF_MANDATORY_RANGE";
+         break;
+      case BLE_HCI_CONTROLLER_BUSY:
+         ret = "BLE_HCI_CONTROLLER_BUSY";
+         break;
+      case BLE_HCI_CONN_INTERVAL_UNACCEPTABLE:
+         ret = "BLE_HCI_CONN_INTERVAL_UNACCEPTABLE";
+         break;
+      case BLE_HCI_DIRECTED_ADVERTISER_TIMEOUT:
+         ret = "BLE_HCI_DIRECTED_ADVERTISER_TIMEOUT";
+         break;
+      case BLE_HCI_CONN_TERMINATED_DUE_TO_MIC_FAILURE:
+         ret = "BLE_HCI_CONN_TERMINATED_DUE_TO_MIC_FAILURE";
+         break;
+      case BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED:
+         ret = "BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED";
+         break;
+      default:
+         ret = "Unknown";
+         break;
+   }
+   return ret;
+}
 
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_ADV_PARAMS. Interval:%d, Duration:%d, Status:x%X (%s)\n",
-                 interval, duration, rsp->status, BLEModule_GetStatusString(rsp->status));
+/**
+ * @brief  Call to get the description of the status
+ * @param  status - the status
+ * @return String with description of status if known
+ */
+const char *BLEModule_GetStatusString(Status_t status)
+{
+   const char *ret;
+   switch (status)
+   {
+      case STATUS_SUCCESS:
+         ret = "STATUS_SUCCESS";
          break;
-      }
-      case MCU_RSP_ADVERTISE: {
-         const MCU_RSP_ADVERTISE_t *rsp = (MCU_RSP_ADVERTISE_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_ADVERTISE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_ERROR:
+         ret = "STATUS_ERROR";
          break;
-      }
-      case MCU_RSP_SET_ADVERT_DATA: {
-         const MCU_RSP_SET_ADVERT_DATA_t *rsp = (MCU_RSP_SET_ADVERT_DATA_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_ADVERT_DATA. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_NOT_INIT:
+         ret = "STATUS_NOT_INIT";
          break;
-      }
-      case MCU_RSP_GET_ADVERT_DATA: {
-         const MCU_RSP_GET_ADVERT_DATA_t *rsp = (MCU_RSP_GET_ADVERT_DATA_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_ADVERT_DATA. Data:[0]%d [1]%d [2]%d, Status:x%X (%s)\n", rsp->advData[0], rsp->advData[1], rsp->advData[2], rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BUSY:
+         ret = "STATUS_BUSY";
          break;
-      }
-      case MCU_RSP_SAVE_CONFIG: {
-         const MCU_RSP_SAVE_CONFIG_t *rsp = (MCU_RSP_SAVE_CONFIG_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SAVE_CONFIG. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_NVM_FAIL:
+         ret = "STATUS_NVM_FAIL";
          break;
-      }
-      case MCU_RSP_CONNECT: {
-         const MCU_RSP_CONNECT_t *rsp = (MCU_RSP_CONNECT_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_CONNECT. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_CONFIG_CRC_FAIL:
+         ret = "STATUS_CONFIG_CRC_FAIL";
          break;
-      }
-      case MCU_RSP_DISCONNECT: {
-         const MCU_RSP_DISCONNECT_t *rsp = (MCU_RSP_DISCONNECT_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_DISCONNECT. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_CONFIG_NOT_FOUND:
+         ret = "STATUS_CONFIG_NOT_FOUND";
          break;
-      }
-      case MCU_RSP_PAIR: {
-         const MCU_RSP_PAIR_t *rsp = (MCU_RSP_PAIR_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_PAIR. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_UART_INIT:
+         ret = "STATUS_UART_INIT";
          break;
-      }
-      case MCU_RSP_UNPAIR: {
-         const MCU_RSP_UNPAIR_t *rsp = (MCU_RSP_UNPAIR_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_UNPAIR. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_UART_TX_OVERFLOW:
+         ret = "STATUS_UART_TX_OVERFLOW";
          break;
-      }
-      case MCU_RSP_UNPAIR_ALL: {
-         const MCU_RSP_UNPAIR_ALL_t *rsp = (MCU_RSP_UNPAIR_ALL_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_UNPAIR_ALL. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_UART_OFF:
+         ret = "STATUS_UART_OFF";
          break;
-      }
-      case MCU_RSP_GET_PAIR_ENTRY_COUNT: {
-         const MCU_RSP_GET_PAIR_ENTRY_COUNT_t *rsp = (MCU_RSP_GET_PAIR_ENTRY_COUNT_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_PAIR_ENTRY_COUNT. Count:%d, Status:x%X (%s)\n", rsp->count, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_UART_BUSY:
+         ret = "STATUS_UART_BUSY";
          break;
-      }
-      case MCU_RSP_GET_PAIR_ENTRY: {
-         const MCU_RSP_GET_PAIR_ENTRY_t *rsp = (MCU_RSP_GET_PAIR_ENTRY_t *)rspBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_PAIR_ENTRY. Index:%d, NodeType:%d (%s), NodeId:%d, Status:x%X (%s)\n", rsp->index, rsp->nodeType, BLEModule_GetNodeType(rsp->nodeType), nodeId, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_USB_NOT_CONNECTED:
+         ret = "STATUS_USB_NOT_CONNECTED";
          break;
-      }
-      case MCU_RSP_GET_CONNECTION_COUNT: {
-         const MCU_RSP_GET_CONNECTION_COUNT_t *rsp = (MCU_RSP_GET_CONNECTION_COUNT_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_CONNECTION_COUNT. Count:%d, Status:x%X (%s)\n", rsp->count, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_USB_TX_OVERFLOW:
+         ret = "STATUS_USB_TX_OVERFLOW";
          break;
-      }
-      case MCU_RSP_GET_CONNECTION: {
-         const MCU_RSP_GET_CONNECTION_t *rsp = (MCU_RSP_GET_CONNECTION_t *)rspBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_CONNECTION. Index:%d, NodeId:%d, Status:x%X (%s)\n", rsp->index, nodeId, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_USB_ERROR:
+         ret = "STATUS_USB_ERROR";
          break;
-      }
-      case MCU_RSP_SET_ADVERT_RSSI_THRESHOLD: {
-         const MCU_RSP_SET_ADVERT_RSSI_THRESHOLD_t *rsp = (MCU_RSP_SET_ADVERT_RSSI_THRESHOLD_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_SET_ADVERT_RSSI_THRESHOLD. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_USB_NOT_SUPPORTED:
+         ret = "STATUS_USB_NOT_SUPPORTED";
          break;
-      }
-      case MCU_RSP_GET_ADVERT_RSSI_THRESHOLD: {
-         const MCU_RSP_GET_ADVERT_RSSI_THRESHOLD_t *rsp = (MCU_RSP_GET_ADVERT_RSSI_THRESHOLD_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_GET_ADVERT_RSSI_THRESHOLD. RSSI Threshold:%d, Status:x%X (%s)\n", rsp->rssiThreshold, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_MCU_BAD_INDEX:
+         ret = "STATUS_MCU_BAD_INDEX";
+         break;
+      case STATUS_MCU_UNKNOWN_COMMAND:
+         ret = "STATUS_MCU_UNKNOWN_COMMAND";
+         break;
+      case STATUS_MCU_UNSUPPORTED_COMMAND:
+         ret = "STATUS_MCU_UNSUPPORTED_COMMAND";
+         break;
+      case STATUS_MCU_NOT_SUPPORTED_IN_THIS_ROLE:
+         ret = "STATUS_MCU_NOT_SUPPORTED_IN_THIS_ROLE";
+         break;
+      case STATUS_MCU_CHECK_BYTE_FAIL:
+         ret = "STATUS_MCU_CHECK_BYTE_FAIL";
+         break;
+      case STATUS_MCU_BAD_PARAM:
+         ret = "STATUS_MCU_BAD_PARAM";
+         break;
+      case STATUS_MCU_PAIR_TABLE_FULL:
+         ret = "STATUS_MCU_PAIR_TABLE_FULL";
+         break;
+      case STATUS_MCU_PAIRING_ENTRY_NOT_FOUND:
+         ret = "STATUS_MCU_PAIRING_ENTRY_NOT_FOUND";
+         break;
+      case STATUS_MCU_ALREADY_PAIRED:
+         ret = "STATUS_MCU_ALREADY_PAIRED";
+         break;
+      case STATUS_MCU_BAD_NODE_TYPE:
+         ret = "STATUS_MCU_BAD_NODE_TYPE";
+         break;
+      case STATUS_MCU_UART_OFF:
+         ret = "STATUS_UART_LINK_OFF";
+         break;
+      case STATUS_NET_PEER_NOT_CONNECTED:
+         ret = "STATUS_NET_PEER_NOT_CONNECTED";
+         break;
+      case STATUS_NET_CENTRAL_NOT_CONNECTED:
+         ret = "STATUS_NET_CENTRAL_NOT_CONNECTED";
+         break;
+      case STATUS_NET_BAD_CONNECTION_HANDLE:
+         ret = "STATUS_NET_BAD_CONNECTION_HANDLE";
+         break;
+      case STATUS_NET_UNKNOWN_CMD:
+         ret = "STATUS_NET_UNKNOWN_CMD";
+         break;
+      case STATUS_NET_UNSUPPORTED_CMD:
+         ret = "STATUS_NET_UNSUPPORTED_CMD";
+         break;
+      case STATUS_NET_NOT_SUPPORTED_IN_THIS_ROLE:
+         ret = "STATUS_NET_NOT_SUPPORTED_IN_THIS_ROLE";
+         break;
+      case STATUS_NET_BAD_PARAM:
+         ret = "STATUS_NET_BAD_PARAM";
+         break;
+      case STATUS_NET_PAIR_TABLE_FULL:
+         ret = "STATUS_NET_PAIR_TABLE_FULL";
+         break;
+      case STATUS_NET_NODE_NOT_FOUND:
+         ret = "STATUS_NET_NODE_NOT_FOUND";
+         break;
+      case STATUS_NET_ALREADY_PAIRED:
+         ret = "STATUS_NET_ALREADY_PAIRED";
+         break;
+      case STATUS_NET_CONNECTION_NOT_FOUND:
+         ret = "STATUS_NET_CONNECTION_NOT_FOUND";
+         break;
+      case STATUS_NET_SECURITY_FAILED:
+         ret = "STATUS_NET_SECURITY_FAILED";
+         break;
+      case STATUS_NET_ROUTING_ERROR:
+         ret = "STATUS_NET_ROUTING_ERROR";
+         break;
+      case STATUS_NET_MGT_PAYLOAD_CANNOT_BE_FORWARDED:
+         ret = "STATUS_NET_MGT_PAYLOAD_CANNOT_BE_FORWARDED";
          break;
-      }
-      case MCU_RSP_RADIO_TEST_DTM: {
-         const MCU_RSP_RADIO_TEST_DTM_t *rsp = (MCU_RSP_RADIO_TEST_DTM_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_RADIO_TEST_DTM. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_NET_MGT_PAYLOAD_CANNOT_BE_BROADCAST:
+         ret = "STATUS_NET_MGT_PAYLOAD_CANNOT_BE_BROADCAST";
          break;
-      }
-      case MCU_RSP_RADIO_TEST_MOD_CARRIER: {
-         const MCU_RSP_RADIO_TEST_MOD_CARRIER_t *rsp = (MCU_RSP_RADIO_TEST_MOD_CARRIER_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_RADIO_TEST_MOD_CARRIER. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_ERROR:
+         ret = "STATUS_BLE_ERROR";
          break;
-      }
-      case MCU_RSP_TX_PAYLOAD: {
-         const MCU_RSP_TX_PAYLOAD_t *rsp = (MCU_RSP_TX_PAYLOAD_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_TX_PAYLOAD. TxSeqNum:%d, Status:x%X (%s)\n", rsp->txSeqNum, rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_NOT_SUPPORTED:
+         ret = "STATUS_BLE_NOT_SUPPORTED";
          break;
-      }
-      case MCU_RSP_REMOTE_MCU_PING_REQUEST: {
-         const MCU_RSP_REMOTE_MCU_PING_REQUEST_t *rsp = (MCU_RSP_REMOTE_MCU_PING_REQUEST_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_REMOTE_MCU_PING_REQUEST. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_NOT_SUPPORTED_IN_THIS_ROLE:
+         ret = "STATUS_BLE_NOT_SUPPORTED_IN_THIS_ROLE";
          break;
-      }
-      case MCU_RSP_REMOTE_MCU_PING_REPLY: {
-         const MCU_RSP_REMOTE_MCU_PING_REPLY_t *rsp = (MCU_RSP_REMOTE_MCU_PING_REPLY_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_REMOTE_MCU_PING_REPLY. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_NODE_NOT_CONNECTED:
+         ret = "STATUS_BLE_NODE_NOT_CONNECTED";
          break;
-      }
-      case MCU_RSP_REMOTE_MCU_RESET_REQUEST: {
-         const MCU_RSP_REMOTE_MCU_RESET_REQUEST_t *rsp = (MCU_RSP_REMOTE_MCU_RESET_REQUEST_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_REMOTE_MCU_RESET_REQUEST. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_NODE_ALREADY_CONNECTED:
+         ret = "STATUS_BLE_NODE_ALREADY_CONNECTED";
          break;
-      }
-      case MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST: {
-         const MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST_t *rsp = (MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_CONNECTION_IN_PROGRESS:
+         ret = "STATUS_BLE_CONNECTION_IN_PROGRESS";
          break;
-      }
-      case MCU_RSP_REMOTE_MCU_RESET_NOW: {
-         const MCU_RSP_REMOTE_MCU_RESET_NOW_t *rsp = (MCU_RSP_REMOTE_MCU_RESET_NOW_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_REMOTE_MCU_RESET_NOW. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_BAD_PARAMETER:
+         ret = "STATUS_BLE_BAD_PARAMETER";
          break;
-      }
-      case MCU_RSP_REMOTE_BLE_DFU_MODE: {
-         const MCU_RSP_REMOTE_BLE_DFU_MODE_t *rsp = (MCU_RSP_REMOTE_BLE_DFU_MODE_t *)rspBuf;
-         DBG_Rsp(rsp->status, "MCU_RSP_REMOTE_BLE_DFU_MODE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
+      case STATUS_BLE_TX_POWER_NOT_SUPPORTED:
+         ret = "STATUS_BLE_TX_POWER_NOT_SUPPORTED";
          break;
-      }
-      case MCU_RSP_UNKNOWN_COMMAND: {
-         DBG_Rsp(STATUS_MCU_UNKNOWN_COMMAND, "MCU_RSP_UNKNOWN_COMMAND. Status:x%X (%s)\n", STATUS_MCU_UNKNOWN_COMMAND, BLEModule_GetStatusString(STATUS_MCU_UNKNOWN_COMMAND));
+      case STATUS_BLE_TEST_MODE_BAD_PATTERN:
+         ret = "STATUS_BLE_TEST_MODE_BAD_PATTERN";
          break;
-      }
-      default: {
-         DBG(DEBUG_LEVEL_ERROR, "%s() Error. Unknown response: x%02X\n", __func__, rspBuf[0]);
+      case STATUS_BLE_TEST_MODE_BAD_CHANNEL:
+         ret = "STATUS_BLE_TEST_MODE_BAD_CHANNEL";
+         break;
+      default:
+         ret = "Unknown status";
          break;
-      }
    }
+
+   return ret;
 }
 
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
 /**
- * @brief  Called on receipt of an event from the OM BLE module
- * @param  evtBuf - event payload data
- * @param  evtBufLen - size of evtBuf in bytes
+ * @brief  Run one byte through the rx frame state machine
+ * @param  dec - decoder of the stream
+ * @param  ch - byte to process
  * @return None
  */
-void BLEModule_EvtHandler(const uint8_t *evtBuf, size_t evtBufLen)
+static void RxByte(BLEDecoder_t *dec, const uint8_t ch)
 {
-   static NodeId_t lastNodeId = 0;
-   static uint8_t lastEvt = 0;
-
-   assert(0 == (evtBuf[0] & MCU_RSP_MASK));
-
-   switch (evtBuf[0])
+   switch (dec->state)
    {
-      case MCU_EVT_BLE_REBOOT: {
-         const MCU_EVT_BLE_REBOOT_t *evt = (MCU_EVT_BLE_REBOOT_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-
-         DBG_Evt("MCU_EVT_BLE_REBOOT. NodeRole:%d (%s), NodeType:%d (%s), NodeId:%d, PairedCount:%d, Version:%d.%d\n",
-                 evt->nodeRole,
-                 BLEModule_GetNodeRole(evt->nodeRole),
-                 evt->nodeType,
-                 BLEModule_GetNodeType(evt->nodeType),
-                 nodeId,
-                 evt->pairedCount,
-                 evt->fwMajor,
-                 evt->fwMinor);
-         break;
-      }
-      case MCU_EVT_BLE_POWEROFF: {
-         const MCU_EVT_BLE_POWEROFF_t *evt = (MCU_EVT_BLE_POWEROFF_t *)evtBuf;
-         DBG_Evt("MCU_EVT_BLE_POWEROFF -----\n");
-         break;
-      }
-      case MCU_EVT_MCU_RESET_REQUESTED: {
-         const MCU_EVT_MCU_RESET_REQUESTED_t *evt = (MCU_EVT_MCU_RESET_REQUESTED_t *)evtBuf;
-         (void)evt;
-         DBG_Evt("MCU_EVT_MCU_RESET_REQUESTED\n");
-         break;
-      }
-      case MCU_EVT_MCU_BOOTLOADER_REQUESTED: {
-         const MCU_EVT_MCU_BOOTLOADER_REQUESTED_t *evt = (MCU_EVT_MCU_BOOTLOADER_REQUESTED_t *)evtBuf;
-         (void)evt;
-         DBG_Evt("MCU_EVT_MCU_BOOTLOADER_REQUESTED\n");
+      case eWAITING_FOR_HEADER1: {
+         if (MCU_PROTOCOL_FRAME_HEADER1 == ch)
+         {
+            dec->count = 0;
+            dec->frame[dec->count++] = ch;
+            dec->crc = crc8ccitt_byte(0, ch);
+            dec->state = eWAITING_FOR_HEADER2;
+         }
          break;
       }
-      case MCU_EVT_NODE_FOUND: {
-         const MCU_EVT_NODE_FOUND_t *evt = (MCU_EVT_NODE_FOUND_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-#if 0 
-         //if ((lastEvt != MCU_EVT_NODE_FOUND) || (nodeId != lastNodeId))
-#endif
+      case eWAITING_FOR_HEADER2: {
+         if (MCU_PROTOCOL_FRAME_HEADER2 == ch)
          {
-            DBG_Evt("MCU_EVT_NODE_FOUND. NodeType:%d (%s), NodeId:%d, PairedNodeId:%d, AdvData:%02x%02x%02x, RSSI:%ddBm, V%d.%d\n",
-                    evt->nodeType,
-                    BLEModule_GetNodeType(evt->nodeType),
-                    nodeId,
-                    GetNodeIdFromArrayBytes(evt->pairedNodeId),
-                    evt->advData[0], evt->advData[1], evt->advData[2],
-                    (int8_t)evt->rssi,
-                    evt->fwVersionMajor, evt->fwVersionMinor);
+            dec->frame[dec->count++] = ch;
+            dec->crc = crc8ccitt_byte(dec->crc, ch);
+            dec->state = eWAITING_FOR_LENGTH;
+         }
+         else
+         {
+            dec->state = eWAITING_FOR_HEADER1;
+            dec->stats.badHeader++;
+            DBG(DEBUG_LEVEL_ERROR, "%s() bad header\n", __func__);
          }
-         lastNodeId = nodeId;
          break;
       }
-      case MCU_EVT_NODE_PAIRED: {
-         const MCU_EVT_NODE_PAIRED_t *evt = (MCU_EVT_NODE_PAIRED_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_NODE_PAIRED. NodeType:%d (%s), NodeId:%d\n", evt->nodeType, BLEModule_GetNodeType(evt->nodeType), nodeId);
+
+      case eWAITING_FOR_LENGTH: {
+         if ((ch >= MCU_PROTOCOL_LENGTH_FIELD_MIN) &&
+             (ch <= MCU_PROTOCOL_LENGTH_FIELD_MAX))
+         {
+            dec->frame[dec->count++] = ch;
+            dec->crc = crc8ccitt_byte(dec->crc, ch);
+            dec->rem = ch;
+            dec->state = eWAITING_FOR_DATA;
+         }
+         else
+         {
+            // bad length
+            dec->state = eWAITING_FOR_HEADER1;
+            dec->stats.badLength++;
+            DBG(DEBUG_LEVEL_ERROR, "%s() bad length\n", __func__);
+         }
          break;
       }
-      case MCU_EVT_NODE_PAIR_FAILED: {
-         const MCU_EVT_NODE_PAIR_FAILED_t *evt = (MCU_EVT_NODE_PAIR_FAILED_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_NODE_PAIR_FAILED. NodeType:%d (%s), NodeId:%d, Status:x%X (%s)\n", evt->nodeType, BLEModule_GetNodeType(evt->nodeType), nodeId, evt->status, BLEModule_GetStatusString(evt->status));
+
+      case eWAITING_FOR_DATA: {
+         dec->frame[dec->count++] = ch;
+         dec->rem--;
+
+         // check if we have received all the data
+         if (0 == dec->rem)
+         {
+            OnRxFrame(dec, dec->frame, dec->crc);
+            dec->state = eWAITING_FOR_HEADER1;
+         }
+         else
+         { // carry on receiving
+            dec->crc = crc8ccitt_byte(dec->crc, ch);
+         }
          break;
       }
-      case MCU_EVT_NODE_UNPAIRED: {
-         const MCU_EVT_NODE_UNPAIRED_t *evt = (MCU_EVT_NODE_UNPAIRED_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_NODE_UNPAIRED. NodeType:%d (%s), NodeId:%d\n", evt->nodeType, BLEModule_GetNodeType(evt->nodeType), nodeId);
+
+      default: {
+         dec->state = eWAITING_FOR_HEADER1;
          break;
       }
-      case MCU_EVT_NODE_CONNECTED: {
-         const MCU_EVT_NODE_CONNECTED_t *evt = (MCU_EVT_NODE_CONNECTED_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         uint16_t minConnIntvl = evt->minConnIntvl[1];
-         minConnIntvl <<= 8;
-         minConnIntvl |= evt->minConnIntvl[0];
+   }
+}
 
-         uint16_t maxConnIntvl = evt->maxConnIntvl[1];
-         maxConnIntvl <<= 8;
-         maxConnIntvl |= evt->maxConnIntvl[0];
+/**
+ * @brief  Check the CRC of a complete frame and pass its payload to the frame handler
+ * @param  dec - decoder of the stream
+ * @param  frame - frame starting at the first header byte
+ * @param  calcCS - CRC calculated over the frame, less its CRC byte
+ * @return None
+ */
+static void OnRxFrame(BLEDecoder_t *dec, const uint8_t *frame, uint8_t calcCS)
+{
+   uint8_t lengthField = frame[2];
+   uint8_t suppliedCS = frame[lengthField + 2u];
+   if (suppliedCS == calcCS)
+   {
+      // We have received a valid frame from MCU, extract command and call handler
+      dec->frameUs = (BLE_DECODER_NOW == dec->timeUs) ? TIMER_NowUs() : dec->timeUs;
+      dec->stats.frames++;
+      dec->handler(dec, &frame[3], lengthField - 1u);
+   }
+   else
+   {
+      // bad checksum
+      dec->stats.badCrc++;
+      DBG(DEBUG_LEVEL_ERROR, "%s() bad crc\n", __func__);
+   }
+}
 
-         uint16_t slaveLatency = evt->slaveLatency[1];
-         slaveLatency <<= 8;
-         slaveLatency |= evt->slaveLatency[0];
+/**
+ * @brief  Fill in the header and CRC around a payload already in place after the header
+ * @param  frame - frame buffer, payload at frame[sizeof(MCUProtocolHeader_t)]
+ * @param  payloadLen - number of payload bytes, 1 to MCU_PROTOCOL_PAYLOAD_MAX
+ * @return number of frame bytes
+ */
+static size_t FinishFrame(uint8_t *frame, size_t payloadLen)
+{
+   MCUProtocolHeader_t *header = (MCUProtocolHeader_t *)frame;
+   header->frameHdr1 = MCU_PROTOCOL_FRAME_HEADER1;
+   header->frameHdr2 = MCU_PROTOCOL_FRAME_HEADER2;
+   header->payloadLen = (uint8_t)(payloadLen + 1u); // add 1 for CRC
+
+   size_t frameLen = sizeof(MCUProtocolHeader_t) + payloadLen;
+   frame[frameLen] = crc8ccitt_block(0, frame, frameLen);
+   return frameLen + 1u;
+}
 
-         uint16_t supTimeout = evt->supTimeout[1];
-         supTimeout <<= 8;
-         supTimeout |= evt->supTimeout[0];
+/**
+ * @brief  Copy a handled frame into the next record for the GUI. Nothing is formatted and
+ *         nothing is allocated here
+ * @param  buf - frame payload
+ * @param  bufLen - number of bytes in buf
+ * @param  link - dongle the frame came from
+ * @param  timeUs - frame arrival time
+ * @return None
+ */
+static void PublishRecord(const uint8_t *buf, size_t bufLen, uint8_t link, uint64_t timeUs)
+{
+   BLERecord_t *rec = BLERecord_Alloc();
+   if (NULL == rec)
+   {
+      return; // GUI behind, counted by BLERecord_Dropped
+   }
 
-         DBG_Evt("MCU_EVT_NODE_CONNECTED. NodeId:%d, Min:%d, Max:%d, Lat:%d, supTimeout:%d\n",
-                 nodeId, minConnIntvl, maxConnIntvl, slaveLatency, supTimeout);
+   BLEModule_FillRecord(rec, buf, bufLen, timeUs);
+   rec->link = link;
+   BLERecord_Commit();
+}
+
+/**
+ * @brief  Fill in the status and node fields of a response record
+ * @param  rec - record with data filled in
+ * @return None
+ */
+static void GetRspFields(BLERecord_t *rec)
+{
+   const uint8_t *rspBuf = rec->data;
+
+   switch (rspBuf[0])
+   {
+#define X(name)                                                    \
+      case MCU_RSP_##name:                                         \
+         rec->status = ((const MCU_RSP_##name##_t *)rspBuf)->status; \
          break;
-      }
-      case MCU_EVT_NODE_DISCONNECTED: {
-         const MCU_EVT_NODE_DISCONNECTED_t *evt = (MCU_EVT_NODE_DISCONNECTED_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_NODE_DISCONNECTED. NodeId:%d, Reason:x%02x (%s)\n", nodeId, evt->reason, BLEModule_GetDisconnectReason(evt->reason));
+      RSP_WITH_STATUS(X)
+#undef X
+      case MCU_RSP_UNKNOWN_COMMAND:
+         rec->status = STATUS_MCU_UNKNOWN_COMMAND;
          break;
-      }
-      case MCU_EVT_NODE_CONNECT_TIMEOUT: {
-         const MCU_EVT_NODE_CONNECT_TIMEOUT_t *evt = (MCU_EVT_NODE_CONNECT_TIMEOUT_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_NODE_CONNECT_TIMEOUT. NodeId:%d\n", nodeId);
+      default:
          break;
-      }
-      case MCU_EVT_NODE_CONNECT_AUTH_ERROR: {
-         const MCU_EVT_NODE_CONNECT_AUTH_ERROR_t *evt = (MCU_EVT_NODE_CONNECT_AUTH_ERROR_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_NODE_CONNECT_AUTH_ERROR. NodeId:%d\n", nodeId);
+   }
+
+   switch (rspBuf[0])
+   {
+      case MCU_RSP_GET_NODE_ID: {
+         const MCU_RSP_GET_NODE_ID_t *rsp = (const MCU_RSP_GET_NODE_ID_t *)rspBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
          break;
       }
-      case MCU_EVT_RX_PAYLOAD: {
-         MCU_EVT_RX_PAYLOAD_t *evt = (MCU_EVT_RX_PAYLOAD_t *)evtBuf;
-         NodeId_t srcNodeId = GetNodeIdFromArrayBytes(evt->srcNodeId);
-         DBG_Evt("MCU_EVT_RX_PAYLOAD. SrcNodeId:%d, Len:%d, RSSI:%d\n", srcNodeId, evt->payloadLen, (int8_t)evt->rssi);
-         DBG_Hex("payload", &evt->payloadLen + 1u, evt->payloadLen, 16u);
+      case MCU_RSP_GET_NODE_TYPE: {
+         const MCU_RSP_GET_NODE_TYPE_t *rsp = (const MCU_RSP_GET_NODE_TYPE_t *)rspBuf;
+         rec->nodeType = rsp->nodeType;
          break;
       }
-      case MCU_EVT_RX_ACK: {
-         MCU_EVT_RX_ACK_t *evt = (MCU_EVT_RX_ACK_t *)evtBuf;
-         NodeId_t srcNodeId = GetNodeIdFromArrayBytes(evt->srcNodeId);
-         DBG_Evt("MCU_EVT_RX_ACK. From SrcNodeId:%d, TxSeqNum:%d\n", srcNodeId, evt->txSeqNum);
+      case MCU_RSP_GET_PAIR_ENTRY: {
+         const MCU_RSP_GET_PAIR_ENTRY_t *rsp = (const MCU_RSP_GET_PAIR_ENTRY_t *)rspBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
+         rec->nodeType = rsp->nodeType;
          break;
       }
-      case MCU_EVT_PING_REQUEST: {
-         MCU_EVT_PING_REQUEST_t *evt = (MCU_EVT_PING_REQUEST_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_PING_REQUEST. NodeId:%d\n", nodeId);
+      case MCU_RSP_GET_CONNECTION: {
+         const MCU_RSP_GET_CONNECTION_t *rsp = (const MCU_RSP_GET_CONNECTION_t *)rspBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
          break;
       }
-      case MCU_EVT_PING_REPLY: {
-         MCU_EVT_PING_REPLY_t *evt = (MCU_EVT_PING_REPLY_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_PING_REPLY. NodeId:%d\n", nodeId);
+      default:
          break;
-      }
-      case MCU_EVT_REMOTE_MCU_RESET_REQUEST: {
-         MCU_EVT_REMOTE_MCU_RESET_REQUEST_t *evt = (MCU_EVT_REMOTE_MCU_RESET_REQUEST_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_REMOTE_MCU_RESET_REQUEST. NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
+   }
+}
+
+/**
+ * @brief  Fill in the status, node and rssi fields of an event record
+ * @param  rec - record with data filled in
+ * @return None
+ */
+static void GetEvtFields(BLERecord_t *rec)
+{
+   const uint8_t *evtBuf = rec->data;
+
+   switch (evtBuf[0])
+   {
+      case MCU_EVT_BLE_REBOOT: {
+         const MCU_EVT_BLE_REBOOT_t *evt = (const MCU_EVT_BLE_REBOOT_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->nodeType = evt->nodeType;
          break;
       }
-      case MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST: {
-         MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST_t *evt = (MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST.  NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
+      case MCU_EVT_NODE_FOUND: {
+         const MCU_EVT_NODE_FOUND_t *evt = (const MCU_EVT_NODE_FOUND_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->nodeType = evt->nodeType;
+         rec->rssi = (int8_t)evt->rssi;
          break;
       }
-      case MCU_EVT_REMOTE_MCU_RESET_NOW: {
-         MCU_EVT_REMOTE_MCU_RESET_NOW_t *evt = (MCU_EVT_REMOTE_MCU_RESET_NOW_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_REMOTE_MCU_RESET_NOW. NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
+      case MCU_EVT_NODE_PAIRED: {
+         const MCU_EVT_NODE_PAIRED_t *evt = (const MCU_EVT_NODE_PAIRED_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->nodeType = evt->nodeType;
          break;
       }
-      case MCU_EVT_REMOTE_BLE_DFU_MODE: {
-         MCU_EVT_REMOTE_BLE_DFU_MODE_t *evt = (MCU_EVT_REMOTE_BLE_DFU_MODE_t *)evtBuf;
-         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
-         DBG_Evt("MCU_EVT_REMOTE_BLE_DFU_MODE. NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
+      case MCU_EVT_NODE_PAIR_FAILED: {
+         const MCU_EVT_NODE_PAIR_FAILED_t *evt = (const MCU_EVT_NODE_PAIR_FAILED_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->nodeType = evt->nodeType;
+         rec->status = evt->status;
          break;
       }
-      case MCU_EVT_BUTTON: {
-         MCU_EVT_BUTTON_t *evt = (MCU_EVT_BUTTON_t *)evtBuf;
-         DBG_Evt("MCU_EVT_BUTTON.  Button:%d Action:%s\n", evt->buttonNum, evt->pressed ? "pressed" : "released");
+      case MCU_EVT_NODE_UNPAIRED: {
+         const MCU_EVT_NODE_UNPAIRED_t *evt = (const MCU_EVT_NODE_UNPAIRED_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->nodeType = evt->nodeType;
          break;
       }
-      case MCU_EVT_CONN_PARAMS_UPDATE: {
-         MCU_EVT_CONN_PARAMS_UPDATE_t *evt = (MCU_EVT_CONN_PARAMS_UPDATE_t *)evtBuf;
-         uint16_t minConnIntvl = evt->minConnIntvl[1];
-         minConnIntvl <<= 8;
-         minConnIntvl |= evt->minConnIntvl[0];
-
-         uint16_t maxConnIntvl = evt->maxConnIntvl[1];
-         maxConnIntvl <<= 8;
-         maxConnIntvl |= evt->maxConnIntvl[0];
-
-         uint16_t slaveLatency = evt->slaveLatency[1];
-         slaveLatency <<= 8;
-         slaveLatency |= evt->slaveLatency[0];
-
-         uint16_t supTimeout = evt->supTimeout[1];
-         supTimeout <<= 8;
-         supTimeout |= evt->supTimeout[0];
-
-         DBG_Evt("MCU_EVT_CONN_PARAMS_UPDATE. Min:%d, Max:%d, Lat:%d, supTimeout:%d\n",
-                 minConnIntvl, maxConnIntvl, slaveLatency, supTimeout);
+      case MCU_EVT_NODE_CONNECTED: {
+         const MCU_EVT_NODE_CONNECTED_t *evt = (const MCU_EVT_NODE_CONNECTED_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
          break;
       }
-      case MCU_EVT_SAVE_CONFIG: {
-         MCU_EVT_SAVE_CONFIG_t *evt = (MCU_EVT_SAVE_CONFIG_t *)evtBuf;
-         DBG_Evt("MCU_EVT_SAVE_CONFIG.  Status:x%X (%s)\n", evt->status, BLEModule_GetStatusString(evt->status));
+      case MCU_EVT_NODE_DISCONNECTED: {
+         const MCU_EVT_NODE_DISCONNECTED_t *evt = (const MCU_EVT_NODE_DISCONNECTED_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
          break;
       }
-      default: {
-         DBG_Evt("%s() Error. Unknown event: x%02X\n", __func__, evtBuf[0]);
+      case MCU_EVT_NODE_CONNECT_TIMEOUT: {
+         const MCU_EVT_NODE_CONNECT_TIMEOUT_t *evt = (const MCU_EVT_NODE_CONNECT_TIMEOUT_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
          break;
       }
-   }
-
-   lastEvt = evtBuf[0];
-}
-
-/**
- * @brief  Call to get the description of the node type
- * @param  nodeType - the node type
- * @return String with description of node type if known
- */
-const char *BLEModule_GetNodeType(NodeType_t nodeType)
-{
-   const char *ret;
-   switch (nodeType)
-   {
-      case CONFIG_NODE_TYPE_NONE:
-         ret = "None";
+      case MCU_EVT_NODE_CONNECT_AUTH_ERROR: {
+         const MCU_EVT_NODE_CONNECT_AUTH_ERROR_t *evt = (const MCU_EVT_NODE_CONNECT_AUTH_ERROR_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
          break;
-
-      case CONFIG_NODE_TYPE_STIMULATOR_PRIMARY:
-         ret = "Stim1";
+      }
+      case MCU_EVT_RX_PAYLOAD: {
+         const MCU_EVT_RX_PAYLOAD_t *evt = (const MCU_EVT_RX_PAYLOAD_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->srcNodeId);
+         rec->rssi = (int8_t)evt->rssi;
          break;
-
-      case CONFIG_NODE_TYPE_STIMULATOR_SECONDARY:
-         ret = "Stim2";
+      }
+      case MCU_EVT_RX_ACK: {
+         const MCU_EVT_RX_ACK_t *evt = (const MCU_EVT_RX_ACK_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->srcNodeId);
          break;
-
-      case CONFIG_NODE_TYPE_FOOTSWITCH:
-         ret = "Foot";
+      }
+      case MCU_EVT_PING_REQUEST: {
+         const MCU_EVT_PING_REQUEST_t *evt = (const MCU_EVT_PING_REQUEST_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
          break;
-
-      case CONFIG_NODE_TYPE_PC_DONGLE:
-         ret = "Dongle";
+      }
+      case MCU_EVT_PING_REPLY: {
+         const MCU_EVT_PING_REPLY_t *evt = (const MCU_EVT_PING_REPLY_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
          break;
-
-      case CONFIG_NODE_TYPE_SMARTPHONE:
-         ret = "Phone";
+      }
+      case MCU_EVT_REMOTE_MCU_RESET_REQUEST: {
+         const MCU_EVT_REMOTE_MCU_RESET_REQUEST_t *evt = (const MCU_EVT_REMOTE_MCU_RESET_REQUEST_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->status = evt->status;
          break;
-
-      case CONFIG_NODE_TYPE_MCU_UPGRADE_TARGET:
-         ret = "MCU Upgrade Mode";
+      }
+      case MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST: {
+         const MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST_t *evt = (const MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->status = evt->status;
          break;
-
-      default:
-         ret = "Unknown";
+      }
+      case MCU_EVT_REMOTE_MCU_RESET_NOW: {
+         const MCU_EVT_REMOTE_MCU_RESET_NOW_t *evt = (const MCU_EVT_REMOTE_MCU_RESET_NOW_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->status = evt->status;
          break;
-   }
-
-   return ret;
-}
-
-/**
- * @brief  Call to get the description of the node role
- * @param  nodeRole - the node role
- * @return String with description of node role if known
- */
-const char *BLEModule_GetNodeRole(NodeRole_t nodeRole)
-{
-   const char *ret;
-   switch (nodeRole)
-   {
-      case CONFIG_ROLE_CENTRAL:
-         ret = "Central";
+      }
+      case MCU_EVT_REMOTE_BLE_DFU_MODE: {
+         const MCU_EVT_REMOTE_BLE_DFU_MODE_t *evt = (const MCU_EVT_REMOTE_BLE_DFU_MODE_t *)evtBuf;
+         rec->nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         rec->status = evt->status;
          break;
-
-      case CONFIG_ROLE_PERIPHERAL:
-         ret = "Periph";
+      }
+      case MCU_EVT_SAVE_CONFIG: {
+         const MCU_EVT_SAVE_CONFIG_t *evt = (const MCU_EVT_SAVE_CONFIG_t *)evtBuf;
+         rec->status = evt->status;
          break;
-
+      }
       default:
-         ret = "Unknown";
          break;
    }
-   return ret;
 }
 
 /**
- * @brief  Call to get the description of the disconnect reason
- * @param  reason - the disconnect reason
- * @return String with description of disconnect reason if known
+ * @brief  Format a command response from the OM BLE module
+ * @param  rspBuf - response payload data, zero filled to MCU_PROTOCOL_PAYLOAD_MAX
+ * @param  buf - where to store the text
+ * @param  size - size of buf in bytes
+ * @return None
  */
-const char *BLEModule_GetDisconnectReason(uint8_t reason)
+static void FormatRsp(const uint8_t *rspBuf, char *buf, size_t size)
 {
-   const char *ret;
-   switch (reason)
+   switch (rspBuf[0])
    {
-      case BLE_HCI_STATUS_CODE_SUCCESS:
-         ret = "BLE_HCI_STATUS_CODE_SUCCESS";
-         break;
-      case BLE_HCI_STATUS_CODE_UNKNOWN_BTLE_COMMAND:
-         ret = "BLE_HCI_STATUS_CODE_UNKNOWN_BTLE_COMMAND";
-         break;
-      case BLE_HCI_STATUS_CODE_UNKNOWN_CONNECTION_IDENTIFIER:
-         ret = "BLE_HCI_STATUS_CODE_UNKNOWN_CONNECTION_IDENTIFIER";
+      case MCU_RSP_NOP: {
+         const MCU_RSP_NOP_t *rsp = (const MCU_RSP_NOP_t *)rspBuf;
+         FMT("MCU_RSP_NOP. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_AUTHENTICATION_FAILURE:
-         ret = "BLE_HCI_AUTHENTICATION_FAILURE";
+      }
+      case MCU_RSP_ON_MCU_RESET: {
+         const MCU_RSP_ON_MCU_RESET_t *rsp = (const MCU_RSP_ON_MCU_RESET_t *)rspBuf;
+         FMT("MCU_RSP_ON_MCU_RESET. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_STATUS_CODE_PIN_OR_KEY_MISSING:
-         ret = "BLE_HCI_STATUS_CODE_PIN_OR_KEY_MISSING";
+      }
+      case MCU_RSP_ON_MCU_BOOTLOADER: {
+         const MCU_RSP_ON_MCU_BOOTLOADER_t *rsp = (const MCU_RSP_ON_MCU_BOOTLOADER_t *)rspBuf;
+         FMT("MCU_RSP_ON_MCU_BOOTLOADER. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_MEMORY_CAPACITY_EXCEEDED:
-         ret = "BLE_HCI_MEMORY_CAPACITY_EXCEEDED";
+      }
+      case MCU_RSP_ON_MCU_SLEEP: {
+         const MCU_RSP_ON_MCU_SLEEP_t *rsp = (const MCU_RSP_ON_MCU_SLEEP_t *)rspBuf;
+         FMT("MCU_RSP_ON_MCU_SLEEP. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_CONNECTION_TIMEOUT:
-         ret = "BLE_HCI_CONNECTION_TIMEOUT";
+      }
+      case MCU_RSP_BLE_REBOOT: {
+         const MCU_RSP_BLE_REBOOT_t *rsp = (const MCU_RSP_BLE_REBOOT_t *)rspBuf;
+         FMT("MCU_RSP_BLE_REBOOT. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_STATUS_CODE_COMMAND_DISALLOWED:
-         ret = "BLE_HCI_STATUS_CODE_COMMAND_DISALLOWED";
+      }
+      case MCU_RSP_BLE_POWEROFF: {
+         const MCU_RSP_BLE_POWEROFF_t *rsp = (const MCU_RSP_BLE_POWEROFF_t *)rspBuf;
+         FMT("MCU_RSP_BLE_POWEROFF. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_STATUS_CODE_INVALID_BTLE_COMMAND_PARAMETERS:
-         ret = "BLE_HCI_STATUS_CODE_INVALID_BTLE_COMMAND_PARAMETERS";
+      }
+      case MCU_RSP_BLE_UARTOFF: {
+         const MCU_RSP_BLE_UARTOFF_t *rsp = (const MCU_RSP_BLE_UARTOFF_t *)rspBuf;
+         FMT("MCU_RSP_BLE_UARTOFF. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION:
-         ret = "BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION";
+      }
+      case MCU_RSP_BLE_FACTORY_RESET: {
+         const MCU_RSP_BLE_FACTORY_RESET_t *rsp = (const MCU_RSP_BLE_FACTORY_RESET_t *)rspBuf;
+         FMT("MCU_RSP_BLE_FACTORY_RESET. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_LOW_RESOURCES:
-         ret = "BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_LOW_RESOURCES";
+      }
+      case MCU_RSP_BLE_DFU_MODE: {
+         const MCU_RSP_BLE_DFU_MODE_t *rsp = (const MCU_RSP_BLE_DFU_MODE_t *)rspBuf;
+         FMT("MCU_RSP_BLE_DFU_MODE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_POWER_OFF:
-         ret = "BLE_HCI_REMOTE_DEV_TERMINATION_DUE_TO_POWER_OFF";
+      }
+      case MCU_RSP_GET_FW_VERSION: {
+         const MCU_RSP_GET_FW_VERSION_t *rsp = (const MCU_RSP_GET_FW_VERSION_t *)rspBuf;
+
+         char hashStr[80];
+         GetDataAsHex(rsp->hash, sizeof(rsp->hash), hashStr);
+
+         char shaStr[20];
+         (void)memcpy(shaStr, rsp->sha, sizeof(rsp->sha));
+         shaStr[sizeof(rsp->sha)] = '\0';
+
+         if (rsp->shaDirty)
+         {
+            (void)strcat(shaStr, "+");
+         }
+
+         FMT("MCU_RSP_GET_FW_VERSION.\nVersion:%d.%d\nHash:%s\nSHA:%s\nStatus:x%X (%s)\n", rsp->fwMajor, rsp->fwMinor, hashStr, shaStr, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION:
-         ret = "BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION";
+      }
+      case MCU_RSP_SET_AUTH_KEY: {
+         const MCU_RSP_SET_AUTH_KEY_t *rsp = (const MCU_RSP_SET_AUTH_KEY_t *)rspBuf;
+         FMT("MCU_RSP_SET_AUTH_KEY. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_UNSUPPORTED_REMOTE_FEATURE:
-         ret = "BLE_HCI_UNSUPPORTED_REMOTE_FEATURE";
+      }
+      case MCU_RSP_SET_TX_POWER: {
+         const MCU_RSP_SET_TX_POWER_t *rsp = (const MCU_RSP_SET_TX_POWER_t *)rspBuf;
+         FMT("MCU_RSP_SET_TX_POWER. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_STATUS_CODE_LMP_RESPONSE_TIMEOUT:
-         ret = "BLE_HCI_STATUS_CODE_LMP_RESPONSE_TIMEOUT";
+      }
+      case MCU_RSP_SET_NODE_ROLE: {
+         const MCU_RSP_SET_NODE_ROLE_t *rsp = (const MCU_RSP_SET_NODE_ROLE_t *)rspBuf;
+         FMT("MCU_RSP_SET_NODE_ROLE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_STATUS_CODE_LMP_ERROR_TRANSACTION_COLLISION:
-         ret = "BLE_HCI_STATUS_CODE_LMP_ERROR_TRANSACTION_COLLISION";
+      }
+      case MCU_RSP_GET_NODE_ROLE: {
+         const MCU_RSP_GET_NODE_ROLE_t *rsp = (const MCU_RSP_GET_NODE_ROLE_t *)rspBuf;
+         NodeRole_t nodeRole = (NodeRole_t)rsp->nodeRole;
+         FMT("MCU_RSP_GET_NODE_ROLE. NodeRole:%d (%s), Status:x%X (%s)\n", nodeRole, BLEModule_GetNodeRole(nodeRole), rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_STATUS_CODE_LMP_PDU_NOT_ALLOWED:
-         ret = "BLE_HCI_STATUS_CODE_LMP_PDU_NOT_ALLOWED";
+      }
+      case MCU_RSP_SET_NODE_ID: {
+         const MCU_RSP_SET_NODE_ID_t *rsp = (const MCU_RSP_SET_NODE_ID_t *)rspBuf;
+         FMT("MCU_RSP_SET_NODE_ID. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_INSTANT_PASSED:
-         ret = "BLE_HCI_INSTANT_PASSED";
+      }
+      case MCU_RSP_GET_NODE_ID: {
+         const MCU_RSP_GET_NODE_ID_t *rsp = (const MCU_RSP_GET_NODE_ID_t *)rspBuf;
+         NodeId_t nodeId = (NodeId_t)GetNodeIdFromArrayBytes(rsp->nodeId);
+         FMT("MCU_RSP_GET_NODE_ID. NodeId:%d, Status:x%X (%s)\n", nodeId, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_PAIRING_WITH_UNIT_KEY_UNSUPPORTED:
-         ret = "BLE_HCI_PAIRING_WITH_UNIT_KEY_UNSUPPORTED";
+      }
+      case MCU_RSP_SET_NODE_TYPE: {
+         const MCU_RSP_SET_NODE_TYPE_t *rsp = (const MCU_RSP_SET_NODE_TYPE_t *)rspBuf;
+         FMT("MCU_RSP_SET_NODE_TYPE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_DIFFERENT_TRANSACTION_COLLISION:
-         ret = "BLE_HCI_DIFFERENT_TRANSACTION_COLLISION";
+      }
+      case MCU_RSP_GET_NODE_TYPE: {
+         const MCU_RSP_GET_NODE_TYPE_t *rsp = (const MCU_RSP_GET_NODE_TYPE_t *)rspBuf;
+         NodeType_t nodeType = (NodeType_t)rsp->nodeType;
+         FMT("MCU_RSP_GET_NODE_TYPE. NodeType:%d (%s), Status:x%X (%s)\n", nodeType, BLEModule_GetNodeType(nodeType), rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_PARAMETER_OUT_OF_MANDATORY_RANGE:
-         ret = "BLE_HCI_PARAMETER_OUT_OF_MANDATORY_RANGE";
+      }
+      case MCU_RSP_SET_CONNECTION_PARAMS: {
+         const MCU_RSP_SET_CONNECTION_PARAMS_t *rsp = (const MCU_RSP_SET_CONNECTION_PARAMS_t *)rspBuf;
+         FMT("MCU_RSP_SET_CONNECTION_PARAMS. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_CONTROLLER_BUSY:
-         ret = "BLE_HCI_CONTROLLER_BUSY";
+      };
+      case MCU_RSP_SET_GAP_EVENT_LENGTH: {
+         const MCU_RSP_SET_GAP_EVENT_LENGTH_t *rsp = (const MCU_RSP_SET_GAP_EVENT_LENGTH_t *)rspBuf;
+         FMT("MCU_RSP_SET_GAP_EVENT_LENGTH. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_CONN_INTERVAL_UNACCEPTABLE:
-         ret = "BLE_HCI_CONN_INTERVAL_UNACCEPTABLE";
+      }
+      case MCU_RSP_GET_GAP_EVENT_LENGTH: {
+         const MCU_RSP_GET_GAP_EVENT_LENGTH_t *rsp = (const MCU_RSP_GET_GAP_EVENT_LENGTH_t *)rspBuf;
+         FMT("MCU_RSP_GET_GAP_EVENT_LENGTH. Units:%d. Status:x%X (%s)\n", rsp->units, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_DIRECTED_ADVERTISER_TIMEOUT:
-         ret = "BLE_HCI_DIRECTED_ADVERTISER_TIMEOUT";
+      }
+      case MCU_RSP_SET_SCAN_PARAMS: {
+         const MCU_RSP_SET_SCAN_PARAMS_t *rsp = (const MCU_RSP_SET_SCAN_PARAMS_t *)rspBuf;
+         FMT("MCU_RSP_SET_SCAN_PARAMS. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_CONN_TERMINATED_DUE_TO_MIC_FAILURE:
-         ret = "BLE_HCI_CONN_TERMINATED_DUE_TO_MIC_FAILURE";
+      }
+      case MCU_RSP_GET_SCAN_PARAMS: {
+         const MCU_RSP_GET_SCAN_PARAMS_t *rsp = (const MCU_RSP_GET_SCAN_PARAMS_t *)rspBuf;
+
+         uint16_t timeout = rsp->timeout[1];
+         timeout <<= 8;
+         timeout |= rsp->timeout[0];
+
+         uint16_t window = rsp->window[1];
+         window <<= 8;
+         window |= rsp->window[0];
+
+         uint16_t interval = rsp->interval[1];
+         interval <<= 8;
+         interval |= rsp->interval[0];
+
+         FMT("MCU_RSP_GET_SCAN_PARAMS. Timeout:%d, Window:%d, Interval:%d, Status:x%X (%s)\n",
+             timeout, window, interval, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED:
-         ret = "BLE_HCI_CONN_FAILED_TO_BE_ESTABLISHED";
+      }
+      case MCU_RSP_SCAN: {
+         const MCU_RSP_SCAN_t *rsp = (const MCU_RSP_SCAN_t *)rspBuf;
+         FMT("MCU_RSP_SCAN. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      default:
-         ret = "Unknown";
+      }
+      case MCU_RSP_SET_ADV_PARAMS: {
+         const MCU_RSP_SET_ADV_PARAMS_t *rsp = (const MCU_RSP_SET_ADV_PARAMS_t *)rspBuf;
+         FMT("MCU_RSP_SET_ADV_PARAMS. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-   }
-   return ret;
-}
+      }
+      case MCU_RSP_GET_ADV_PARAMS: {
+         const MCU_RSP_GET_ADV_PARAMS_t *rsp = (const MCU_RSP_GET_ADV_PARAMS_t *)rspBuf;
 
-/**
- * @brief  Call to get the description of the status
- * @param  status - the status
- * @return String with description of status if known
- */
-const char *BLEModule_GetStatusString(Status_t status)
-{
-   const char *ret;
-   switch (status)
-   {
-      case STATUS_SUCCESS:
-         ret = "STATUS_SUCCESS";
-         break;
-      case STATUS_ERROR:
-         ret = "STATUS_ERROR";
-         break;
-      case STATUS_NOT_INIT:
-         ret = "STATUS_NOT_INIT";
+         uint32_t interval = rsp->interval[3];
+         interval <<= 8;
+         interval |= rsp->interval[2];
+         interval <<= 8;
+         interval |= rsp->interval[1];
+         interval <<= 8;
+         interval |= rsp->interval[0];
+
+         uint16_t duration = rsp->duration[1];
+         duration <<= 8;
+         duration |= rsp->duration[0];
+
+         FMT("MCU_RSP_GET_ADV_PARAMS. Interval:%d, Duration:%d, Status:x%X (%s)\n",
+             interval, duration, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_BUSY:
-         ret = "STATUS_BUSY";
+      }
+      case MCU_RSP_ADVERTISE: {
+         const MCU_RSP_ADVERTISE_t *rsp = (const MCU_RSP_ADVERTISE_t *)rspBuf;
+         FMT("MCU_RSP_ADVERTISE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_NVM_FAIL:
-         ret = "STATUS_NVM_FAIL";
+      }
+      case MCU_RSP_SET_ADVERT_DATA: {
+         const MCU_RSP_SET_ADVERT_DATA_t *rsp = (const MCU_RSP_SET_ADVERT_DATA_t *)rspBuf;
+         FMT("MCU_RSP_SET_ADVERT_DATA. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_CONFIG_CRC_FAIL:
-         ret = "STATUS_CONFIG_CRC_FAIL";
+      }
+      case MCU_RSP_GET_ADVERT_DATA: {
+         const MCU_RSP_GET_ADVERT_DATA_t *rsp = (const MCU_RSP_GET_ADVERT_DATA_t *)rspBuf;
+         FMT("MCU_RSP_GET_ADVERT_DATA. Data:[0]%d [1]%d [2]%d, Status:x%X (%s)\n", rsp->advData[0], rsp->advData[1], rsp->advData[2], rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_CONFIG_NOT_FOUND:
-         ret = "STATUS_CONFIG_NOT_FOUND";
+      }
+      case MCU_RSP_SAVE_CONFIG: {
+         const MCU_RSP_SAVE_CONFIG_t *rsp = (const MCU_RSP_SAVE_CONFIG_t *)rspBuf;
+         FMT("MCU_RSP_SAVE_CONFIG. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_UART_INIT:
-         ret = "STATUS_UART_INIT";
+      }
+      case MCU_RSP_CONNECT: {
+         const MCU_RSP_CONNECT_t *rsp = (const MCU_RSP_CONNECT_t *)rspBuf;
+         FMT("MCU_RSP_CONNECT. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_UART_TX_OVERFLOW:
-         ret = "STATUS_UART_TX_OVERFLOW";
+      }
+      case MCU_RSP_DISCONNECT: {
+         const MCU_RSP_DISCONNECT_t *rsp = (const MCU_RSP_DISCONNECT_t *)rspBuf;
+         FMT("MCU_RSP_DISCONNECT. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_UART_OFF:
-         ret = "STATUS_UART_OFF";
+      }
+      case MCU_RSP_PAIR: {
+         const MCU_RSP_PAIR_t *rsp = (const MCU_RSP_PAIR_t *)rspBuf;
+         FMT("MCU_RSP_PAIR. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_UART_BUSY:
-         ret = "STATUS_UART_BUSY";
+      }
+      case MCU_RSP_UNPAIR: {
+         const MCU_RSP_UNPAIR_t *rsp = (const MCU_RSP_UNPAIR_t *)rspBuf;
+         FMT("MCU_RSP_UNPAIR. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_USB_NOT_CONNECTED:
-         ret = "STATUS_USB_NOT_CONNECTED";
+      }
+      case MCU_RSP_UNPAIR_ALL: {
+         const MCU_RSP_UNPAIR_ALL_t *rsp = (const MCU_RSP_UNPAIR_ALL_t *)rspBuf;
+         FMT("MCU_RSP_UNPAIR_ALL. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_USB_TX_OVERFLOW:
-         ret = "STATUS_USB_TX_OVERFLOW";
+      }
+      case MCU_RSP_GET_PAIR_ENTRY_COUNT: {
+         const MCU_RSP_GET_PAIR_ENTRY_COUNT_t *rsp = (const MCU_RSP_GET_PAIR_ENTRY_COUNT_t *)rspBuf;
+         FMT("MCU_RSP_GET_PAIR_ENTRY_COUNT. Count:%d, Status:x%X (%s)\n", rsp->count, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_USB_ERROR:
-         ret = "STATUS_USB_ERROR";
+      }
+      case MCU_RSP_GET_PAIR_ENTRY: {
+         const MCU_RSP_GET_PAIR_ENTRY_t *rsp = (const MCU_RSP_GET_PAIR_ENTRY_t *)rspBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
+         FMT("MCU_RSP_GET_PAIR_ENTRY. Index:%d, NodeType:%d (%s), NodeId:%d, Status:x%X (%s)\n", rsp->index, rsp->nodeType, BLEModule_GetNodeType(rsp->nodeType), nodeId, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_USB_NOT_SUPPORTED:
-         ret = "STATUS_USB_NOT_SUPPORTED";
+      }
+      case MCU_RSP_GET_CONNECTION_COUNT: {
+         const MCU_RSP_GET_CONNECTION_COUNT_t *rsp = (const MCU_RSP_GET_CONNECTION_COUNT_t *)rspBuf;
+         FMT("MCU_RSP_GET_CONNECTION_COUNT. Count:%d, Status:x%X (%s)\n", rsp->count, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_BAD_INDEX:
-         ret = "STATUS_MCU_BAD_INDEX";
+      }
+      case MCU_RSP_GET_CONNECTION: {
+         const MCU_RSP_GET_CONNECTION_t *rsp = (const MCU_RSP_GET_CONNECTION_t *)rspBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(rsp->nodeId);
+         FMT("MCU_RSP_GET_CONNECTION. Index:%d, NodeId:%d, Status:x%X (%s)\n", rsp->index, nodeId, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_UNKNOWN_COMMAND:
-         ret = "STATUS_MCU_UNKNOWN_COMMAND";
+      }
+      case MCU_RSP_SET_ADVERT_RSSI_THRESHOLD: {
+         const MCU_RSP_SET_ADVERT_RSSI_THRESHOLD_t *rsp = (const MCU_RSP_SET_ADVERT_RSSI_THRESHOLD_t *)rspBuf;
+         FMT("MCU_RSP_SET_ADVERT_RSSI_THRESHOLD. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_UNSUPPORTED_COMMAND:
-         ret = "STATUS_MCU_UNSUPPORTED_COMMAND";
+      }
+      case MCU_RSP_GET_ADVERT_RSSI_THRESHOLD: {
+         const MCU_RSP_GET_ADVERT_RSSI_THRESHOLD_t *rsp = (const MCU_RSP_GET_ADVERT_RSSI_THRESHOLD_t *)rspBuf;
+         FMT("MCU_RSP_GET_ADVERT_RSSI_THRESHOLD. RSSI Threshold:%d, Status:x%X (%s)\n", rsp->rssiThreshold, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_NOT_SUPPORTED_IN_THIS_ROLE:
-         ret = "STATUS_MCU_NOT_SUPPORTED_IN_THIS_ROLE";
+      }
+      case MCU_RSP_RADIO_TEST_DTM: {
+         const MCU_RSP_RADIO_TEST_DTM_t *rsp = (const MCU_RSP_RADIO_TEST_DTM_t *)rspBuf;
+         FMT("MCU_RSP_RADIO_TEST_DTM. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_CHECK_BYTE_FAIL:
-         ret = "STATUS_MCU_CHECK_BYTE_FAIL";
+      }
+      case MCU_RSP_RADIO_TEST_MOD_CARRIER: {
+         const MCU_RSP_RADIO_TEST_MOD_CARRIER_t *rsp = (const MCU_RSP_RADIO_TEST_MOD_CARRIER_t *)rspBuf;
+         FMT("MCU_RSP_RADIO_TEST_MOD_CARRIER. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_BAD_PARAM:
-         ret = "STATUS_MCU_BAD_PARAM";
+      }
+      case MCU_RSP_TX_PAYLOAD: {
+         const MCU_RSP_TX_PAYLOAD_t *rsp = (const MCU_RSP_TX_PAYLOAD_t *)rspBuf;
+         FMT("MCU_RSP_TX_PAYLOAD. TxSeqNum:%d, Status:x%X (%s)\n", rsp->txSeqNum, rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_PAIR_TABLE_FULL:
-         ret = "STATUS_MCU_PAIR_TABLE_FULL";
+      }
+      case MCU_RSP_REMOTE_MCU_PING_REQUEST: {
+         const MCU_RSP_REMOTE_MCU_PING_REQUEST_t *rsp = (const MCU_RSP_REMOTE_MCU_PING_REQUEST_t *)rspBuf;
+         FMT("MCU_RSP_REMOTE_MCU_PING_REQUEST. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_PAIRING_ENTRY_NOT_FOUND:
-         ret = "STATUS_MCU_PAIRING_ENTRY_NOT_FOUND";
+      }
+      case MCU_RSP_REMOTE_MCU_PING_REPLY: {
+         const MCU_RSP_REMOTE_MCU_PING_REPLY_t *rsp = (const MCU_RSP_REMOTE_MCU_PING_REPLY_t *)rspBuf;
+         FMT("MCU_RSP_REMOTE_MCU_PING_REPLY. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_ALREADY_PAIRED:
-         ret = "STATUS_MCU_ALREADY_PAIRED";
+      }
+      case MCU_RSP_REMOTE_MCU_RESET_REQUEST: {
+         const MCU_RSP_REMOTE_MCU_RESET_REQUEST_t *rsp = (const MCU_RSP_REMOTE_MCU_RESET_REQUEST_t *)rspBuf;
+         FMT("MCU_RSP_REMOTE_MCU_RESET_REQUEST. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_BAD_NODE_TYPE:
-         ret = "STATUS_MCU_BAD_NODE_TYPE";
+      }
+      case MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST: {
+         const MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST_t *rsp = (const MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST_t *)rspBuf;
+         FMT("MCU_RSP_REMOTE_MCU_BOOTLOADER_REQUEST. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_MCU_UART_OFF:
-         ret = "STATUS_UART_LINK_OFF";
+      }
+      case MCU_RSP_REMOTE_MCU_RESET_NOW: {
+         const MCU_RSP_REMOTE_MCU_RESET_NOW_t *rsp = (const MCU_RSP_REMOTE_MCU_RESET_NOW_t *)rspBuf;
+         FMT("MCU_RSP_REMOTE_MCU_RESET_NOW. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_NET_PEER_NOT_CONNECTED:
-         ret = "STATUS_NET_PEER_NOT_CONNECTED";
+      }
+      case MCU_RSP_REMOTE_BLE_DFU_MODE: {
+         const MCU_RSP_REMOTE_BLE_DFU_MODE_t *rsp = (const MCU_RSP_REMOTE_BLE_DFU_MODE_t *)rspBuf;
+         FMT("MCU_RSP_REMOTE_BLE_DFU_MODE. Status:x%X (%s)\n", rsp->status, BLEModule_GetStatusString(rsp->status));
          break;
-      case STATUS_NET_CENTRAL_NOT_CONNECTED:
-         ret = "STATUS_NET_CENTRAL_NOT_CONNECTED";
+      }
+      case MCU_RSP_UNKNOWN_COMMAND: {
+         FMT("MCU_RSP_UNKNOWN_COMMAND. Status:x%X (%s)\n", STATUS_MCU_UNKNOWN_COMMAND, BLEModule_GetStatusString(STATUS_MCU_UNKNOWN_COMMAND));
          break;
-      case STATUS_NET_BAD_CONNECTION_HANDLE:
-         ret = "STATUS_NET_BAD_CONNECTION_HANDLE";
+      }
+      default: {
+         FMT("BLEModule_RspHandler() Error. Unknown response: x%02X\n", rspBuf[0]);
          break;
-      case STATUS_NET_UNKNOWN_CMD:
-         ret = "STATUS_NET_UNKNOWN_CMD";
+      }
+   }
+}
+
+/**
+ * @brief  Format an event from the OM BLE module
+ * @param  evtBuf - event payload data, zero filled to MCU_PROTOCOL_PAYLOAD_MAX
+ * @param  buf - where to store the text
+ * @param  size - size of buf in bytes
+ * @return None
+ */
+static void FormatEvt(const uint8_t *evtBuf, char *buf, size_t size)
+{
+   switch (evtBuf[0])
+   {
+      case MCU_EVT_BLE_REBOOT: {
+         const MCU_EVT_BLE_REBOOT_t *evt = (const MCU_EVT_BLE_REBOOT_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+
+         FMT("MCU_EVT_BLE_REBOOT. NodeRole:%d (%s), NodeType:%d (%s), NodeId:%d, PairedCount:%d, Version:%d.%d\n",
+             evt->nodeRole,
+             BLEModule_GetNodeRole(evt->nodeRole),
+             evt->nodeType,
+             BLEModule_GetNodeType(evt->nodeType),
+             nodeId,
+             evt->pairedCount,
+             evt->fwMajor,
+             evt->fwMinor);
          break;
-      case STATUS_NET_UNSUPPORTED_CMD:
-         ret = "STATUS_NET_UNSUPPORTED_CMD";
+      }
+      case MCU_EVT_BLE_POWEROFF: {
+         FMT("MCU_EVT_BLE_POWEROFF -----\n");
          break;
-      case STATUS_NET_NOT_SUPPORTED_IN_THIS_ROLE:
-         ret = "STATUS_NET_NOT_SUPPORTED_IN_THIS_ROLE";
+      }
+      case MCU_EVT_MCU_RESET_REQUESTED: {
+         const MCU_EVT_MCU_RESET_REQUESTED_t *evt = (const MCU_EVT_MCU_RESET_REQUESTED_t *)evtBuf;
+         (void)evt;
+         FMT("MCU_EVT_MCU_RESET_REQUESTED\n");
          break;
-      case STATUS_NET_BAD_PARAM:
-         ret = "STATUS_NET_BAD_PARAM";
+      }
+      case MCU_EVT_MCU_BOOTLOADER_REQUESTED: {
+         const MCU_EVT_MCU_BOOTLOADER_REQUESTED_t *evt = (const MCU_EVT_MCU_BOOTLOADER_REQUESTED_t *)evtBuf;
+         (void)evt;
+         FMT("MCU_EVT_MCU_BOOTLOADER_REQUESTED\n");
          break;
-      case STATUS_NET_PAIR_TABLE_FULL:
-         ret = "STATUS_NET_PAIR_TABLE_FULL";
+      }
+      case MCU_EVT_NODE_FOUND: {
+         const MCU_EVT_NODE_FOUND_t *evt = (const MCU_EVT_NODE_FOUND_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_FOUND. NodeType:%d (%s), NodeId:%d, PairedNodeId:%d, AdvData:%02x%02x%02x, RSSI:%ddBm, V%d.%d\n",
+             evt->nodeType,
+             BLEModule_GetNodeType(evt->nodeType),
+             nodeId,
+             GetNodeIdFromArrayBytes(evt->pairedNodeId),
+             evt->advData[0], evt->advData[1], evt->advData[2],
+             (int8_t)evt->rssi,
+             evt->fwVersionMajor, evt->fwVersionMinor);
          break;
-      case STATUS_NET_NODE_NOT_FOUND:
-         ret = "STATUS_NET_NODE_NOT_FOUND";
+      }
+      case MCU_EVT_NODE_PAIRED: {
+         const MCU_EVT_NODE_PAIRED_t *evt = (const MCU_EVT_NODE_PAIRED_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_PAIRED. NodeType:%d (%s), NodeId:%d\n", evt->nodeType, BLEModule_GetNodeType(evt->nodeType), nodeId);
          break;
-      case STATUS_NET_ALREADY_PAIRED:
-         ret = "STATUS_NET_ALREADY_PAIRED";
+      }
+      case MCU_EVT_NODE_PAIR_FAILED: {
+         const MCU_EVT_NODE_PAIR_FAILED_t *evt = (const MCU_EVT_NODE_PAIR_FAILED_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_PAIR_FAILED. NodeType:%d (%s), NodeId:%d, Status:x%X (%s)\n", evt->nodeType, BLEModule_GetNodeType(evt->nodeType), nodeId, evt->status, BLEModule_GetStatusString(evt->status));
          break;
-      case STATUS_NET_CONNECTION_NOT_FOUND:
-         ret = "STATUS_NET_CONNECTION_NOT_FOUND";
+      }
+      case MCU_EVT_NODE_UNPAIRED: {
+         const MCU_EVT_NODE_UNPAIRED_t *evt = (const MCU_EVT_NODE_UNPAIRED_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_UNPAIRED. NodeType:%d (%s), NodeId:%d\n", evt->nodeType, BLEModule_GetNodeType(evt->nodeType), nodeId);
          break;
-      case STATUS_NET_SECURITY_FAILED:
-         ret = "STATUS_NET_SECURITY_FAILED";
+      }
+      case MCU_EVT_NODE_CONNECTED: {
+         const MCU_EVT_NODE_CONNECTED_t *evt = (const MCU_EVT_NODE_CONNECTED_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         uint16_t minConnIntvl = evt->minConnIntvl[1];
+         minConnIntvl <<= 8;
+         minConnIntvl |= evt->minConnIntvl[0];
+
+         uint16_t maxConnIntvl = evt->maxConnIntvl[1];
+         maxConnIntvl <<= 8;
+         maxConnIntvl |= evt->maxConnIntvl[0];
+
+         uint16_t slaveLatency = evt->slaveLatency[1];
+         slaveLatency <<= 8;
+         slaveLatency |= evt->slaveLatency[0];
+
+         uint16_t supTimeout = evt->supTimeout[1];
+         supTimeout <<= 8;
+         supTimeout |= evt->supTimeout[0];
+
+         FMT("MCU_EVT_NODE_CONNECTED. NodeId:%d, Min:%d, Max:%d, Lat:%d, supTimeout:%d\n",
+             nodeId, minConnIntvl, maxConnIntvl, slaveLatency, supTimeout);
          break;
-      case STATUS_NET_ROUTING_ERROR:
-         ret = "STATUS_NET_ROUTING_ERROR";
+      }
+      case MCU_EVT_NODE_DISCONNECTED: {
+         const MCU_EVT_NODE_DISCONNECTED_t *evt = (const MCU_EVT_NODE_DISCONNECTED_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_DISCONNECTED. NodeId:%d, Reason:x%02x (%s)\n", nodeId, evt->reason, BLEModule_GetDisconnectReason(evt->reason));
          break;
-      case STATUS_NET_MGT_PAYLOAD_CANNOT_BE_FORWARDED:
-         ret = "STATUS_NET_MGT_PAYLOAD_CANNOT_BE_FORWARDED";
+      }
+      case MCU_EVT_NODE_CONNECT_TIMEOUT: {
+         const MCU_EVT_NODE_CONNECT_TIMEOUT_t *evt = (const MCU_EVT_NODE_CONNECT_TIMEOUT_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_CONNECT_TIMEOUT. NodeId:%d\n", nodeId);
          break;
-      case STATUS_NET_MGT_PAYLOAD_CANNOT_BE_BROADCAST:
-         ret = "STATUS_NET_MGT_PAYLOAD_CANNOT_BE_BROADCAST";
+      }
+      case MCU_EVT_NODE_CONNECT_AUTH_ERROR: {
+         const MCU_EVT_NODE_CONNECT_AUTH_ERROR_t *evt = (const MCU_EVT_NODE_CONNECT_AUTH_ERROR_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_NODE_CONNECT_AUTH_ERROR. NodeId:%d\n", nodeId);
          break;
-      case STATUS_BLE_ERROR:
-         ret = "STATUS_BLE_ERROR";
+      }
+      case MCU_EVT_RX_PAYLOAD: {
+         const MCU_EVT_RX_PAYLOAD_t *evt = (const MCU_EVT_RX_PAYLOAD_t *)evtBuf;
+         NodeId_t srcNodeId = GetNodeIdFromArrayBytes(evt->srcNodeId);
+         int used = snprintf(buf, size, "MCU_EVT_RX_PAYLOAD. SrcNodeId:%d, Len:%d, RSSI:%d\npayload:", srcNodeId, evt->payloadLen, (int8_t)evt->rssi);
+         AppendHex(buf, size, used, &evt->payloadLen + 1u, evt->payloadLen);
          break;
-      case STATUS_BLE_NOT_SUPPORTED:
-         ret = "STATUS_BLE_NOT_SUPPORTED";
+      }
+      case MCU_EVT_RX_ACK: {
+         const MCU_EVT_RX_ACK_t *evt = (const MCU_EVT_RX_ACK_t *)evtBuf;
+         NodeId_t srcNodeId = GetNodeIdFromArrayBytes(evt->srcNodeId);
+         FMT("MCU_EVT_RX_ACK. From SrcNodeId:%d, TxSeqNum:%d\n", srcNodeId, evt->txSeqNum);
          break;
-      case STATUS_BLE_NOT_SUPPORTED_IN_THIS_ROLE:
-         ret = "STATUS_BLE_NOT_SUPPORTED_IN_THIS_ROLE";
+      }
+      case MCU_EVT_PING_REQUEST: {
+         const MCU_EVT_PING_REQUEST_t *evt = (const MCU_EVT_PING_REQUEST_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_PING_REQUEST. NodeId:%d\n", nodeId);
          break;
-      case STATUS_BLE_NODE_NOT_CONNECTED:
-         ret = "STATUS_BLE_NODE_NOT_CONNECTED";
+      }
+      case MCU_EVT_PING_REPLY: {
+         const MCU_EVT_PING_REPLY_t *evt = (const MCU_EVT_PING_REPLY_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_PING_REPLY. NodeId:%d\n", nodeId);
          break;
-      case STATUS_BLE_NODE_ALREADY_CONNECTED:
-         ret = "STATUS_BLE_NODE_ALREADY_CONNECTED";
+      }
+      case MCU_EVT_REMOTE_MCU_RESET_REQUEST: {
+         const MCU_EVT_REMOTE_MCU_RESET_REQUEST_t *evt = (const MCU_EVT_REMOTE_MCU_RESET_REQUEST_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_REMOTE_MCU_RESET_REQUEST. NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
          break;
-      case STATUS_BLE_CONNECTION_IN_PROGRESS:
-         ret = "STATUS_BLE_CONNECTION_IN_PROGRESS";
+      }
+      case MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST: {
+         const MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST_t *evt = (const MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_REMOTE_MCU_BOOTLOADER_REQUEST.  NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
          break;
-      case STATUS_BLE_BAD_PARAMETER:
-         ret = "STATUS_BLE_BAD_PARAMETER";
+      }
+      case MCU_EVT_REMOTE_MCU_RESET_NOW: {
+         const MCU_EVT_REMOTE_MCU_RESET_NOW_t *evt = (const MCU_EVT_REMOTE_MCU_RESET_NOW_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_REMOTE_MCU_RESET_NOW. NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
          break;
-      case STATUS_BLE_TX_POWER_NOT_SUPPORTED:
-         ret = "STATUS_BLE_TX_POWER_NOT_SUPPORTED";
+      }
+      case MCU_EVT_REMOTE_BLE_DFU_MODE: {
+         const MCU_EVT_REMOTE_BLE_DFU_MODE_t *evt = (const MCU_EVT_REMOTE_BLE_DFU_MODE_t *)evtBuf;
+         NodeId_t nodeId = GetNodeIdFromArrayBytes(evt->nodeId);
+         FMT("MCU_EVT_REMOTE_BLE_DFU_MODE. NodeId:%d, Status:x%X (%s)\n", nodeId, evt->status, BLEModule_GetStatusString(evt->status));
          break;
-      case STATUS_BLE_TEST_MODE_BAD_PATTERN:
-         ret = "STATUS_BLE_TEST_MODE_BAD_PATTERN";
+      }
+      case MCU_EVT_BUTTON: {
+         const MCU_EVT_BUTTON_t *evt = (const MCU_EVT_BUTTON_t *)evtBuf;
+         FMT("MCU_EVT_BUTTON.  Button:%d Action:%s\n", evt->buttonNum, evt->pressed ? "pressed" : "released");
          break;
-      case STATUS_BLE_TEST_MODE_BAD_CHANNEL:
-         ret = "STATUS_BLE_TEST_MODE_BAD_CHANNEL";
+      }
+      case MCU_EVT_CONN_PARAMS_UPDATE: {
+         const MCU_EVT_CONN_PARAMS_UPDATE_t *evt = (const MCU_EVT_CONN_PARAMS_UPDATE_t *)evtBuf;
+         uint16_t minConnIntvl = evt->minConnIntvl[1];
+         minConnIntvl <<= 8;
+         minConnIntvl |= evt->minConnIntvl[0];
+
+         uint16_t maxConnIntvl = evt->maxConnIntvl[1];
+         maxConnIntvl <<= 8;
+         maxConnIntvl |= evt->maxConnIntvl[0];
+
+         uint16_t slaveLatency = evt->slaveLatency[1];
+         slaveLatency <<= 8;
+         slaveLatency |= evt->slaveLatency[0];
+
+         uint16_t supTimeout = evt->supTimeout[1];
+         supTimeout <<= 8;
+         supTimeout |= evt->supTimeout[0];
+
+         FMT("MCU_EVT_CONN_PARAMS_UPDATE. Min:%d, Max:%d, Lat:%d, supTimeout:%d\n",
+             minConnIntvl, maxConnIntvl, slaveLatency, supTimeout);
          break;
-      default:
-         ret = "Unknown status";
+      }
+      case MCU_EVT_SAVE_CONFIG: {
+         const MCU_EVT_SAVE_CONFIG_t *evt = (const MCU_EVT_SAVE_CONFIG_t *)evtBuf;
+         FMT("MCU_EVT_SAVE_CONFIG.  Status:x%X (%s)\n", evt->status, BLEModule_GetStatusString(evt->status));
+         break;
+      }
+      default: {
+         FMT("BLEModule_EvtHandler() Error. Unknown event: x%02X\n", evtBuf[0]);
          break;
+      }
    }
-
-   return ret;
 }
 
-/**********************************************************************************************
- * Module static functions
- **********************************************************************************************/
+/**
+ * @brief  Append a hex dump of data to formatted text, truncated to fit
+ * @param  buf - text
+ * @param  size - size of buf in bytes
+ * @param  used - length of the text already in buf, from snprintf
+ * @param  data - data to dump
+ * @param  len - number of bytes in data
+ * @return None
+ */
+static void AppendHex(char *buf, size_t size, int used, const void *data, size_t len)
+{
+   const uint8_t *val = (const uint8_t *)data;
+
+   for (size_t count = 0; (count < len) && (used >= 0) && ((size_t)used < (size - 4u)); count++)
+   {
+      used += snprintf(&buf[used], size - (size_t)used, " %02x", val[count]);
+   }
+}
 
 /**
  * @brief  Utility function to get data as a hex string
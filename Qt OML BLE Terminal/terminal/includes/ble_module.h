@@ -26,8 +26,11 @@
 /**********************************************************************************************
  * Module includes
  **********************************************************************************************/
-#include "..\..\OML BLE App\types.h"
+#include "../../OML BLE App/types.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "blerecord.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -37,6 +40,8 @@ extern "C" {
 /**********************************************************************************************
  * Module exported defines
  **********************************************************************************************/
+#define BLE_DECODER_NOW UINT64_MAX // BLEDecoder_OnRxBlock time to stamp frames with TIMER_NowUs
+
 #define BLE_HCI_STATUS_CODE_SUCCESS                         0x00 /**< Success. */
 #define BLE_HCI_STATUS_CODE_UNKNOWN_BTLE_COMMAND            0x01 /**< Unknown BLE Command. */
 #define BLE_HCI_STATUS_CODE_UNKNOWN_CONNECTION_IDENTIFIER   0x02 /**< Unknown Connection Identifier. */
@@ -67,16 +72,79 @@ extern "C" {
 /**********************************************************************************************
  * Module exported types
  **********************************************************************************************/
+// The module reaches its user only through callbacks: framed bytes go to the tx sink, decoded
+// messages to the BLERecord pool (see BLERecord_SetNotify) and diagnostics to the log sink.
+// The log sink runs on whichever thread hit the error, so a GUI should only post from it
+typedef bool (*BLEModuleTxSink_t)(const void *data, size_t len); // false if nothing was written
+typedef void (*BLEModuleLogSink_t)(uint8_t level, const char *text);
+
+typedef struct BLEDecoder_s BLEDecoder_t;
+
+// Called with the payload of every valid frame, dec->frameUs holds its arrival time and
+// dec->ctx the context given to BLEDecoder_Init
+typedef void (*BLEDecoderFrameHandler_t)(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+
+typedef struct
+{
+   uint64_t bytes;     // bytes offered to the decoder
+   uint64_t frames;    // valid frames handed to the frame handler
+   uint32_t badHeader; // second header byte wrong
+   uint32_t badLength; // length field out of range
+   uint32_t badCrc;
+} BLEDecoderStats_t;
+
+// Frame decoder for one received byte stream, a dongle link or a capture, or a piece of one,
+// being analysed. Everything the decoder keeps between calls is in here, so decoders running
+// on different threads need no locking as long as their frame handlers share nothing either.
+// The members belong to ble_module.c, the struct is only public so a decoder can be embedded
+// in its owner rather than allocated
+struct BLEDecoder_s
+{
+   uint8_t state;                              // MCURXState_e
+   uint8_t count;                              // bytes of frame stored
+   uint8_t rem;                                // payload and CRC bytes still to come
+   uint8_t crc;                                // CRC of the bytes stored so far
+   uint8_t frame[MCU_PROTOCOL_FRAME_SIZE_MAX]; // frame split across calls
+   uint64_t timeUs;                            // time given to the current BLEDecoder_OnRxBlock
+   uint64_t frameUs;                           // arrival time of the frame being handled
+   BLEDecoderFrameHandler_t handler;
+   void *ctx;
+   uint8_t link;                               // dongle the stream comes from, see BLEDecoder_SetLink
+   BLEDecoderStats_t stats;
+};
+
+typedef struct
+{
+   uint32_t frames; // frames committed
+   uint32_t writes; // calls to the tx sink
+   uint64_t bytes;  // framed bytes committed
+} BLEModuleTxStats_t;
 
 /**********************************************************************************************
  * Module exported functions
  **********************************************************************************************/
+void BLEDecoder_Init(BLEDecoder_t *dec, BLEDecoderFrameHandler_t handler, void *ctx);
+void BLEDecoder_Reset(BLEDecoder_t *dec);
+void BLEDecoder_SetLink(BLEDecoder_t *dec, uint8_t link);
+bool BLEDecoder_IsIdle(const BLEDecoder_t *dec);
+void BLEDecoder_OnRxBlock(BLEDecoder_t *dec, const uint8_t *data, size_t len, uint64_t timeUs);
 void BLEModule_Init(void);
 void BLEModule_OnRx(const uint8_t ch);
-void BLEModule_Tx(const void *payload, size_t payloadLen);
-void BLEModule_Handler(const uint8_t *buf, size_t bufLen);
-void BLEModule_RspHandler(const uint8_t *buf, size_t bufLen);
-void BLEModule_EvtHandler(const uint8_t *buf, size_t bufLen);
+void BLEModule_OnRxBlock(const uint8_t *data, size_t len);
+bool BLEModule_Tx(const void *payload, size_t payloadLen);
+void *BLEModule_TxAlloc(void);
+bool BLEModule_TxCommit(void *payload, size_t payloadLen);
+void BLEModule_TxSetCoalesce(bool enable);
+void BLEModule_TxFlush(void);
+size_t BLEModule_EncodeFrame(uint8_t *frame, const void *payload, size_t payloadLen);
+void BLEModule_SetTxSink(BLEModuleTxSink_t sink);
+void BLEModule_SetLogSink(BLEModuleLogSink_t sink);
+void BLEModule_GetTxStats(BLEModuleTxStats_t *stats, bool clear);
+void BLEModule_Handler(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+void BLEModule_RspHandler(const uint8_t *buf, size_t bufLen, uint8_t link, uint64_t rxUs);
+void BLEModule_EvtHandler(const uint8_t *buf, size_t bufLen, uint8_t link, uint64_t rxUs);
+void BLEModule_FillRecord(BLERecord_t *rec, const uint8_t *buf, size_t bufLen, uint64_t timeUs);
+void BLEModule_FormatRecord(const BLERecord_t *rec, char *buf, size_t size);
 const char *BLEModule_GetNodeType(NodeType_t nodeType);
 const char *BLEModule_GetNodeRole(NodeRole_t nodeRole);
 const char *BLEModule_GetDisconnectReason(uint8_t reason);
@@ -0,0 +1,178 @@
+/**
+ *  @File: blerecord.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      blerecord.cpp
+ *
+ *  @brief     Preallocated pool of decoded message records passed from the rx decode thread
+ *             to the GUI without allocating
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "blerecord.h"
+#include <atomic>
+#include <mutex>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define POOL_MASK (BLE_RECORD_POOL_SIZE - 1u)
+
+static_assert((BLE_RECORD_POOL_SIZE & POOL_MASK) == 0u, "BLE_RECORD_POOL_SIZE must be a power of 2");
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Single consumer (the GUI) and one producer per open link, each link's rx thread runs its own
+// frame handlers. Producers take s_produceLock from BLERecord_Alloc to BLERecord_Commit, so
+// between them they act as the one producer of SpscRing: only the producer moves s_head and
+// only the consumer moves s_tail. The lock is uncontended with a single dongle and the
+// consumer never takes it. s_notifyPending stops the producers signalling again until the
+// consumer has seen the pool empty, so a burst of records costs one queued signal rather than
+// one per record
+static BLERecord_t s_pool[BLE_RECORD_POOL_SIZE];
+alignas(64) static std::atomic<uint32_t> s_head(0);
+alignas(64) static std::atomic<uint32_t> s_tail(0);
+static std::atomic<bool> s_notifyPending(false);
+static std::atomic<uint64_t> s_dropped(0);
+static std::mutex s_produceLock;
+static BLERecordNotify_t s_notify = NULL;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Install the function called when records become available
+ * @param  notify - called on the producer thread, so it should only post to the consumer.
+ *         NULL to poll with BLERecord_Peek instead
+ * @return None
+ */
+void BLERecord_SetNotify(BLERecordNotify_t notify)
+{
+   s_notify = notify;
+}
+
+/**
+ * @brief  Take the next free record. Producer side, other producers wait until it is
+ *         committed so fill it in without blocking
+ * @param  None
+ * @return record to fill in and BLERecord_Commit, NULL if the consumer has fallen behind and
+ *         the pool is full, the message is dropped and counted
+ */
+BLERecord_t *BLERecord_Alloc(void)
+{
+   s_produceLock.lock();
+
+   uint32_t head = s_head.load(std::memory_order_relaxed);
+   if ((head - s_tail.load(std::memory_order_acquire)) >= BLE_RECORD_POOL_SIZE)
+   {
+      s_produceLock.unlock();
+      s_dropped.fetch_add(1u, std::memory_order_relaxed);
+      return NULL;
+   }
+   return &s_pool[head & POOL_MASK];
+}
+
+/**
+ * @brief  Publish the record from BLERecord_Alloc to the consumer. Producer side
+ * @param  None
+ * @return None
+ */
+void BLERecord_Commit(void)
+{
+   s_head.store(s_head.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+   s_produceLock.unlock();
+
+   if (!s_notifyPending.exchange(true) && (NULL != s_notify))
+   {
+      s_notify();
+   }
+}
+
+/**
+ * @brief  Get the oldest published record without removing it. Consumer side. Returning NULL
+ *         rearms the notify, keep calling until it does
+ * @param  None
+ * @return record, valid until BLERecord_Release, or NULL if there are none
+ */
+const BLERecord_t *BLERecord_Peek(void)
+{
+   uint32_t tail = s_tail.load(std::memory_order_relaxed);
+
+   if (tail == s_head.load(std::memory_order_acquire))
+   {
+      // rearm before the final look so a record committed in between is either seen here or
+      // notified again
+      s_notifyPending.store(false);
+      if (tail == s_head.load())
+      {
+         return NULL;
+      }
+   }
+   return &s_pool[tail & POOL_MASK];
+}
+
+/**
+ * @brief  Return the record from BLERecord_Peek to the pool. Consumer side
+ * @param  None
+ * @return None
+ */
+void BLERecord_Release(void)
+{
+   s_tail.store(s_tail.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+}
+
+/**
+ * @brief  Drop every published record. Consumer side
+ * @param  None
+ * @return None
+ */
+void BLERecord_Discard(void)
+{
+   while (NULL != BLERecord_Peek())
+   {
+      BLERecord_Release();
+   }
+}
+
+/**
+ * @brief  Get the number of messages lost because the pool was full
+ * @param  None
+ * @return records dropped since start up
+ */
+uint64_t BLERecord_Dropped(void)
+{
+   return s_dropped.load(std::memory_order_relaxed);
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
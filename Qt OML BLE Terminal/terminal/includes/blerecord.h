@@ -0,0 +1,91 @@
+/**
+ *  @File: blerecord.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      blerecord.h
+ *
+ *  @brief     Defines the decoded message record pool API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "../../OML BLE App/mcu_cmds.h"
+#include "../../OML BLE App/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define BLE_RECORD_POOL_SIZE 4096u // records, power of 2
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+typedef enum
+{
+   eBLE_RECORD_RSP = 0,
+   eBLE_RECORD_EVT,
+} BLERecordKind_e;
+
+// One decoded response or event. The fields the GUI sorts and filters on are pulled out when
+// the frame is handled, the text is only produced by BLEModule_FormatRecord when displayed
+typedef struct
+{
+   uint64_t timeUs;       // frame arrival, TIMER_NowUs
+   uint8_t link;          // dongle the frame came from, 0 for the primary
+   uint8_t kind;          // eBLE_RECORD_xx
+   uint8_t id;            // MCU_RSP_xx or MCU_EVT_xx
+   uint8_t status;        // STATUS_xx if the message has one, else STATUS_SUCCESS
+   int8_t rssi;           // dBm if the message has one, else 0
+   NodeId_t nodeId;       // node the message is about, 0 if none
+   uint8_t nodeType;      // CONFIG_NODE_TYPE_xx if the message has one, else CONFIG_NODE_TYPE_NONE
+   uint8_t len;           // bytes of data
+   uint8_t data[MCU_PROTOCOL_PAYLOAD_MAX]; // frame payload, zero filled past len
+} BLERecord_t;
+
+typedef void (*BLERecordNotify_t)(void);
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+void BLERecord_SetNotify(BLERecordNotify_t notify);
+BLERecord_t *BLERecord_Alloc(void);
+void BLERecord_Commit(void);
+const BLERecord_t *BLERecord_Peek(void);
+void BLERecord_Release(void);
+void BLERecord_Discard(void);
+uint64_t BLERecord_Dropped(void);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,518 @@
+/**
+ *  @File: capture.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      capture.cpp
+ *
+ *  @brief     Records raw link traffic to a capture file from a background writer thread and
+ *             replays captures through the BLE module decoder from a memory mapped file
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "capture.h"
+#include "ble_module.h"
+#include "debug.h"
+#include "timer.h"
+#include <QFile>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <errno.h>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define CAPTURE_BUFFER_SIZE     (1024u * 1024u)  // each of the two writer buffers
+#define CAPTURE_FLUSH_MS        250u             // longest a record waits in memory
+#define REPLAY_PUBLISH_RECORDS  4096u            // records between progress updates
+#define REPLAY_MAX_SLEEP_US     10000u           // so a stop is seen promptly in realtime mode
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void WriterThread(void);
+static void ReplayThread(std::unique_ptr<QFile> file, const uint8_t *base, size_t size, CaptureReplayMode_e mode);
+static void ReplayFrame(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Records come from the rx decode thread and from writers under the serial tx lock, they are
+// appended to s_active under s_lock. Full buffers are swapped to s_spare for the writer thread
+// to put on disk without holding the lock, so a slow disk never stalls the link. If the writer
+// has not finished with s_spare when s_active fills the record is dropped and counted
+static std::mutex s_lock;
+static std::condition_variable s_wake;
+static std::thread s_writer;
+static std::atomic<bool> s_enabled(false);
+static FILE *s_file = NULL;
+static std::vector<uint8_t> s_active;
+static std::vector<uint8_t> s_spare;
+static bool s_spareBusy = false;
+static bool s_stop = false;
+static uint64_t s_startUs = 0;
+static uint64_t s_lastUs = 0;
+static CaptureFileHeader_t s_header;
+
+static std::thread s_replay;
+static std::atomic<bool> s_replayStop(false);
+static std::mutex s_replayLock;
+static CaptureReplayResult_t s_replayResult;
+static bool s_replayHandlers = true;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Start capturing link traffic, stopping any capture already running
+ * @param  path - capture file to create
+ * @return false if the file cannot be created
+ */
+bool Capture_Start(const char *path)
+{
+   Capture_Stop();
+
+   FILE *file = fopen(path, "wb");
+   if (NULL == file)
+   {
+      LOG_ERROR("capture %s: %s\n", path, strerror(errno));
+      return false;
+   }
+
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   (void)memset(&s_header, 0, sizeof(s_header));
+   (void)memcpy(s_header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+   s_header.version = CAPTURE_VERSION;
+   s_header.headerSize = sizeof(CaptureFileHeader_t);
+   s_header.startWallUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::system_clock::now().time_since_epoch()).count();
+
+   // placeholder header, the totals are written over it when the capture stops
+   if (fwrite(&s_header, sizeof(s_header), 1u, file) != 1u)
+   {
+      LOG_ERROR("capture %s: write failed\n", path);
+      (void)fclose(file);
+      return false;
+   }
+
+   s_file = file;
+   s_active.clear();
+   s_active.reserve(CAPTURE_BUFFER_SIZE);
+   s_spare.clear();
+   s_spare.reserve(CAPTURE_BUFFER_SIZE);
+   s_spareBusy = false;
+   s_stop = false;
+   s_startUs = TIMER_NowUs();
+   s_lastUs = s_startUs;
+   s_writer = std::thread(WriterThread);
+   s_enabled = true;
+
+   LOG_INFO("capturing to %s\n", path);
+   return true;
+}
+
+/**
+ * @brief  Stop capturing, write out what is buffered and complete the file header
+ * @param  None
+ * @return None
+ */
+void Capture_Stop(void)
+{
+   if (!s_writer.joinable())
+   {
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      s_enabled = false;
+      s_stop = true;
+   }
+   s_wake.notify_one();
+   s_writer.join();
+
+   std::lock_guard<std::mutex> guard(s_lock);
+   s_header.durationUs = s_lastUs - s_startUs;
+   if ((fseek(s_file, 0, SEEK_SET) != 0) || (fwrite(&s_header, sizeof(s_header), 1u, s_file) != 1u))
+   {
+      LOG_ERROR("capture header write failed\n");
+   }
+   (void)fclose(s_file);
+   s_file = NULL;
+
+   LOG_INFO("capture stopped, %llu records, %llu rx bytes, %llu tx bytes, %llu bytes dropped\n",
+            (unsigned long long)s_header.records, (unsigned long long)s_header.rxBytes,
+            (unsigned long long)s_header.txBytes, (unsigned long long)s_header.droppedBytes);
+}
+
+/**
+ * @brief  Add a chunk of link traffic to the capture. Costs one flag test when not capturing
+ * @param  dir - CAPTURE_DIR_xx
+ * @param  data - bytes as read from or written to the port
+ * @param  len - number of bytes in data
+ * @return None
+ */
+void Capture_Record(uint8_t dir, const void *data, size_t len)
+{
+   if (!s_enabled.load(std::memory_order_relaxed))
+   {
+      return;
+   }
+
+   const uint8_t *pos = static_cast<const uint8_t*>(data);
+   uint64_t nowUs = TIMER_NowUs();
+   bool wake = false;
+
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      if (!s_enabled)
+      {
+         return;
+      }
+      // the rx and tx threads read the clock before taking the lock, keep record times in
+      // file order
+      if (nowUs < s_lastUs)
+      {
+         nowUs = s_lastUs;
+      }
+
+      while (len > 0u)
+      {
+         size_t chunk = (len > CAPTURE_RECORD_MAX) ? CAPTURE_RECORD_MAX : len;
+         size_t need = sizeof(CaptureRecordHeader_t) + chunk;
+
+         if ((s_active.size() + need) > CAPTURE_BUFFER_SIZE)
+         {
+            if (s_spareBusy)
+            {
+               s_header.droppedBytes += len;
+               break;
+            }
+            s_active.swap(s_spare);
+            s_spareBusy = true;
+            wake = true;
+         }
+
+         CaptureRecordHeader_t rec;
+         rec.timeUs = nowUs - s_startUs;
+         rec.len = static_cast<uint16_t>(chunk);
+         rec.dir = dir;
+         rec.link = 0;
+         const uint8_t *recBytes = reinterpret_cast<const uint8_t*>(&rec);
+         s_active.insert(s_active.end(), recBytes, recBytes + sizeof(rec));
+         s_active.insert(s_active.end(), pos, pos + chunk);
+
+         s_header.records++;
+         if (CAPTURE_DIR_RX == dir)
+         {
+            s_header.rxBytes += chunk;
+         }
+         else
+         {
+            s_header.txBytes += chunk;
+         }
+         pos += chunk;
+         len -= chunk;
+      }
+      s_lastUs = nowUs;
+   }
+
+   if (wake)
+   {
+      s_wake.notify_one();
+   }
+}
+
+/**
+ * @brief  Get the progress of the current or last capture
+ * @param  stats - where to store the counters
+ * @return None
+ */
+void Capture_GetStats(CaptureStats_t *stats)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   stats->active = s_enabled;
+   stats->records = s_header.records;
+   stats->bytes = s_header.rxBytes + s_header.txBytes;
+   stats->droppedBytes = s_header.droppedBytes;
+}
+
+/**
+ * @brief  Start replaying a capture through a decoder of its own on a worker thread. The
+ *         frame handlers publish to the same record pool as the serial rx thread so the port
+ *         must be closed
+ * @param  path - capture file
+ * @param  mode - realtime or as fast as possible
+ * @param  handlers - true to run the frame handlers (GUI output included), false to only
+ *         count valid frames so the benchmark measures the parser alone
+ * @return false if a replay is running or the file is not a capture
+ */
+bool Capture_ReplayStart(const char *path, CaptureReplayMode_e mode, bool handlers)
+{
+   if (s_replay.joinable())
+   {
+      CaptureReplayResult_t result;
+      if (Capture_ReplayPoll(&result))
+      {
+         LOG_ERROR("replay already running\n");
+         return false;
+      }
+   }
+
+   std::unique_ptr<QFile> file(new QFile(QString::fromLocal8Bit(path)));
+   if (!file->open(QIODevice::ReadOnly))
+   {
+      LOG_ERROR("replay %s: %s\n", path, qPrintable(file->errorString()));
+      return false;
+   }
+
+   size_t size = static_cast<size_t>(file->size());
+   const uint8_t *base = (size >= sizeof(CaptureFileHeader_t)) ? file->map(0, file->size()) : nullptr;
+   if ((nullptr == base) || !Capture_CheckHeader(base, size))
+   {
+      LOG_ERROR("replay %s: not a capture file\n", path);
+      return false;
+   }
+
+   {
+      std::lock_guard<std::mutex> guard(s_replayLock);
+      (void)memset(&s_replayResult, 0, sizeof(s_replayResult));
+      s_replayResult.running = true;
+   }
+   s_replayStop = false;
+   s_replayHandlers = handlers;
+   s_replay = std::thread(ReplayThread, std::move(file), base, size, mode);
+   return true;
+}
+
+/**
+ * @brief  Get the progress of the current or last replay
+ * @param  result - where to store the counters
+ * @return true while the replay is running
+ */
+bool Capture_ReplayPoll(CaptureReplayResult_t *result)
+{
+   {
+      std::lock_guard<std::mutex> guard(s_replayLock);
+      *result = s_replayResult;
+   }
+
+   if (!result->running && s_replay.joinable())
+   {
+      s_replay.join();
+   }
+   return result->running;
+}
+
+/**
+ * @brief  Stop a replay and wait for the worker to finish
+ * @param  None
+ * @return None
+ */
+void Capture_ReplayStop(void)
+{
+   s_replayStop = true;
+   if (s_replay.joinable())
+   {
+      s_replay.join();
+   }
+}
+
+/**
+ * @brief  Check that a file starts with a capture header this version reads
+ * @param  base - start of the file
+ * @param  size - file size in bytes
+ * @return true if the file is a capture, its records start at headerSize
+ */
+bool Capture_CheckHeader(const void *base, size_t size)
+{
+   const CaptureFileHeader_t *header = static_cast<const CaptureFileHeader_t*>(base);
+   return (size >= sizeof(CaptureFileHeader_t)) &&
+          (memcmp(header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0) &&
+          (header->version == CAPTURE_VERSION) &&
+          (header->headerSize >= sizeof(CaptureFileHeader_t)) &&
+          (header->headerSize <= size);
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Put full buffers on disk, and every CAPTURE_FLUSH_MS whatever has been recorded so
+ *         a crash loses little. Drains everything before exiting on stop
+ * @param  None
+ * @return None
+ */
+static void WriterThread(void)
+{
+   std::unique_lock<std::mutex> lock(s_lock);
+
+   for (;;)
+   {
+      (void)s_wake.wait_for(lock, std::chrono::milliseconds(CAPTURE_FLUSH_MS), [] { return s_spareBusy || s_stop; });
+
+      if (!s_spareBusy && !s_active.empty())
+      {
+         s_active.swap(s_spare);
+         s_spareBusy = true;
+      }
+
+      if (s_spareBusy)
+      {
+         lock.unlock();
+         if (fwrite(s_spare.data(), 1u, s_spare.size(), s_file) != s_spare.size())
+         {
+            LOG_ERROR("capture write failed\n");
+         }
+         (void)fflush(s_file);
+         s_spare.clear();
+         lock.lock();
+         s_spareBusy = false;
+      }
+      else if (s_stop)
+      {
+         break;
+      }
+   }
+}
+
+/**
+ * @brief  Walk the records of a mapped capture, feeding rx chunks to the decoder
+ * @param  file - the mapped capture, unmapped and closed on return
+ * @param  base - start of the mapping
+ * @param  size - bytes mapped
+ * @param  mode - realtime or as fast as possible
+ * @return None
+ */
+static void ReplayThread(std::unique_ptr<QFile> file, const uint8_t *base, size_t size, CaptureReplayMode_e mode)
+{
+   const CaptureFileHeader_t *header = reinterpret_cast<const CaptureFileHeader_t*>(base);
+   const uint8_t *pos = base + header->headerSize;
+   const uint8_t *end = base + size;
+   CaptureReplayResult_t result;
+   uint64_t firstUs = 0;
+   BLEDecoder_t decoder;
+
+   (void)memset(&result, 0, sizeof(result));
+   result.running = true;
+
+   BLEDecoder_Init(&decoder, ReplayFrame, nullptr);
+
+   uint64_t startUs = TIMER_NowUs();
+   while ((pos < end) && !s_replayStop)
+   {
+      CaptureRecordHeader_t rec;
+      if (static_cast<size_t>(end - pos) < sizeof(rec))
+      {
+         result.truncated = true;
+         break;
+      }
+      (void)memcpy(&rec, pos, sizeof(rec));
+      pos += sizeof(rec);
+      if (static_cast<size_t>(end - pos) < rec.len)
+      {
+         result.truncated = true;
+         break;
+      }
+
+      if (0u == result.records)
+      {
+         firstUs = rec.timeUs;
+      }
+      else if (rec.timeUs > (firstUs + result.durationUs))  // a record stamped earlier is played at once
+      {
+         result.durationUs = rec.timeUs - firstUs;
+      }
+
+      if (eCAPTURE_REPLAY_REALTIME == mode)
+      {
+         uint64_t dueUs = startUs + result.durationUs;
+         uint64_t nowUs;
+         while (((nowUs = TIMER_NowUs()) < dueUs) && !s_replayStop)
+         {
+            uint64_t waitUs = dueUs - nowUs;
+            std::this_thread::sleep_for(std::chrono::microseconds((waitUs > REPLAY_MAX_SLEEP_US) ? REPLAY_MAX_SLEEP_US : waitUs));
+         }
+      }
+
+      if (CAPTURE_DIR_RX == rec.dir)
+      {
+         BLEDecoder_OnRxBlock(&decoder, pos, rec.len, BLE_DECODER_NOW);
+         result.rxBytes += rec.len;
+      }
+      else
+      {
+         result.txBytes += rec.len;
+      }
+      pos += rec.len;
+      result.records++;
+
+      if (0u == (result.records % REPLAY_PUBLISH_RECORDS))
+      {
+         result.frames = decoder.stats.frames;
+         result.elapsedUs = TIMER_NowUs() - startUs;
+         std::lock_guard<std::mutex> guard(s_replayLock);
+         s_replayResult = result;
+      }
+   }
+   result.elapsedUs = TIMER_NowUs() - startUs;
+   result.frames = decoder.stats.frames;
+   result.running = false;
+
+   file->unmap(const_cast<uint8_t*>(base));
+   file->close();
+
+   std::lock_guard<std::mutex> guard(s_replayLock);
+   s_replayResult = result;
+}
+
+/**
+ * @brief  Frame handler of the replay decoder, optionally handles each frame
+ * @param  dec - replay decoder, which counts the frames
+ * @param  buf - frame payload
+ * @param  bufLen - number of bytes in buf
+ * @return None
+ */
+static void ReplayFrame(BLEDecoder_t *dec, const uint8_t *buf, size_t bufLen)
+{
+   if (s_replayHandlers)
+   {
+      BLEModule_Handler(dec, buf, bufLen);
+   }
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
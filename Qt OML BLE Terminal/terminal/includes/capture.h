@@ -0,0 +1,128 @@
+/**
+ *  @File: capture.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      capture.h
+ *
+ *  @brief     Defines the link capture and replay API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+// File layout, all fields little endian:
+//   CaptureFileHeader_t, then records of CaptureRecordHeader_t followed by len data bytes.
+// The totals in the header are filled in when the capture is stopped, a file from a capture
+// that never stopped has records == 0 and is replayed by walking the records to the end
+#define CAPTURE_MAGIC        "OMLCAP1"
+#define CAPTURE_VERSION      1u
+#define CAPTURE_EXTENSION    ".omlcap"
+#define CAPTURE_RECORD_MAX   0xFFFFu  // longer chunks are split
+
+#define CAPTURE_DIR_RX       0u       // bytes from the dongle
+#define CAPTURE_DIR_TX       1u       // bytes written to the dongle
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+#pragma pack(push, 1)
+
+typedef struct
+{
+   char magic[8];          // CAPTURE_MAGIC including its terminator
+   uint16_t version;
+   uint16_t headerSize;    // offset of the first record
+   uint32_t reserved;
+   uint64_t startWallUs;   // wall clock at the start of the capture, us since the epoch
+   uint64_t records;
+   uint64_t rxBytes;
+   uint64_t txBytes;
+   uint64_t durationUs;
+   uint64_t droppedBytes;  // not captured because the writer fell behind
+} CaptureFileHeader_t;
+
+typedef struct
+{
+   uint64_t timeUs;        // since the start of the capture
+   uint16_t len;
+   uint8_t dir;            // CAPTURE_DIR_xx
+   uint8_t link;           // OML link a spilled log record came in on, 0 for the serial port
+} CaptureRecordHeader_t;
+
+#pragma pack(pop)
+
+typedef enum
+{
+   eCAPTURE_REPLAY_REALTIME = 0,  // records fed at their captured times
+   eCAPTURE_REPLAY_FAST,          // as fast as the decoder goes, a throughput benchmark
+} CaptureReplayMode_e;
+
+typedef struct
+{
+   bool running;
+   uint64_t records;
+   uint64_t rxBytes;       // fed to the decoder
+   uint64_t txBytes;       // skipped, the host's own writes
+   uint64_t frames;        // valid frames decoded
+   uint64_t durationUs;    // span of the replayed records
+   uint64_t elapsedUs;     // wall time of the replay
+   bool truncated;         // file ended part way through a record
+} CaptureReplayResult_t;
+
+typedef struct
+{
+   bool active;
+   uint64_t records;
+   uint64_t bytes;
+   uint64_t droppedBytes;
+} CaptureStats_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+bool Capture_Start(const char *path);
+void Capture_Stop(void);
+void Capture_Record(uint8_t dir, const void *data, size_t len);
+void Capture_GetStats(CaptureStats_t *stats);
+bool Capture_ReplayStart(const char *path, CaptureReplayMode_e mode, bool handlers);
+bool Capture_ReplayPoll(CaptureReplayResult_t *result);
+void Capture_ReplayStop(void);
+bool Capture_CheckHeader(const void *base, size_t size);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,287 @@
+/**
+ *  @File: cmdqueue.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      cmdqueue.cpp
+ *
+ *  @brief     Implements the pipelined command queue API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "cmdqueue.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "timer.h"
+#include <deque>
+#include <mutex>
+#include <string.h>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+struct QueuedCmd
+{
+   uint8_t payload[MCU_PROTOCOL_PAYLOAD_MAX];
+   size_t payloadLen;
+   uint32_t timeoutMs;
+   CmdTrackerDone_t done;
+   void *ctx;
+};
+
+// passed to the tracker as the completion context of a command on the wire
+struct InFlight
+{
+   bool inUse;
+   CmdTrackerDone_t done;
+   void *ctx;
+};
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void OnDone(void *ctx, CmdTrackerStatus_e status, const uint8_t *rsp, size_t rspLen, uint64_t rttUs);
+static size_t PumpLocked(void);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Pushed from the GUI or scripts, completions arrive on the rx decode thread. Sends happen
+// with s_lock held so the queue order is the wire order
+static std::recursive_mutex s_lock;
+static std::deque<QueuedCmd> s_queue;
+static InFlight s_inFlight[CMD_TRACKER_MAX_OUTSTANDING];
+static uint32_t s_window = CMD_QUEUE_DEFAULT_WINDOW;
+static CmdQueueStats_t s_stats;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Drop queued commands and clear the statistics. Commands already on the wire still
+ *         complete through their callbacks
+ * @param  None
+ * @return None
+ */
+void CmdQueue_Init(void)
+{
+   std::lock_guard<std::recursive_mutex> guard(s_lock);
+   s_queue.clear();
+   uint32_t inFlight = s_stats.inFlight;
+   (void)memset(&s_stats, 0, sizeof(s_stats));
+   s_stats.inFlight = inFlight;
+}
+
+/**
+ * @brief  Set how many commands may await a response at once
+ * @param  window - 1 to CMD_TRACKER_MAX_OUTSTANDING, clamped
+ * @return None
+ */
+void CmdQueue_SetWindow(uint32_t window)
+{
+   std::lock_guard<std::recursive_mutex> guard(s_lock);
+   s_window = (window < 1u) ? 1u : ((window > CMD_TRACKER_MAX_OUTSTANDING) ? CMD_TRACKER_MAX_OUTSTANDING : window);
+   (void)PumpLocked();
+}
+
+/**
+ * @brief  Get the in-flight window
+ * @param  None
+ * @return window size
+ */
+uint32_t CmdQueue_GetWindow(void)
+{
+   std::lock_guard<std::recursive_mutex> guard(s_lock);
+   return s_window;
+}
+
+/**
+ * @brief  Queue a command, sending it straight away if the window has room
+ * @param  payload - command payload, the first byte is the MCU_CMD_* id
+ * @param  payloadLen - number of payload bytes
+ * @param  timeoutMs - time to wait for the response once sent, 0 for the tracker default
+ * @param  done - completion callback, may be NULL
+ * @param  ctx - passed to done
+ * @return false if the queue is full or the payload too long, the caller should back off
+ */
+bool CmdQueue_Push(const void *payload, size_t payloadLen, uint32_t timeoutMs, CmdTrackerDone_t done, void *ctx)
+{
+   std::lock_guard<std::recursive_mutex> guard(s_lock);
+
+   if ((s_queue.size() >= CMD_QUEUE_DEPTH) || (payloadLen == 0u) || (payloadLen > MCU_PROTOCOL_PAYLOAD_MAX))
+   {
+      s_stats.rejected++;
+      return false;
+   }
+
+   QueuedCmd cmd;
+   (void)memcpy(cmd.payload, payload, payloadLen);
+   cmd.payloadLen = payloadLen;
+   cmd.timeoutMs = timeoutMs;
+   cmd.done = done;
+   cmd.ctx = ctx;
+   s_queue.push_back(cmd);
+   s_stats.pushed++;
+
+   (void)PumpLocked();
+   return true;
+}
+
+/**
+ * @brief  Send queued commands while the window has room, call periodically in case the
+ *         tracker was full when a slot freed up
+ * @param  None
+ * @return number of commands still queued
+ */
+size_t CmdQueue_Pump(void)
+{
+   std::lock_guard<std::recursive_mutex> guard(s_lock);
+   return PumpLocked();
+}
+
+/**
+ * @brief  Get the queue statistics
+ * @param  stats - filled with the statistics
+ * @return None
+ */
+void CmdQueue_GetStats(CmdQueueStats_t *stats)
+{
+   std::lock_guard<std::recursive_mutex> guard(s_lock);
+   *stats = s_stats;
+   stats->queued = (uint32_t)s_queue.size();
+}
+
+/**
+ * @brief  Work out the achieved command rate from first send to last completion
+ * @param  stats - statistics from CmdQueue_GetStats
+ * @return completed commands per second
+ */
+uint32_t CmdQueue_Rate(const CmdQueueStats_t *stats)
+{
+   uint64_t elapsedUs = stats->lastDoneUs - stats->firstSendUs;
+   if ((stats->completed == 0u) || (elapsedUs == 0u))
+   {
+      return 0;
+   }
+   return (uint32_t)(((uint64_t)stats->completed * 1000000u) / elapsedUs);
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Tracker completion for a queued command, frees its window slot and sends the next
+ * @param  ctx - the InFlight slot
+ * @param  status - completion status
+ * @param  rsp - response payload, NULL unless status is eCMD_TRACKER_OK
+ * @param  rspLen - number of response bytes
+ * @param  rttUs - round-trip time
+ * @return None
+ */
+static void OnDone(void *ctx, CmdTrackerStatus_e status, const uint8_t *rsp, size_t rspLen, uint64_t rttUs)
+{
+   InFlight *slot = (InFlight *)ctx;
+   CmdTrackerDone_t done;
+   void *doneCtx;
+
+   {
+      std::lock_guard<std::recursive_mutex> guard(s_lock);
+      done = slot->done;
+      doneCtx = slot->ctx;
+      slot->inUse = false;
+      s_stats.inFlight--;
+      if (status == eCMD_TRACKER_OK)
+      {
+         s_stats.completed++;
+      }
+      else if (status == eCMD_TRACKER_REJECTED)
+      {
+         s_stats.unknown++;
+      }
+      else
+      {
+         s_stats.timedOut++;
+      }
+      s_stats.lastDoneUs = TIMER_NowUs();
+      (void)PumpLocked();
+   }
+
+   if (done != NULL)
+   {
+      done(doneCtx, status, rsp, rspLen, rttUs);
+   }
+}
+
+/**
+ * @brief  Send from the head of the queue until the window or the tracker is full
+ * @param  None
+ * @return number of commands still queued
+ */
+static size_t PumpLocked(void)
+{
+   while (!s_queue.empty() && (s_stats.inFlight < s_window))
+   {
+      InFlight *slot = NULL;
+      for (size_t i = 0; i < CMD_TRACKER_MAX_OUTSTANDING; i++)
+      {
+         if (!s_inFlight[i].inUse)
+         {
+            slot = &s_inFlight[i];
+            break;
+         }
+      }
+      if (slot == NULL)
+      {
+         break;
+      }
+
+      const QueuedCmd &cmd = s_queue.front();
+      slot->inUse = true;
+      slot->done = cmd.done;
+      slot->ctx = cmd.ctx;
+      if (CmdTracker_Send(cmd.payload, cmd.payloadLen, cmd.timeoutMs, OnDone, slot) == 0u)
+      {
+         // tracker full of commands sent around the queue, retry on the next pump
+         slot->inUse = false;
+         break;
+      }
+
+      if (s_stats.sent == 0u)
+      {
+         s_stats.firstSendUs = TIMER_NowUs();
+      }
+      s_stats.sent++;
+      s_stats.inFlight++;
+      s_stats.inFlightHighWater = (s_stats.inFlight > s_stats.inFlightHighWater) ? s_stats.inFlight : s_stats.inFlightHighWater;
+      s_queue.pop_front();
+   }
+
+   return s_queue.size();
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
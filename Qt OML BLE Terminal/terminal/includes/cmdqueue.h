@@ -0,0 +1,82 @@
+/**
+ *  @File: cmdqueue.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      cmdqueue.h
+ *
+ *  @brief     Defines the pipelined command queue API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "cmdtracker.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define CMD_QUEUE_DEPTH          1024u // commands waiting for a window slot, pushes beyond this are refused
+#define CMD_QUEUE_DEFAULT_WINDOW 4u
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+typedef struct
+{
+   uint32_t pushed;            // commands accepted
+   uint32_t rejected;          // pushes refused because the queue was full
+   uint32_t sent;
+   uint32_t completed;         // responses received
+   uint32_t timedOut;          // includes commands cancelled by a tracker reset
+   uint32_t unknown;           // answered MCU_RSP_UNKNOWN_COMMAND
+   uint32_t queued;            // waiting now
+   uint32_t inFlight;          // on the wire now
+   uint32_t inFlightHighWater;
+   uint64_t firstSendUs;
+   uint64_t lastDoneUs;
+} CmdQueueStats_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+void CmdQueue_Init(void);
+void CmdQueue_SetWindow(uint32_t window);
+uint32_t CmdQueue_GetWindow(void);
+bool CmdQueue_Push(const void *payload, size_t payloadLen, uint32_t timeoutMs, CmdTrackerDone_t done, void *ctx);
+size_t CmdQueue_Pump(void);
+void CmdQueue_GetStats(CmdQueueStats_t *stats);
+uint32_t CmdQueue_Rate(const CmdQueueStats_t *stats);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
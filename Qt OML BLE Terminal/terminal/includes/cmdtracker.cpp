@@ -0,0 +1,331 @@
+/**
+ *  @File: cmdtracker.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      cmdtracker.cpp
+ *
+ *  @brief     Implements the command/response correlation API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "cmdtracker.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "ble_module.h"
+#include "timer.h"
+#include <deque>
+#include <mutex>
+#include <string.h>
+#include <vector>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+struct Request
+{
+   uint32_t tag;
+   uint8_t cmdId;
+   uint64_t sentUs;
+   uint64_t deadlineUs;
+   CmdTrackerDone_t done;
+   void *ctx;
+};
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void Complete(const std::vector<Request> &requests, CmdTrackerStatus_e status);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Commands are sent from the GUI and scripts, responses and timeouts are handled on the
+// rx decode thread
+static std::mutex s_lock;
+static std::deque<Request> s_outstanding; // in send order, the dongle answers in order
+static CmdTrackerStats_t s_stats[256];
+static uint32_t s_nextTag = 1u;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Cancel everything outstanding and clear the statistics
+ * @param  None
+ * @return None
+ */
+void CmdTracker_Init(void)
+{
+   std::vector<Request> cancelled;
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      cancelled.assign(s_outstanding.begin(), s_outstanding.end());
+      s_outstanding.clear();
+      (void)memset(s_stats, 0, sizeof(s_stats));
+   }
+   Complete(cancelled, eCMD_TRACKER_CANCELLED);
+}
+
+/**
+ * @brief  Record a command about to be sent. Call before the command goes on the wire so a
+ *         fast response cannot arrive untracked
+ * @param  cmdId - MCU_CMD_* id of the command
+ * @param  timeoutMs - time to wait for the response, 0 for CMD_TRACKER_DEFAULT_TIMEOUT_MS
+ * @param  done - completion callback, may be NULL
+ * @param  ctx - passed to done
+ * @return request tag, 0 if CMD_TRACKER_MAX_OUTSTANDING requests are already outstanding
+ */
+uint32_t CmdTracker_Track(uint8_t cmdId, uint32_t timeoutMs, CmdTrackerDone_t done, void *ctx)
+{
+   uint64_t nowUs = TIMER_NowUs();
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (s_outstanding.size() >= CMD_TRACKER_MAX_OUTSTANDING)
+   {
+      return 0;
+   }
+
+   Request request;
+   request.tag = s_nextTag++;
+   if (s_nextTag == 0u)
+   {
+      s_nextTag = 1u;
+   }
+   request.cmdId = cmdId;
+   request.sentUs = nowUs;
+   request.deadlineUs = nowUs + ((uint64_t)((timeoutMs > 0u) ? timeoutMs : CMD_TRACKER_DEFAULT_TIMEOUT_MS) * 1000u);
+   request.done = done;
+   request.ctx = ctx;
+   s_outstanding.push_back(request);
+   s_stats[cmdId].sent++;
+
+   return request.tag;
+}
+
+/**
+ * @brief  Track and transmit a command
+ * @param  payload - command payload, the first byte is the MCU_CMD_* id
+ * @param  payloadLen - number of payload bytes
+ * @param  timeoutMs - time to wait for the response, 0 for CMD_TRACKER_DEFAULT_TIMEOUT_MS
+ * @param  done - completion callback, may be NULL
+ * @param  ctx - passed to done
+ * @return request tag, 0 if the command was not sent because too many are outstanding or
+ *         the frame could not be written
+ */
+uint32_t CmdTracker_Send(const void *payload, size_t payloadLen, uint32_t timeoutMs, CmdTrackerDone_t done, void *ctx)
+{
+   uint32_t tag = CmdTracker_Track(((const uint8_t *)payload)[0], timeoutMs, done, ctx);
+   if ((tag != 0u) && !BLEModule_Tx(payload, payloadLen))
+   {
+      CmdTracker_Untrack(tag);
+      tag = 0;
+   }
+   return tag;
+}
+
+/**
+ * @brief  Forget a tracked command that never went on the wire, without completing it
+ * @param  tag - from CmdTracker_Track
+ * @return None
+ */
+void CmdTracker_Untrack(uint32_t tag)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   for (auto it = s_outstanding.begin(); it != s_outstanding.end(); ++it)
+   {
+      if (it->tag == tag)
+      {
+         s_stats[it->cmdId].sent--;
+         s_outstanding.erase(it);
+         break;
+      }
+   }
+}
+
+/**
+ * @brief  Match a response to the oldest outstanding command with the same id and complete it.
+ *         MCU_RSP_UNKNOWN_COMMAND carries no id, the dongle answers in order so it rejects
+ *         the oldest outstanding command. Call from the frame handler, the round trip ends
+ *         when the frame was validated
+ * @param  rsp - response payload data
+ * @param  rspLen - number of response bytes
+ * @param  rxUs - TIMER_NowUs time the response frame arrived
+ * @return true if the response completed a tracked command
+ */
+bool CmdTracker_OnResponse(const uint8_t *rsp, size_t rspLen, uint64_t rxUs)
+{
+   uint8_t cmdId = (uint8_t)(rsp[0] & (uint8_t)~MCU_RSP_MASK);
+   bool rejected = (MCU_RSP_UNKNOWN_COMMAND == rsp[0]);
+   Request request;
+
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      auto it = s_outstanding.begin();
+      while (!rejected && (it != s_outstanding.end()) && (it->cmdId != cmdId))
+      {
+         ++it;
+      }
+      if (it == s_outstanding.end())
+      {
+         s_stats[cmdId].unmatched++;
+         return false;
+      }
+      request = *it;
+      s_outstanding.erase(it);
+
+      uint64_t rttUs = rxUs - request.sentUs;
+      CmdTrackerStats_t *stats = &s_stats[request.cmdId];
+      if (rejected)
+      {
+         stats->rejected++;
+      }
+      else
+      {
+         stats->rttMinUs = ((stats->completed == 0u) || (rttUs < stats->rttMinUs)) ? rttUs : stats->rttMinUs;
+         stats->rttMaxUs = (rttUs > stats->rttMaxUs) ? rttUs : stats->rttMaxUs;
+         stats->rttTotalUs += rttUs;
+         stats->hist[CmdTracker_HistBucket(rttUs)]++;
+         stats->completed++;
+      }
+   }
+
+   if (request.done != NULL)
+   {
+      request.done(request.ctx, rejected ? eCMD_TRACKER_REJECTED : eCMD_TRACKER_OK, rejected ? NULL : rsp,
+                   rejected ? 0u : rspLen, rxUs - request.sentUs);
+   }
+   return true;
+}
+
+/**
+ * @brief  Time out stale requests, call periodically
+ * @param  None
+ * @return number of requests still outstanding
+ */
+size_t CmdTracker_Poll(void)
+{
+   uint64_t nowUs = TIMER_NowUs();
+   std::vector<Request> expired;
+   size_t outstanding;
+
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      for (auto it = s_outstanding.begin(); it != s_outstanding.end();)
+      {
+         if (nowUs >= it->deadlineUs)
+         {
+            s_stats[it->cmdId].timedOut++;
+            expired.push_back(*it);
+            it = s_outstanding.erase(it);
+         }
+         else
+         {
+            ++it;
+         }
+      }
+      outstanding = s_outstanding.size();
+   }
+
+   Complete(expired, eCMD_TRACKER_TIMEOUT);
+   return outstanding;
+}
+
+/**
+ * @brief  Get the number of commands awaiting a response
+ * @param  None
+ * @return number of outstanding requests
+ */
+size_t CmdTracker_Outstanding(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   return s_outstanding.size();
+}
+
+/**
+ * @brief  Get the counters and round-trip histogram for one command
+ * @param  cmdId - MCU_CMD_* id
+ * @param  stats - filled with the statistics
+ * @return None
+ */
+void CmdTracker_GetStats(uint8_t cmdId, CmdTrackerStats_t *stats)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   *stats = s_stats[cmdId];
+}
+
+/**
+ * @brief  Clear the statistics of every command, outstanding requests are kept
+ * @param  None
+ * @return None
+ */
+void CmdTracker_ResetStats(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   (void)memset(s_stats, 0, sizeof(s_stats));
+}
+
+/**
+ * @brief  Map a time onto a log2 histogram bucket, as used for the round-trip histograms
+ * @param  us - round-trip or other time
+ * @return bucket index, see CMD_TRACKER_HIST_BUCKETS
+ */
+uint32_t CmdTracker_HistBucket(uint64_t us)
+{
+   uint32_t bucket = 0;
+   while ((us > 0u) && (bucket < (CMD_TRACKER_HIST_BUCKETS - 1u)))
+   {
+      us >>= 1;
+      bucket++;
+   }
+   return bucket;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Call the completion callbacks of requests already removed from the outstanding list
+ * @param  requests - requests to complete
+ * @param  status - completion status
+ * @return None
+ */
+static void Complete(const std::vector<Request> &requests, CmdTrackerStatus_e status)
+{
+   uint64_t nowUs = TIMER_NowUs();
+   for (const Request &request : requests)
+   {
+      if (request.done != NULL)
+      {
+         request.done(request.ctx, status, NULL, 0, nowUs - request.sentUs);
+      }
+   }
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,95 @@
+/**
+ *  @File: cmdtracker.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      cmdtracker.h
+ *
+ *  @brief     Defines the command/response correlation API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define CMD_TRACKER_DEFAULT_TIMEOUT_MS 1000u
+#define CMD_TRACKER_MAX_OUTSTANDING    64u
+#define CMD_TRACKER_HIST_BUCKETS       20u // bucket 0 is < 1 us, bucket n is [2^(n-1), 2^n) us, the last is open ended
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+typedef enum
+{
+   eCMD_TRACKER_OK = 0,   // response received
+   eCMD_TRACKER_TIMEOUT,  // no response before the deadline
+   eCMD_TRACKER_CANCELLED, // tracker reset while outstanding
+   eCMD_TRACKER_REJECTED   // the dongle answered MCU_RSP_UNKNOWN_COMMAND
+} CmdTrackerStatus_e;
+
+// Runs on the thread that decoded the response or serviced the timeout, never with the
+// tracker locked. rsp is NULL unless status is eCMD_TRACKER_OK
+typedef void (*CmdTrackerDone_t)(void *ctx, CmdTrackerStatus_e status, const uint8_t *rsp, size_t rspLen, uint64_t rttUs);
+
+typedef struct
+{
+   uint32_t sent;      // commands tracked
+   uint32_t completed; // responses matched
+   uint32_t timedOut;
+   uint32_t unmatched; // responses with nothing outstanding for the command
+   uint32_t rejected;  // answered MCU_RSP_UNKNOWN_COMMAND
+   uint64_t rttMinUs;
+   uint64_t rttMaxUs;
+   uint64_t rttTotalUs;
+   uint32_t hist[CMD_TRACKER_HIST_BUCKETS];
+} CmdTrackerStats_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+void CmdTracker_Init(void);
+uint32_t CmdTracker_Track(uint8_t cmdId, uint32_t timeoutMs, CmdTrackerDone_t done, void *ctx);
+uint32_t CmdTracker_Send(const void *payload, size_t payloadLen, uint32_t timeoutMs, CmdTrackerDone_t done, void *ctx);
+void CmdTracker_Untrack(uint32_t tag);
+bool CmdTracker_OnResponse(const uint8_t *rsp, size_t rspLen, uint64_t rxUs);
+size_t CmdTracker_Poll(void);
+size_t CmdTracker_Outstanding(void);
+void CmdTracker_GetStats(uint8_t cmdId, CmdTrackerStats_t *stats);
+void CmdTracker_ResetStats(void);
+uint32_t CmdTracker_HistBucket(uint64_t us);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,443 @@
+/**
+ *  @File: crc8.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      crc8.cpp
+ *
+ *  @brief     Implements the CRC-8-CCITT API https://crccalc.com/
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "crc8.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CRC8_HAVE_CLMUL 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define CRC8_TARGET_CLMUL
+#else
+#include <cpuid.h>
+#define CRC8_TARGET_CLMUL __attribute__((target("pclmul,ssse3")))
+#endif
+#else
+#define CRC8_HAVE_CLMUL 0
+#endif
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define CRC8_POLY 0x07u // x^8 + x^2 + x + 1
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+typedef uint8_t (*Crc8Fn_t)(uint8_t val, const uint8_t *pos, size_t size);
+
+// s_crc.table[k][v] is the CRC register after feeding v then k zero bytes, which lets
+// slicing-by-N combine N bytes with N independent lookups
+struct Crc8Tables
+{
+   uint8_t table[8][256];
+};
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static uint8_t Crc8Table(uint8_t val, const uint8_t *pos, size_t size);
+static uint8_t Crc8Slice4(uint8_t val, const uint8_t *pos, size_t size);
+static uint8_t Crc8Slice8(uint8_t val, const uint8_t *pos, size_t size);
+#if CRC8_HAVE_CLMUL
+static uint8_t Crc8Clmul(uint8_t val, const uint8_t *pos, size_t size);
+#endif
+static bool CpuHasClmul(void);
+static Crc8Fn_t SelectImpl(void);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+static constexpr Crc8Tables MakeTables()
+{
+   Crc8Tables t{};
+   for (unsigned v = 0; v < 256u; v++)
+   {
+      unsigned crc = v;
+      for (int bit = 0; bit < 8; bit++)
+      {
+         crc = (crc & 0x80u) ? ((crc << 1) ^ CRC8_POLY) : (crc << 1);
+      }
+      t.table[0][v] = (uint8_t)crc;
+   }
+   for (unsigned k = 1; k < 8u; k++)
+   {
+      for (unsigned v = 0; v < 256u; v++)
+      {
+         t.table[k][v] = t.table[0][t.table[k - 1u][v]];
+      }
+   }
+   return t;
+}
+
+// x^n mod P, the folding constants for the carry-less multiply kernel
+static constexpr uint8_t XPowModP(unsigned n)
+{
+   unsigned r = 1u;
+   for (unsigned i = 0; i < n; i++)
+   {
+      r <<= 1;
+      if (r & 0x100u)
+      {
+         r ^= (0x100u | CRC8_POLY);
+      }
+   }
+   return (uint8_t)r;
+}
+
+static constexpr Crc8Tables s_crc = MakeTables();
+
+static constexpr uint8_t CheckValue(const char *str, uint8_t val)
+{
+   return (*str == '\0') ? val : CheckValue(str + 1, s_crc.table[0][val ^ (uint8_t)*str]);
+}
+
+// Standard CRC-8 check value, plus spot checks against the original hand typed table
+static_assert(CheckValue("123456789", 0) == 0xF4, "CRC-8-CCITT table is wrong");
+static_assert((s_crc.table[0][0x01] == 0x07) && (s_crc.table[0][0x80] == 0x89) && (s_crc.table[0][0xFF] == 0xF3),
+              "CRC-8-CCITT table is wrong");
+
+static const Crc8Fn_t s_crcImpl[eCRC8_IMPL_COUNT] = {
+    Crc8Table,
+    Crc8Slice4,
+    Crc8Slice8,
+#if CRC8_HAVE_CLMUL
+    Crc8Clmul,
+#else
+    nullptr,
+#endif
+};
+
+static const char *const s_crcImplName[eCRC8_IMPL_COUNT] = {
+    "table",
+    "slice4",
+    "slice8",
+    "clmul",
+};
+
+// chosen once at startup from the CPU features
+static const Crc8Fn_t s_crcBlock = SelectImpl();
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Calculates the CRC-8-CCITT of the received buffer. https://crccalc.com/
+ * @param  val - init val
+ * @param  data - data to process
+ * @return the CRC-8-CCITT
+ */
+uint8_t crc8ccitt_block(uint8_t val, const void *data, size_t size)
+{
+   return s_crcBlock(val, (const uint8_t *)data, size);
+}
+
+/**
+ * @brief  Folds one byte into a running CRC-8-CCITT, for CRCs built up as bytes arrive
+ * @param  val - running CRC
+ * @param  data - byte to add
+ * @return the updated CRC-8-CCITT
+ */
+uint8_t crc8ccitt_byte(uint8_t val, uint8_t data)
+{
+   return s_crc.table[0][val ^ data];
+}
+
+/**
+ * @brief  Calculates the CRC-8-CCITT with a specific implementation, for testing and benchmarks
+ * @param  impl - implementation to use, must be supported
+ * @param  val - init val
+ * @param  data - data to process
+ * @return the CRC-8-CCITT
+ */
+uint8_t crc8ccitt_block_impl(Crc8Impl_e impl, uint8_t val, const void *data, size_t size)
+{
+   return s_crcImpl[impl](val, (const uint8_t *)data, size);
+}
+
+/**
+ * @brief  Determines if an implementation can run on this CPU
+ * @param  impl - implementation
+ * @return true if it can, false otherwise
+ */
+bool crc8ccitt_impl_supported(Crc8Impl_e impl)
+{
+   if (impl >= eCRC8_IMPL_COUNT)
+   {
+      return false;
+   }
+   if (eCRC8_IMPL_CLMUL == impl)
+   {
+      return (nullptr != s_crcImpl[impl]) && CpuHasClmul();
+   }
+   return true;
+}
+
+/**
+ * @brief  Get the name of an implementation
+ * @param  impl - implementation
+ * @return the name
+ */
+const char *crc8ccitt_impl_name(Crc8Impl_e impl)
+{
+   return (impl < eCRC8_IMPL_COUNT) ? s_crcImplName[impl] : "unknown";
+}
+
+/**
+ * @brief  Get the implementation selected by crc8ccitt_block
+ * @param  None
+ * @return the implementation
+ */
+Crc8Impl_e crc8ccitt_impl_selected(void)
+{
+   for (int impl = 0; impl < eCRC8_IMPL_COUNT; impl++)
+   {
+      if (s_crcImpl[impl] == s_crcBlock)
+      {
+         return (Crc8Impl_e)impl;
+      }
+   }
+   return eCRC8_IMPL_TABLE;
+}
+
+/**
+ * @brief  Cross-check every supported implementation against the byte table over a spread of
+ *         lengths, alignments and init values
+ * @param  None
+ * @return true if all implementations agree, false otherwise
+ */
+bool crc8ccitt_selftest(void)
+{
+   static uint8_t buf[4096 + 16];
+   uint32_t seed = 0x12345678u;
+
+   for (size_t i = 0; i < sizeof(buf); i++)
+   {
+      seed = (seed * 1103515245u) + 12345u;
+      buf[i] = (uint8_t)(seed >> 16);
+   }
+
+   for (int impl = eCRC8_IMPL_SLICE4; impl < eCRC8_IMPL_COUNT; impl++)
+   {
+      if (!crc8ccitt_impl_supported((Crc8Impl_e)impl))
+      {
+         continue;
+      }
+      for (size_t len = 0; len <= 4096u; len = (len < 300u) ? (len + 1u) : (len + 97u))
+      {
+         for (size_t offset = 0; offset < 16u; offset += 5u)
+         {
+            uint8_t init = (uint8_t)(len * 31u + offset);
+            uint8_t expected = Crc8Table(init, &buf[offset], len);
+            if (s_crcImpl[impl](init, &buf[offset], len) != expected)
+            {
+               return false;
+            }
+         }
+      }
+   }
+   return true;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Classic one lookup per byte CRC
+ */
+static uint8_t Crc8Table(uint8_t val, const uint8_t *pos, size_t size)
+{
+   const uint8_t *end = pos + size;
+
+   while (pos < end)
+   {
+      val = s_crc.table[0][val ^ *pos];
+      pos++;
+   }
+
+   return val;
+}
+
+/**
+ * @brief  Slicing-by-4 CRC, four independent lookups per 4 bytes
+ */
+static uint8_t Crc8Slice4(uint8_t val, const uint8_t *pos, size_t size)
+{
+   while (size >= 4u)
+   {
+      val = s_crc.table[3][val ^ pos[0]] ^
+            s_crc.table[2][pos[1]] ^
+            s_crc.table[1][pos[2]] ^
+            s_crc.table[0][pos[3]];
+      pos += 4u;
+      size -= 4u;
+   }
+
+   return Crc8Table(val, pos, size);
+}
+
+/**
+ * @brief  Slicing-by-8 CRC, eight independent lookups per 8 bytes
+ */
+static uint8_t Crc8Slice8(uint8_t val, const uint8_t *pos, size_t size)
+{
+   while (size >= 8u)
+   {
+      val = s_crc.table[7][val ^ pos[0]] ^
+            s_crc.table[6][pos[1]] ^
+            s_crc.table[5][pos[2]] ^
+            s_crc.table[4][pos[3]] ^
+            s_crc.table[3][pos[4]] ^
+            s_crc.table[2][pos[5]] ^
+            s_crc.table[1][pos[6]] ^
+            s_crc.table[0][pos[7]];
+      pos += 8u;
+      size -= 8u;
+   }
+
+   return Crc8Table(val, pos, size);
+}
+
+#if CRC8_HAVE_CLMUL
+/**
+ * @brief  Carry-less multiply CRC. 16 byte blocks are loaded most significant byte first and
+ *         folded together with x^n mod P constants, four lanes at a time for long buffers.
+ *         The folded 128 bits are congruent to the message mod P, so a table pass over them
+ *         gives the CRC
+ */
+CRC8_TARGET_CLMUL static uint8_t Crc8Clmul(uint8_t val, const uint8_t *pos, size_t size)
+{
+   if (size < 32u)
+   {
+      return Crc8Slice8(val, pos, size);
+   }
+
+   const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+   const __m128i k128 = _mm_set_epi64x(XPowModP(128u + 64u), XPowModP(128u));
+   const __m128i k512 = _mm_set_epi64x(XPowModP(512u + 64u), XPowModP(512u));
+
+   // the init value is the same as xoring it into the first byte
+   __m128i acc = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pos), bswap);
+   acc = _mm_xor_si128(acc, _mm_slli_si128(_mm_cvtsi32_si128(val), 15));
+   pos += 16u;
+   size -= 16u;
+
+   if (size >= 64u)
+   {
+      __m128i lane[4];
+      lane[0] = acc;
+      for (int i = 1; i < 4; i++)
+      {
+         lane[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pos), bswap);
+         pos += 16u;
+         size -= 16u;
+      }
+
+      while (size >= 64u)
+      {
+         for (int i = 0; i < 4; i++)
+         {
+            __m128i hi = _mm_clmulepi64_si128(lane[i], k512, 0x11);
+            __m128i lo = _mm_clmulepi64_si128(lane[i], k512, 0x00);
+            __m128i next = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(pos + (16 * i))), bswap);
+            lane[i] = _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+         }
+         pos += 64u;
+         size -= 64u;
+      }
+
+      acc = lane[0];
+      for (int i = 1; i < 4; i++)
+      {
+         __m128i hi = _mm_clmulepi64_si128(acc, k128, 0x11);
+         __m128i lo = _mm_clmulepi64_si128(acc, k128, 0x00);
+         acc = _mm_xor_si128(_mm_xor_si128(hi, lo), lane[i]);
+      }
+   }
+
+   while (size >= 16u)
+   {
+      __m128i hi = _mm_clmulepi64_si128(acc, k128, 0x11);
+      __m128i lo = _mm_clmulepi64_si128(acc, k128, 0x00);
+      __m128i next = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)pos), bswap);
+      acc = _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+      pos += 16u;
+      size -= 16u;
+   }
+
+   uint8_t folded[16];
+   _mm_storeu_si128((__m128i *)folded, _mm_shuffle_epi8(acc, bswap));
+   val = Crc8Slice8(0, folded, sizeof(folded));
+
+   return Crc8Slice8(val, pos, size);
+}
+#endif
+
+/**
+ * @brief  Determines if the CPU supports PCLMULQDQ and SSSE3
+ */
+static bool CpuHasClmul(void)
+{
+#if CRC8_HAVE_CLMUL
+   unsigned ecx;
+#if defined(_MSC_VER)
+   int regs[4];
+   __cpuid(regs, 1);
+   ecx = (unsigned)regs[2];
+#else
+   unsigned eax, ebx, edx;
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+   {
+      return false;
+   }
+#endif
+   return ((ecx & (1u << 1)) != 0u) && ((ecx & (1u << 9)) != 0u); // PCLMULQDQ, SSSE3
+#else
+   return false;
+#endif
+}
+
+/**
+ * @brief  Pick the fastest implementation this CPU supports
+ */
+static Crc8Fn_t SelectImpl(void)
+{
+   return crc8ccitt_impl_supported(eCRC8_IMPL_CLMUL) ? s_crcImpl[eCRC8_IMPL_CLMUL] : s_crcImpl[eCRC8_IMPL_SLICE8];
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
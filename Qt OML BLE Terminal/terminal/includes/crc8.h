@@ -40,11 +40,25 @@ extern "C" {
 /**********************************************************************************************
  * Module exported types
  **********************************************************************************************/
+typedef enum
+{
+   eCRC8_IMPL_TABLE = 0,
+   eCRC8_IMPL_SLICE4,
+   eCRC8_IMPL_SLICE8,
+   eCRC8_IMPL_CLMUL,
+   eCRC8_IMPL_COUNT
+} Crc8Impl_e;
 
 /**********************************************************************************************
  * Module exported functions
  **********************************************************************************************/
 uint8_t crc8ccitt_block(uint8_t val, const void *data, size_t size);
+uint8_t crc8ccitt_byte(uint8_t val, uint8_t data);
+uint8_t crc8ccitt_block_impl(Crc8Impl_e impl, uint8_t val, const void *data, size_t size);
+bool crc8ccitt_impl_supported(Crc8Impl_e impl);
+const char *crc8ccitt_impl_name(Crc8Impl_e impl);
+Crc8Impl_e crc8ccitt_impl_selected(void);
+bool crc8ccitt_selftest(void);
 
 /**********************************************************************************************
  * Module exported variables
@@ -28,6 +28,7 @@
 #include "timer.h"
 #include <stdarg.h>
 #include <stdio.h>
+#include <string.h>
 
 /**********************************************************************************************
  * Module constant defines
@@ -38,6 +39,8 @@
 #define COLOR_RED    "\033[0;31m"
 #define COLOR_CYAN   "\033[0;36m"
 
+#define TRACE_RECORD_MAX 512u // longer records are truncated
+
 /**********************************************************************************************
  * External functions
  **********************************************************************************************/
@@ -45,14 +48,28 @@
 /**********************************************************************************************
  * Module type definitions
  **********************************************************************************************/
+#pragma pack(push, 1)
+
+typedef struct
+{
+   uint64_t timeUs; // TIMER_NowUs
+   uint8_t id;
+   uint16_t len;
+   // data[len]
+} TraceRecordHeader_t;
+
+#pragma pack(pop)
 
 /**********************************************************************************************
  * Module static variables
  **********************************************************************************************/
+volatile bool g_dbgTraceEnabled = false;
+static FILE *s_traceFile = NULL;
 
 /**********************************************************************************************
  * Module static function prototypes
  **********************************************************************************************/
+static void PrintStamp(const char *colour);
 
 /**********************************************************************************************
  * Module externally exported functions
@@ -73,6 +90,10 @@ void DBG(const uint8_t level, const char *format, ...)
       const char *colour = COLOUR_NONE;
       switch (level)
       {
+         case DEBUG_LEVEL_TRACE:
+            levelStr = "T";
+            break;
+
          case DEBUG_LEVEL_INFO:
             levelStr = "I";
             colour = COLOR_GREEN;
@@ -92,7 +113,8 @@ void DBG(const uint8_t level, const char *format, ...)
             break;
       }
 
-      (void)printf("%s%08lld %s: ", colour, TIMER_NowMs(), levelStr);
+      PrintStamp(colour);
+      (void)printf("%s: ", levelStr);
 
       va_list paramList;
       va_start(paramList, format);
@@ -122,7 +144,7 @@ void DBG_Rsp(int status, const char *format, ...)
       colour = COLOR_RED;
    }
 
-   (void)printf("%s%08lld ", colour, TIMER_NowMs());
+   PrintStamp(colour);
 
    va_list paramList;
    va_start(paramList, format);
@@ -142,7 +164,7 @@ void DBG_Evt(const char *format, ...)
 {
    const char *colour = COLOR_CYAN;
 
-   (void)printf("%s%08lld ", colour, TIMER_NowMs());
+   PrintStamp(colour);
 
    va_list paramList;
    va_start(paramList, format);
@@ -229,10 +251,87 @@ void DBG_Hex(const char *desc, const void *addr, const uint16_t len, int perLine
    printf("  %s\n", buff);
 }
 
+/**
+ * @brief  Start writing binary trace records to a file, replacing any previous trace file.
+ *         Switch the sink while the link is idle, records are written from the serial rx
+ *         thread as well as the GUI thread
+ * @param  path - trace file to create
+ * @return true if the file was opened, false otherwise
+ */
+bool DBG_TraceOpen(const char *path)
+{
+   DBG_TraceClose();
+
+   s_traceFile = fopen(path, "wb");
+   g_dbgTraceEnabled = (NULL != s_traceFile);
+
+   return g_dbgTraceEnabled;
+}
+
+/**
+ * @brief  Stop writing binary trace records and close the trace file
+ * @param  None
+ * @return None
+ */
+void DBG_TraceClose(void)
+{
+   g_dbgTraceEnabled = false;
+
+   if (NULL != s_traceFile)
+   {
+      (void)fclose(s_traceFile);
+      s_traceFile = NULL;
+   }
+}
+
+/**
+ * @brief  Write one timestamped binary trace record. Use DBG_TRACE() so the call costs a
+ *         single flag test when the sink is off
+ * @param  id - DEBUG_TRACE_xx record id
+ * @param  data - record data
+ * @param  len - number of bytes in data
+ * @return None
+ */
+void DBG_Trace(uint8_t id, const void *data, size_t len)
+{
+   uint8_t record[sizeof(TraceRecordHeader_t) + TRACE_RECORD_MAX];
+   TraceRecordHeader_t *hdr = (TraceRecordHeader_t *)record;
+   FILE *file = s_traceFile;
+
+   if (NULL == file)
+   {
+      return;
+   }
+
+   if (len > TRACE_RECORD_MAX)
+   {
+      len = TRACE_RECORD_MAX;
+   }
+
+   hdr->timeUs = TIMER_NowUs();
+   hdr->id = id;
+   hdr->len = (uint16_t)len;
+   (void)memcpy(&record[sizeof(TraceRecordHeader_t)], data, len);
+
+   // one fwrite per record so records from different threads do not interleave
+   (void)fwrite(record, sizeof(TraceRecordHeader_t) + len, 1u, file);
+}
+
 /**********************************************************************************************
  * Module static functions
  **********************************************************************************************/
 
+/**
+ * @brief  Start a debug line with its colour and a ms.us timestamp
+ * @param  colour - colour escape sequence
+ * @return None
+ */
+static void PrintStamp(const char *colour)
+{
+   uint64_t nowUs = TIMER_NowUs();
+   (void)printf("%s%08llu.%03u ", colour, (unsigned long long)(nowUs / 1000u), (unsigned)(nowUs % 1000u));
+}
+
 /**********************************************************************************************
  * End of file
  **********************************************************************************************/
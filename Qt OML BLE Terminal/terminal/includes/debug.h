@@ -37,13 +37,21 @@ extern "C" {
 /**********************************************************************************************
  * Module exported defines
  **********************************************************************************************/
+#define DEBUG_LEVEL_TRACE 0u
 #define DEBUG_LEVEL_INFO  1u
 #define DEBUG_LEVEL_WARN  2u
 #define DEBUG_LEVEL_ERROR 3u
 #define DEBUG_LEVEL_NONE  4u
 
-// Set global debug level here
+// Set global debug level here, or with DEFINES += DEBUG_LEVEL_ENABLED=... in the .pro
+#ifndef DEBUG_LEVEL_ENABLED
 #define DEBUG_LEVEL_ENABLED DEBUG_LEVEL_INFO
+#endif
+
+// Set to 0 to compile the binary trace sink out completely
+#ifndef DEBUG_TRACE_SINK
+#define DEBUG_TRACE_SINK 1u
+#endif
 
 // Enable/Disable the individual module debug here
 #define DEBUG_APP        1u
@@ -67,7 +75,45 @@ extern "C" {
 #define DEBUG_SCAN       1u
 #define DEBUG_UART       1u
 
-#define DEBUG_LEVEL_ERROR 3u
+// Levelled logging, levels below DEBUG_LEVEL_ENABLED compile to nothing
+#if (DEBUG_LEVEL_TRACE >= DEBUG_LEVEL_ENABLED)
+#define LOG_TRACE(...) DBG(DEBUG_LEVEL_TRACE, __VA_ARGS__)
+#else
+#define LOG_TRACE(...) ((void)0)
+#endif
+
+#if (DEBUG_LEVEL_INFO >= DEBUG_LEVEL_ENABLED)
+#define LOG_INFO(...) DBG(DEBUG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if (DEBUG_LEVEL_WARN >= DEBUG_LEVEL_ENABLED)
+#define LOG_WARN(...) DBG(DEBUG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if (DEBUG_LEVEL_ERROR >= DEBUG_LEVEL_ENABLED)
+#define LOG_ERROR(...) DBG(DEBUG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+// Binary trace records, switched on at runtime with DBG_TraceOpen()
+#define DEBUG_TRACE_RX 1u // raw bytes as received
+#define DEBUG_TRACE_TX 2u // payload of a transmitted frame
+
+#if DEBUG_TRACE_SINK
+#define DBG_TRACE(id, data, len) \
+    do { \
+        if (g_dbgTraceEnabled) { \
+            DBG_Trace((id), (data), (len)); \
+        } \
+    } while (0)
+#else
+#define DBG_TRACE(id, data, len) ((void)0)
+#endif
 
 /**********************************************************************************************
  * Module exported types
@@ -80,10 +126,14 @@ void DBG(const uint8_t level, const char *format, ...);
 void DBG_Rsp(int status, const char *format, ...);
 void DBG_Evt(const char *format, ...);
 void DBG_Hex(const char *desc, const void *addr, const uint16_t len, int perLine);
+bool DBG_TraceOpen(const char *path);
+void DBG_TraceClose(void);
+void DBG_Trace(uint8_t id, const void *data, size_t len);
 
 /**********************************************************************************************
  * Module exported variables
  **********************************************************************************************/
+extern volatile bool g_dbgTraceEnabled;
 
 #ifdef __cplusplus
 }
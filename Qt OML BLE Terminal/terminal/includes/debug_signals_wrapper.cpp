@@ -23,4 +23,9 @@ void emitDebugMain(const char *message)
 {
     emit DebugSignals::instance().debugMain(QString(message));
 }
+
+void emitDebugRecords(void)
+{
+    emit DebugSignals::instance().recordsReady();
+}
 }// extern "C"
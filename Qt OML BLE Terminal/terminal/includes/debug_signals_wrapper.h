@@ -9,6 +9,7 @@ void emitDebugEvent(const char *message);
 void emitDebugResponse(const char *message);
 void emitDebugHex(const char *message);
 void emitDebugMain(const char *message);
+void emitDebugRecords(void);
 
 #ifdef __cplusplus
 }
@@ -20,6 +20,7 @@ signals:
     void debugResponse(const QString &message);
     void debugHex(const QString &message);
     void debugMain(const QString &message);
+    void recordsReady();  // decoded records waiting in the BLERecord pool
 
 private:
     DebugSignals() {}  // Private constructor for singleton pattern
@@ -0,0 +1,226 @@
+#include "logmodel.h"
+#include "ble_module.h"
+#include "logspill.h"
+#include <QBrush>
+#include <QColor>
+
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_spill(nullptr)
+    , m_capacity(capacity > 0 ? capacity : 1)
+    , m_first(0)
+    , m_count(0)
+    , m_evicted(0)
+{
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_count;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= m_count))
+    {
+        return QVariant();
+    }
+
+    const Entry &entry = entryAt(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole: {
+        // one line per row keeps the row heights uniform, the tooltip has the rest
+        QString text = entryText(entry);
+        text.replace('\n', ' ');
+        return text;
+    }
+    case Qt::ToolTipRole:
+        return entry.isRecord ? entryText(entry) : QVariant();
+    case LinkRole:
+        return entry.isRecord ? QVariant(QString::number(entry.rec.link)) : QVariant(QString());
+    case Qt::ForegroundRole:
+        if (entry.kind == KindEvent)
+        {
+            return QBrush(QColor("blue"));
+        }
+        if (entry.kind == KindResponse)
+        {
+            return QBrush(QColor("green"));
+        }
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+void LogModel::appendText(const QString &text, Kind kind)
+{
+    QString body = text;
+    while (body.endsWith('\n'))
+    {
+        body.chop(1);
+    }
+
+    // plain text keeps one row per line, as the text edit showed it
+    const QStringList lines = (kind == KindText) ? body.split('\n') : QStringList(body);
+    for (const QString &line : lines)
+    {
+        Entry entry;
+        entry.kind = static_cast<quint8>(kind);
+        entry.isRecord = false;
+        entry.text = line;
+        m_pending.append(entry);
+    }
+}
+
+void LogModel::appendRecord(const BLERecord_t &rec)
+{
+    Entry entry;
+    entry.kind = (rec.kind == eBLE_RECORD_EVT) ? KindEvent : KindResponse;
+    entry.isRecord = true;
+    entry.rec = rec;
+    m_pending.append(entry);
+}
+
+void LogModel::flush()
+{
+    if (m_pending.isEmpty())
+    {
+        return;
+    }
+
+    // more than a ring's worth queued, only the newest can be shown and every row in the
+    // ring goes. The ring rows are older, so they are spilled before the queued overflow
+    int incoming = m_pending.size();
+    int overflow = (incoming > m_capacity) ? (incoming - m_capacity) : 0;
+    incoming -= overflow;
+
+    int evict = m_count + incoming - m_capacity;
+    if (evict > 0)
+    {
+        beginRemoveRows(QModelIndex(), 0, evict - 1);
+        for (int row = 0; row < evict; row++)
+        {
+            spill(entryAt(row));
+        }
+        m_first = (m_first + evict) % m_capacity;
+        m_count -= evict;
+        m_evicted += static_cast<quint64>(evict);
+        endRemoveRows();
+    }
+
+    if (overflow > 0)
+    {
+        for (int index = 0; index < overflow; index++)
+        {
+            spill(m_pending.at(index));
+        }
+        m_pending.erase(m_pending.begin(), m_pending.begin() + overflow);
+        m_evicted += static_cast<quint64>(overflow);
+    }
+
+    beginInsertRows(QModelIndex(), m_count, m_count + incoming - 1);
+    for (Entry &entry : m_pending)
+    {
+        int slot = (m_first + m_count) % m_capacity;
+        if (slot < m_ring.size())
+        {
+            m_ring[slot] = std::move(entry);
+        }
+        else
+        {
+            m_ring.append(std::move(entry));
+        }
+        m_count++;
+    }
+    endInsertRows();
+    m_pending.clear();
+}
+
+// Change how many rows are kept, the oldest rows go if it shrinks
+void LogModel::setCapacity(int capacity)
+{
+    capacity = (capacity > 0) ? capacity : 1;
+    flush();
+
+    beginResetModel();
+    int keep = (m_count < capacity) ? m_count : capacity;
+    for (int row = 0; row < (m_count - keep); row++)
+    {
+        spill(entryAt(row));
+    }
+    m_evicted += static_cast<quint64>(m_count - keep);
+
+    QVector<Entry> ring;
+    ring.reserve(keep);
+    for (int row = m_count - keep; row < m_count; row++)
+    {
+        ring.append(std::move(m_ring[(m_first + row) % m_capacity]));
+    }
+    m_ring.swap(ring);
+    m_capacity = capacity;
+    m_first = 0;
+    m_count = keep;
+    endResetModel();
+}
+
+void LogModel::clear()
+{
+    beginResetModel();
+    m_pending.clear();
+    // let the rows go, the ring grows back as new ones arrive
+    QVector<Entry>().swap(m_ring);
+    m_first = 0;
+    m_count = 0;
+    endResetModel();
+}
+
+QString LogModel::rowText(int row) const
+{
+    return ((row >= 0) && (row < m_count)) ? entryText(entryAt(row)) : QString();
+}
+
+// Search the rows held in memory, the spill files are searched separately
+int LogModel::find(const QString &needle, int maxHits, QStringList *hits) const
+{
+    int found = 0;
+    for (int row = 0; (row < m_count) && (found < maxHits); row++)
+    {
+        QString text = entryText(entryAt(row));
+        if (text.contains(needle, Qt::CaseInsensitive))
+        {
+            hits->append(text.replace('\n', ' '));
+            found++;
+        }
+    }
+    return found;
+}
+
+const LogModel::Entry &LogModel::entryAt(int row) const
+{
+    return m_ring.at((m_first + row) % m_capacity);
+}
+
+QString LogModel::entryText(const Entry &entry)
+{
+    if (!entry.isRecord)
+    {
+        return entry.text;
+    }
+
+    char text[512];
+    BLEModule_FormatRecord(&entry.rec, text, sizeof(text));
+    QString message = QString::fromLatin1(text).trimmed();
+    QString link = (entry.rec.link != 0u) ? QString("[link %1] ").arg(entry.rec.link) : QString();
+    return link + ((entry.kind == KindEvent) ? QString("Event: ") : QString("Response: ")) + message;
+}
+
+// Only decoded records are spilled, plain text rows are just dropped
+void LogModel::spill(const Entry &entry)
+{
+    if ((m_spill != nullptr) && entry.isRecord)
+    {
+        m_spill->write(entry.rec);
+    }
+}
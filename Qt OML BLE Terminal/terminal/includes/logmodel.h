@@ -0,0 +1,74 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "blerecord.h"
+
+class LogSpill;
+
+// Terminal log for a QListView. Rows live in a fixed-capacity ring, the oldest
+// are dropped once it is full, or handed to a LogSpill to be kept on disk. Appends are queued and only reach the view when
+// flush() is called, so a storm costs one insert per flush rather than one per
+// row. Decoded records are kept as records and only turned into text for the
+// rows the view asks for.
+class LogModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Kind
+    {
+        KindText = 0,
+        KindEvent,
+        KindResponse
+    };
+
+    enum Role
+    {
+        LinkRole = Qt::UserRole  // link number of a record row, empty for a text row
+    };
+
+    explicit LogModel(int capacity, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void appendText(const QString &text, Kind kind = KindText);
+    void appendRecord(const BLERecord_t &rec);
+    bool hasPending() const { return !m_pending.isEmpty(); }
+    void flush();
+    void clear();
+
+    QString rowText(int row) const;
+    int find(const QString &needle, int maxHits, QStringList *hits) const;
+    void setCapacity(int capacity);
+    int capacity() const { return m_capacity; }
+    void setSpill(LogSpill *spill) { m_spill = spill; }
+    quint64 evicted() const { return m_evicted; }
+
+private:
+    struct Entry
+    {
+        quint8 kind;
+        bool isRecord;
+        BLERecord_t rec;
+        QString text;
+    };
+
+    const Entry &entryAt(int row) const;
+    static QString entryText(const Entry &entry);
+    void spill(const Entry &entry);
+
+    QVector<Entry> m_ring;
+    QVector<Entry> m_pending;
+    LogSpill *m_spill;
+    int m_capacity;
+    int m_first;
+    int m_count;
+    quint64 m_evicted;
+};
+
+#endif // LOGMODEL_H
@@ -0,0 +1,212 @@
+#include "logspill.h"
+#include "ble_module.h"
+#include "crc8.h"
+#include "timer.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include <QDateTime>
+#include <QDir>
+#include <string.h>
+
+#define SPILL_FILE_PREFIX "oml_log_"
+
+LogSpill::LogSpill()
+    : m_fileBytes(0)
+    , m_files(0)
+    , m_index(0)
+    , m_firstUs(0)
+    , m_records(0)
+{
+}
+
+LogSpill::~LogSpill()
+{
+    stop();
+}
+
+bool LogSpill::start(const QString &dir, qint64 fileBytes, int files)
+{
+    stop();
+    if (!QDir().mkpath(dir))
+    {
+        return false;
+    }
+
+    m_dir = dir;
+    m_fileBytes = fileBytes;
+    m_files = (files > 0) ? files : 1;
+    m_index = 0;
+    m_records = 0;
+
+    // leftovers from an earlier session would be mixed into searches
+    for (int index = 0; index < m_files; index++)
+    {
+        QFile::remove(filePath(index));
+    }
+    return openFile();
+}
+
+void LogSpill::stop()
+{
+    closeFile();
+}
+
+void LogSpill::write(const BLERecord_t &rec)
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+    if ((m_header.records > 0u) && (m_file.pos() >= m_fileBytes))
+    {
+        // the next slot holds the oldest file, opening it truncates it
+        closeFile();
+        m_index++;
+        if (!openFile())
+        {
+            return;
+        }
+    }
+
+    if (0u == m_header.records)
+    {
+        // records are older than the file, date the file from its first record
+        m_firstUs = rec.timeUs;
+        m_header.startWallUs = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()) * 1000u -
+                               (TIMER_NowUs() - rec.timeUs);
+    }
+
+    uint8_t frame[MCU_PROTOCOL_FRAME_SIZE_MAX];
+    frame[0] = MCU_PROTOCOL_FRAME_HEADER1;
+    frame[1] = MCU_PROTOCOL_FRAME_HEADER2;
+    frame[2] = static_cast<uint8_t>(rec.len + 1u);
+    memcpy(&frame[3], rec.data, rec.len);
+    frame[3u + rec.len] = crc8ccitt_block(0, frame, 3u + rec.len);
+
+    CaptureRecordHeader_t header;
+    // records from several links can reach the log slightly out of order, never date one
+    // before the file
+    header.timeUs = (rec.timeUs > m_firstUs) ? (rec.timeUs - m_firstUs) : 0u;
+    header.len = static_cast<uint16_t>(rec.len + 4u);
+    header.dir = CAPTURE_DIR_RX;
+    header.link = rec.link;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.write(reinterpret_cast<const char*>(frame), header.len);
+
+    m_header.records++;
+    m_header.rxBytes += header.len;
+    m_header.durationUs = (header.timeUs > m_header.durationUs) ? header.timeUs : m_header.durationUs;
+    m_records++;
+}
+
+void LogSpill::flush()
+{
+    if (m_file.isOpen())
+    {
+        m_file.flush();
+    }
+}
+
+// oldest first
+QStringList LogSpill::files() const
+{
+    QStringList paths;
+    for (int index = m_index - m_files + 1; index <= m_index; index++)
+    {
+        if ((index >= 0) && QFile::exists(filePath(index)))
+        {
+            paths.append(filePath(index));
+        }
+    }
+    return paths;
+}
+
+int LogSpill::search(const QString &needle, int maxHits, QStringList *hits) const
+{
+    int found = 0;
+    const QStringList paths = files();
+    for (const QString &path : paths)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly) || (file.size() < static_cast<qint64>(sizeof(CaptureFileHeader_t))))
+        {
+            continue;
+        }
+        const uint8_t *base = file.map(0, file.size());
+        if (base == nullptr)
+        {
+            continue;
+        }
+
+        // the header of the file being written is only complete in memory
+        const CaptureFileHeader_t *header = reinterpret_cast<const CaptureFileHeader_t*>(base);
+        uint64_t startWallUs = (path == m_file.fileName()) ? m_header.startWallUs : header->startWallUs;
+        const uint8_t *pos = base + header->headerSize;
+        const uint8_t *end = base + file.size();
+        while ((found < maxHits) && (static_cast<size_t>(end - pos) >= sizeof(CaptureRecordHeader_t)))
+        {
+            CaptureRecordHeader_t rec;
+            memcpy(&rec, pos, sizeof(rec));
+            pos += sizeof(rec);
+            if (static_cast<size_t>(end - pos) < rec.len)
+            {
+                break; // the file being written, not flushed yet
+            }
+
+            // one whole frame per record, the payload sits between the length byte and crc
+            if ((rec.len >= 5u) && (pos[2] == rec.len - 3u))
+            {
+                BLERecord_t record;
+                char text[512];
+                BLEModule_FillRecord(&record, &pos[3], rec.len - 4u, startWallUs + rec.timeUs);
+                record.link = rec.link;
+                BLEModule_FormatRecord(&record, text, sizeof(text));
+                QString line = QString::fromLatin1(text).trimmed();
+                if (line.contains(needle, Qt::CaseInsensitive))
+                {
+                    QDateTime when = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>((startWallUs + rec.timeUs) / 1000u));
+                    hits->append(when.toString("hh:mm:ss.zzz ") + line.replace('\n', ' '));
+                    found++;
+                }
+            }
+            pos += rec.len;
+        }
+        file.unmap(const_cast<uint8_t*>(base));
+    }
+    return found;
+}
+
+QString LogSpill::filePath(int index) const
+{
+    return QDir(m_dir).filePath(QString(SPILL_FILE_PREFIX "%1" CAPTURE_EXTENSION).arg(index % m_files));
+}
+
+bool LogSpill::openFile()
+{
+    m_file.setFileName(filePath(m_index));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        return false;
+    }
+
+    memset(&m_header, 0, sizeof(m_header));
+    memcpy(m_header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    m_header.version = CAPTURE_VERSION;
+    m_header.headerSize = sizeof(CaptureFileHeader_t);
+    m_header.startWallUs = static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()) * 1000u;
+
+    // placeholder header, the totals are written over it when the file is closed
+    return m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header)) == sizeof(m_header);
+}
+
+void LogSpill::closeFile()
+{
+    if (!m_file.isOpen())
+    {
+        return;
+    }
+    if (m_file.seek(0))
+    {
+        m_file.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+    }
+    m_file.close();
+}
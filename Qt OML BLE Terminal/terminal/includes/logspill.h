@@ -0,0 +1,49 @@
+#ifndef LOGSPILL_H
+#define LOGSPILL_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include "blerecord.h"
+#include "capture.h"
+
+// Writes decoded records pushed out of the log ring to disk, so the log can stay
+// a fixed size in memory without losing history. Each record is re-framed and
+// stored as an rx record of the capture format, so a spill file can also be fed
+// to replay. Files rotate: once a file reaches the size limit the next one is
+// started and the oldest beyond the file limit is deleted.
+class LogSpill
+{
+public:
+    LogSpill();
+    ~LogSpill();
+
+    bool start(const QString &dir, qint64 fileBytes, int files);
+    void stop();
+    bool isActive() const { return m_file.isOpen(); }
+
+    void write(const BLERecord_t &rec);
+    void flush();
+
+    QStringList files() const;
+    int search(const QString &needle, int maxHits, QStringList *hits) const;
+
+    QString dir() const { return m_dir; }
+    quint64 records() const { return m_records; }
+
+private:
+    QString filePath(int index) const;
+    bool openFile();
+    void closeFile();
+
+    QString m_dir;
+    qint64 m_fileBytes;
+    int m_files;
+    int m_index;
+    QFile m_file;
+    CaptureFileHeader_t m_header;
+    uint64_t m_firstUs;
+    quint64 m_records;
+};
+
+#endif // LOGSPILL_H
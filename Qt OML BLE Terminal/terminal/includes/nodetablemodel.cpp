@@ -0,0 +1,200 @@
+#include "nodetablemodel.h"
+#include "ble_module.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "../../OML BLE App/utils.h"
+#include <QDateTime>
+
+NodeTableModel::NodeTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_dirtyFirst(-1)
+    , m_dirtyLast(-1)
+    , m_adverts(0)
+{
+}
+
+int NodeTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_nodes.size();
+}
+
+int NodeTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant NodeTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= m_nodes.size()))
+    {
+        return QVariant();
+    }
+
+    const Node &node = m_nodes.at(index.row());
+    if (role == Qt::DisplayRole)
+    {
+        // numbers rather than text so a sorting view orders them numerically, the node id
+        // combo shows the id in decimal and reads it back with toUInt
+        bool advertised = (node.adverts > 0u);
+        switch (index.column())
+        {
+        case ColumnNodeId: return static_cast<uint>(node.nodeId);
+        case ColumnNodeType: return static_cast<uint>(node.nodeType);
+        case ColumnAdverts: return node.adverts;
+        case ColumnRssi: return advertised ? QVariant(node.rssi) : QVariant();
+        case ColumnRssiMin: return advertised ? QVariant(node.rssiMin) : QVariant();
+        case ColumnRssiAvg: return advertised ? QVariant(qRound(static_cast<double>(node.rssiSum) / node.adverts)) : QVariant();
+        case ColumnRssiMax: return advertised ? QVariant(node.rssiMax) : QVariant();
+        case ColumnFwVersion: return QString("%1.%2").arg(node.fwMajor).arg(node.fwMinor);
+        case ColumnPairedNodeId: return static_cast<uint>(node.pairedNodeId);
+        case ColumnFirstSeen: return QDateTime::fromMSecsSinceEpoch(node.firstMs).toString("hh:mm:ss.zzz");
+        case ColumnLastSeen: return QDateTime::fromMSecsSinceEpoch(node.lastMs).toString("hh:mm:ss.zzz");
+        default: break;
+        }
+    }
+    else if ((role == Qt::ToolTipRole) && (index.column() == ColumnNodeType))
+    {
+        return QString(BLEModule_GetNodeType(static_cast<NodeType_t>(node.nodeType)));
+    }
+    return QVariant();
+}
+
+QVariant NodeTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+    {
+        return QVariant();
+    }
+
+    switch (section)
+    {
+    case ColumnNodeId: return QString("Node Id");
+    case ColumnNodeType: return QString("Type");
+    case ColumnAdverts: return QString("Adverts");
+    case ColumnRssi: return QString("RSSI");
+    case ColumnRssiMin: return QString("Min");
+    case ColumnRssiAvg: return QString("Avg");
+    case ColumnRssiMax: return QString("Max");
+    case ColumnFwVersion: return QString("FW");
+    case ColumnPairedNodeId: return QString("Paired");
+    case ColumnFirstSeen: return QString("First seen");
+    case ColumnLastSeen: return QString("Last seen");
+    default: return QVariant();
+    }
+}
+
+// wallMs and nowUs are one reading of the wall clock and TIMER_NowUs, the record is dated
+// from its own rx time against them
+void NodeTableModel::onRecord(const BLERecord_t &rec, qint64 wallMs, quint64 nowUs)
+{
+    if (rec.kind != eBLE_RECORD_EVT)
+    {
+        return;
+    }
+    qint64 seenMs = wallMs - ((static_cast<qint64>(nowUs) - static_cast<qint64>(rec.timeUs)) / 1000);
+
+    // the events that identify a node along with its type
+    switch (rec.id)
+    {
+    case MCU_EVT_NODE_FOUND: {
+        const MCU_EVT_NODE_FOUND_t *evt = reinterpret_cast<const MCU_EVT_NODE_FOUND_t*>(rec.data);
+        int row = rowFor(rec, seenMs);
+        Node &node = m_nodes[row];
+        if (0u == node.adverts)
+        {
+            node.rssiMin = rec.rssi;
+            node.rssiMax = rec.rssi;
+        }
+        node.adverts++;
+        node.rssi = rec.rssi;
+        node.rssiMin = (rec.rssi < node.rssiMin) ? rec.rssi : node.rssiMin;
+        node.rssiMax = (rec.rssi > node.rssiMax) ? rec.rssi : node.rssiMax;
+        node.rssiSum += rec.rssi;
+        node.fwMajor = evt->fwVersionMajor;
+        node.fwMinor = evt->fwVersionMinor;
+        node.pairedNodeId = GetNodeIdFromArrayBytes(evt->pairedNodeId);
+        m_adverts++;
+        break;
+    }
+    case MCU_EVT_BLE_REBOOT: {
+        const MCU_EVT_BLE_REBOOT_t *evt = reinterpret_cast<const MCU_EVT_BLE_REBOOT_t*>(rec.data);
+        Node &node = m_nodes[rowFor(rec, seenMs)];
+        node.fwMajor = evt->fwMajor;
+        node.fwMinor = evt->fwMinor;
+        break;
+    }
+    case MCU_EVT_NODE_PAIRED:
+    case MCU_EVT_NODE_PAIR_FAILED:
+    case MCU_EVT_NODE_UNPAIRED:
+        (void)rowFor(rec, seenMs);
+        break;
+    default:
+        break;
+    }
+}
+
+// Tell the view about the rows changed since the last flush, in one signal
+void NodeTableModel::flush()
+{
+    if (m_dirtyFirst >= 0)
+    {
+        emit dataChanged(index(m_dirtyFirst, 0), index(m_dirtyLast, ColumnCount - 1));
+        m_dirtyFirst = -1;
+        m_dirtyLast = -1;
+    }
+}
+
+void NodeTableModel::clear()
+{
+    beginResetModel();
+    m_nodes.clear();
+    m_rowById.clear();
+    m_typeSeen.reset();
+    m_dirtyFirst = -1;
+    m_dirtyLast = -1;
+    m_adverts = 0;
+    endResetModel();
+}
+
+// Find or add the row of the node a record is about and bring its type and times up to date
+int NodeTableModel::rowFor(const BLERecord_t &rec, qint64 seenMs)
+{
+    if (!m_typeSeen.test(rec.nodeType))
+    {
+        m_typeSeen.set(rec.nodeType);
+        emit nodeTypeAdded(rec.nodeType);
+    }
+
+    QHash<NodeId_t, int>::const_iterator it = m_rowById.constFind(rec.nodeId);
+    if (it == m_rowById.constEnd())
+    {
+        Node node = {};
+        node.nodeId = rec.nodeId;
+        node.nodeType = rec.nodeType;
+        node.firstMs = seenMs;
+        node.lastMs = seenMs;
+
+        // the new row is filled in by the caller after it is inserted, it goes out with the
+        // next flush like any other change
+        int row = m_nodes.size();
+        beginInsertRows(QModelIndex(), row, row);
+        m_nodes.append(node);
+        m_rowById.insert(rec.nodeId, row);
+        endInsertRows();
+        markDirty(row);
+        return row;
+    }
+
+    Node &node = m_nodes[it.value()];
+    node.nodeType = rec.nodeType;
+    // records from several links can arrive slightly out of order
+    node.firstMs = (seenMs < node.firstMs) ? seenMs : node.firstMs;
+    node.lastMs = (seenMs > node.lastMs) ? seenMs : node.lastMs;
+    markDirty(it.value());
+    return it.value();
+}
+
+void NodeTableModel::markDirty(int row)
+{
+    m_dirtyFirst = ((m_dirtyFirst < 0) || (row < m_dirtyFirst)) ? row : m_dirtyFirst;
+    m_dirtyLast = (row > m_dirtyLast) ? row : m_dirtyLast;
+}
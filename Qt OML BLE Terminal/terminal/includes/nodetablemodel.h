@@ -0,0 +1,82 @@
+#ifndef NODETABLEMODEL_H
+#define NODETABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QVector>
+#include <bitset>
+#include "blerecord.h"
+
+// Nodes reported by the dongle, one row per node id in the order they were first
+// seen. Fed straight from decoded records, a row is found through m_rowById so a
+// scan storm costs a hash lookup per event rather than a search of the combo.
+// MCU_EVT_NODE_FOUND adverts are aggregated into their node's row in place and
+// the view is told about changed rows once per flush(), so the cost of showing
+// a scan follows the number of nodes rather than the number of adverts.
+class NodeTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        ColumnNodeId = 0,
+        ColumnNodeType,
+        ColumnAdverts,
+        ColumnRssi,
+        ColumnRssiMin,
+        ColumnRssiAvg,
+        ColumnRssiMax,
+        ColumnFwVersion,
+        ColumnPairedNodeId,
+        ColumnFirstSeen,
+        ColumnLastSeen,
+        ColumnCount
+    };
+
+    explicit NodeTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void onRecord(const BLERecord_t &rec, qint64 wallMs, quint64 nowUs);
+    void flush();
+    void clear();
+
+    bool hasPending() const { return m_dirtyFirst >= 0; }
+    quint64 adverts() const { return m_adverts; }
+
+signals:
+    void nodeTypeAdded(int nodeType);  // first node of this type
+
+private:
+    struct Node
+    {
+        NodeId_t nodeId;
+        NodeId_t pairedNodeId;
+        uint8_t nodeType;
+        uint8_t fwMajor;
+        uint8_t fwMinor;
+        int8_t rssi;
+        int8_t rssiMin;
+        int8_t rssiMax;
+        qint64 rssiSum;
+        quint32 adverts;
+        qint64 firstMs;
+        qint64 lastMs;
+    };
+
+    int rowFor(const BLERecord_t &rec, qint64 seenMs);
+    void markDirty(int row);
+
+    QVector<Node> m_nodes;
+    QHash<NodeId_t, int> m_rowById;
+    std::bitset<256> m_typeSeen;
+    int m_dirtyFirst;
+    int m_dirtyLast;
+    quint64 m_adverts;
+};
+
+#endif // NODETABLEMODEL_H
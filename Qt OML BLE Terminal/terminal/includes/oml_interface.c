@@ -25,13 +25,17 @@
  * Module includes
  **********************************************************************************************/
 #include "oml_interface.h"
-#include "..\..\OML BLE App\mcu_cmds.h"
-#include "..\..\OML BLE App\types.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "../../OML BLE App/types.h"
 #include "ble_module.h"
+#include "capture.h"
+#include "cmdqueue.h"
+#include "cmdtracker.h"
+#include "debug.h"
+#include "pingbench.h"
 #include "serial.h"
-#include <stdio.h>
+#include "timer.h"
 #include <string.h>
-#include <windows.h>
 
 /**********************************************************************************************
  * Module constant defines
@@ -60,12 +64,15 @@
 
 /**
  * @brief  Open the comm port interface to the OML BLE module
- * @param  port  - enumerated port number
+ * @param  portName - port to open, e.g. COM3, /dev/ttyACM0 or a pty
  * @return true if port opened OK, false otherwise
  */
-bool OMLInterface_Open(uint8_t port)
+bool OMLInterface_Open(const char *portName)
 {
-   if (!SerialOpen(port, MCU_BAUD_RATE))
+   BLEModule_Init();
+   SerialSetRxCallback(OMLInterface_Process);
+
+   if (!SerialOpen(portName, MCU_BAUD_RATE))
 
 
    {
@@ -84,10 +91,7 @@ bool OMLInterface_Open(uint8_t port)
  */
 void OMLInterface_Purge(void)
 {
-   while (SerialRxPending())
-   {
-      (void)SerialReadData();
-   }
+   SerialFifoRxPurge();
 }
 
 /**
@@ -101,17 +105,26 @@ void OMLInterface_Close(void)
 }
 
 /**
- * @brief  Run the OML BLE interface
+ * @brief  Run the OML BLE interface. Registered as the serial rx callback so it runs on the
+ *         serial rx thread, decoding straight out of the rx ring
  * @param  None
  * @return None
  */
 void OMLInterface_Process(void)
 {
-   while (SerialRxPending())
+   const uint8_t *rx;
+   size_t rxLen;
+
+   while ((rxLen = SerialRxPeek(&rx)) > 0u)
    {
-      uint8_t ch = SerialReadData();
-      BLEModule_OnRx(ch);
+      Capture_Record(CAPTURE_DIR_RX, rx, rxLen);
+      BLEModule_OnRxBlock(rx, rxLen);
+      SerialRxConsume(rxLen);
    }
+
+   (void)CmdTracker_Poll();
+   (void)CmdQueue_Pump();
+   (void)PingBench_Poll();
 }
 
 /**
@@ -136,17 +149,17 @@ bool OMLInterface_Wake(void)
 
    if (SerialClrRts())
    {
-      printf("CLRRTS\n");
-      Sleep(100u);
-      printf("SETRTS\n");
+      LOG_INFO("CLRRTS\n");
+      TIMER_DelayMs(100u);
+      LOG_INFO("SETRTS\n");
       if (SerialSetRts())
       {
-         Sleep(100u);
-         printf("CLRRTS\n");
+         TIMER_DelayMs(100u);
+         LOG_INFO("CLRRTS\n");
          if (SerialClrRts())
          {
-            Sleep(100u);
-            printf("AUTORTS\n");
+            TIMER_DelayMs(100u);
+            LOG_INFO("AUTORTS\n");
             if (SerialAutoRts())
             {
                ret = true;
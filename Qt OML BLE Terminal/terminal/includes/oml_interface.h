@@ -27,6 +27,7 @@
  **********************************************************************************************/
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -44,7 +45,7 @@ extern "C" {
 /**********************************************************************************************
  * Module exported functions
  **********************************************************************************************/
-bool OMLInterface_Open(uint8_t port);
+bool OMLInterface_Open(const char *portName);
 void OMLInterface_Purge(void);
 void OMLInterface_Close(void);
 void OMLInterface_Process(void);
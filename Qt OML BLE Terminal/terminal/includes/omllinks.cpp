@@ -0,0 +1,261 @@
+/**
+ *  @File: omllinks.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      omllinks.cpp
+ *
+ *  @brief     Dongles open alongside the primary one, each read and decoded on its own
+ *             threads
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "omllinks.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "seriallink.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string.h>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define MCU_BAUD_RATE 1000000u
+#define RX_RING_SIZE  65536u    // as the primary link
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+// The serial link and decoder belong to the link's rx thread once it is open, other threads
+// only see the decoder counters through the copy in stats
+struct Link
+{
+   explicit Link(uint8_t id) : serial(RX_RING_SIZE), txFrames(0)
+   {
+      BLEDecoder_Init(&decoder, BLEModule_Handler, nullptr);
+      BLEDecoder_SetLink(&decoder, id);
+      (void)memset(&stats, 0, sizeof(stats));
+   }
+
+   SerialLink serial;
+   BLEDecoder_t decoder;
+   char port[OML_LINKS_PORT_MAX];
+   std::mutex statsLock;
+   BLEDecoderStats_t stats;
+   std::atomic<uint64_t> txFrames;
+};
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static void Process(Link *link);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Opened and closed from one thread, the GUI or the headless terminal's main loop. Slot 0
+// stands for the primary dongle and stays empty
+static std::unique_ptr<Link> s_links[OML_LINKS_MAX];
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Open another dongle with the primary link's serial backend. Its frames are decoded
+ *         on its own rx thread and published as records tagged with the link id
+ * @param  portName - port to open, e.g. COM4 or /dev/ttyACM1
+ * @return link id, 1 to OML_LINKS_MAX - 1, or 0 if every link is in use or the port would not
+ *         open
+ */
+uint8_t OMLLinks_Open(const char *portName)
+{
+   uint8_t id = 1;
+   while ((id < OML_LINKS_MAX) && (s_links[id] != nullptr))
+   {
+      id++;
+   }
+   if (id >= OML_LINKS_MAX)
+   {
+      return 0;
+   }
+
+   std::unique_ptr<Link> link(new Link(id));
+   (void)strncpy(link->port, portName, sizeof(link->port) - 1u);
+   link->port[sizeof(link->port) - 1u] = '\0';
+
+   Link *raw = link.get();
+   link->serial.setRxCallback([raw]() { Process(raw); });
+   if (!link->serial.open(SerialGetBackend(), QString::fromLocal8Bit(portName), MCU_BAUD_RATE, QString("link %1").arg(id)))
+   {
+      return 0;
+   }
+   link->serial.purgeInput();
+
+   s_links[id] = std::move(link);
+   return id;
+}
+
+/**
+ * @brief  Close a dongle opened by OMLLinks_Open. Its records already in the pool are kept
+ * @param  link - link id
+ * @return false if the link is not open
+ */
+bool OMLLinks_Close(uint8_t link)
+{
+   if (!OMLLinks_IsOpen(link))
+   {
+      return false;
+   }
+   s_links[link]->serial.close();
+   s_links[link].reset();
+   return true;
+}
+
+/**
+ * @brief  Close every dongle opened by OMLLinks_Open
+ * @param  None
+ * @return None
+ */
+void OMLLinks_CloseAll(void)
+{
+   for (uint8_t link = 1; link < OML_LINKS_MAX; link++)
+   {
+      (void)OMLLinks_Close(link);
+   }
+}
+
+/**
+ * @brief  Check whether a link opened by OMLLinks_Open is in use
+ * @param  link - link id
+ * @return true if open
+ */
+bool OMLLinks_IsOpen(uint8_t link)
+{
+   return (link > 0u) && (link < OML_LINKS_MAX) && (s_links[link] != nullptr);
+}
+
+/**
+ * @brief  Find the link a port is open on
+ * @param  portName - port name as given to OMLLinks_Open
+ * @return link id, 0 if no extra link has the port open
+ */
+uint8_t OMLLinks_Find(const char *portName)
+{
+   for (uint8_t link = 1; link < OML_LINKS_MAX; link++)
+   {
+      if ((s_links[link] != nullptr) && (strcmp(s_links[link]->port, portName) == 0))
+      {
+         return link;
+      }
+   }
+   return 0;
+}
+
+/**
+ * @brief  Frame a payload and send it to one dongle. Link 0 goes through BLEModule_Tx, so
+ *         the frame is coalesced and captured like any other command
+ * @param  link - link id
+ * @param  payload - payload data
+ * @param  payloadLen - number of payload bytes
+ * @return false if the link is not open or the payload size is bad
+ */
+bool OMLLinks_Transmit(uint8_t link, const void *payload, size_t payloadLen)
+{
+   if (0u == link)
+   {
+      return BLEModule_Tx(payload, payloadLen);
+   }
+   if (!OMLLinks_IsOpen(link))
+   {
+      return false;
+   }
+
+   uint8_t frame[MCU_PROTOCOL_FRAME_SIZE_MAX];
+   size_t frameLen = BLEModule_EncodeFrame(frame, payload, payloadLen);
+   if ((0u == frameLen) || !s_links[link]->serial.write(frame, frameLen))
+   {
+      return false;
+   }
+   s_links[link]->txFrames++;
+   return true;
+}
+
+/**
+ * @brief  Get the port, serial and decoder counters of a link opened by OMLLinks_Open
+ * @param  link - link id
+ * @param  stats - filled with the counters, open is false if the link is not open
+ * @return false if the link is not open
+ */
+bool OMLLinks_GetStats(uint8_t link, OMLLinkStats_t *stats)
+{
+   (void)memset(stats, 0, sizeof(*stats));
+   if (!OMLLinks_IsOpen(link))
+   {
+      return false;
+   }
+
+   Link *l = s_links[link].get();
+   stats->open = l->serial.isOpen();
+   (void)memcpy(stats->port, l->port, sizeof(stats->port));
+   l->serial.getRxStats(&stats->rx);
+   {
+      std::lock_guard<std::mutex> guard(l->statsLock);
+      stats->decoder = l->stats;
+   }
+   stats->txFrames = l->txFrames;
+   return true;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Rx callback of a link, runs on its rx thread and decodes straight out of its ring
+ * @param  link - link to drain
+ * @return None
+ */
+static void Process(Link *link)
+{
+   SpscRing &ring = link->serial.rxRing();
+   const uint8_t *rx;
+   size_t rxLen;
+   bool decoded = false;
+
+   while ((rxLen = ring.readSpan(&rx)) > 0u)
+   {
+      BLEDecoder_OnRxBlock(&link->decoder, rx, rxLen, BLE_DECODER_NOW);
+      ring.commitRead(rxLen);
+      decoded = true;
+   }
+
+   if (decoded)
+   {
+      std::lock_guard<std::mutex> guard(link->statsLock);
+      link->stats = link->decoder.stats;
+   }
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,81 @@
+/**
+ *  @File: omllinks.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      omllinks.h
+ *
+ *  @brief     Defines the API for the dongles open alongside the primary one
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "ble_module.h"
+#include "serial.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define OML_LINKS_MAX       8u  // dongles open at once, counting the primary
+#define OML_LINKS_PORT_MAX  64u // characters of port name kept, with the terminator
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+// Link 0 is the primary dongle, opened by OMLInterface_Open, which commands, the command
+// tracker, the benchmarks and the capture use. Links 1 to OML_LINKS_MAX - 1 are extra dongles,
+// each with its own port io thread, rx thread and decoder. Their messages reach the record
+// pool tagged with the link id, so the views can merge them or pick one link out
+typedef struct
+{
+   bool open;
+   char port[OML_LINKS_PORT_MAX];
+   SerialRxStats_t rx;
+   BLEDecoderStats_t decoder;
+   uint64_t txFrames;
+} OMLLinkStats_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+uint8_t OMLLinks_Open(const char *portName);
+bool OMLLinks_Close(uint8_t link);
+void OMLLinks_CloseAll(void);
+bool OMLLinks_IsOpen(uint8_t link);
+uint8_t OMLLinks_Find(const char *portName);
+bool OMLLinks_Transmit(uint8_t link, const void *payload, size_t payloadLen);
+bool OMLLinks_GetStats(uint8_t link, OMLLinkStats_t *stats);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,418 @@
+/**
+ *  @File: payloadstats.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      payloadstats.cpp
+ *
+ *  @brief     Streaming statistics of the payloads received from each node, in constant memory
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "payloadstats.h"
+#include "timer.h"
+#include <mutex>
+#include <string.h>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+// Gaps below GAP_LINEAR_MAX us get a bucket each, above that every power of 2 is split into
+// 2^GAP_SUB_BITS buckets, so a bucket is at most 1/8 of its value wide
+#define GAP_SUB_BITS      3u
+#define GAP_SUB_BUCKETS   (1u << GAP_SUB_BITS)
+#define GAP_LINEAR_MAX    (2u * GAP_SUB_BUCKETS)
+#define GAP_LINEAR_BITS   4u                 // log2(GAP_LINEAR_MAX)
+#define GAP_TOP_BIT       35u                // gaps of 2^36 us (19 hours) and over share the last bucket
+#define GAP_BUCKETS       (GAP_LINEAR_MAX + ((GAP_TOP_BIT + 1u - GAP_LINEAR_BITS) * GAP_SUB_BUCKETS))
+
+#define RSSI_BUCKETS      256u               // one per dBm
+
+#define RATE_SLOTS        10u                // the rate window is kept as this many slots
+#define RATE_SLOT_US      ((PAYLOAD_STATS_WINDOW_MS * 1000u) / RATE_SLOTS)
+
+#define JITTER_SHIFT      4u                 // RFC 3550 gain of 1/16
+#define RSSI_AVG_SHIFT    3u                 // moving average gain of 1/8
+
+#define INDEX_SIZE        (PAYLOAD_STATS_MAX_NODES * 2u)  // power of 2, at most half full
+
+static_assert((INDEX_SIZE & (INDEX_SIZE - 1u)) == 0u, "PAYLOAD_STATS_MAX_NODES must be a power of 2");
+static_assert(PAYLOAD_STATS_MAX_NODES < 256u, "s_index holds node numbers in a byte");
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+typedef struct
+{
+   uint64_t epoch;         // absolute slot number the counts belong to
+   uint32_t packets;
+   uint32_t bytes;
+} RateSlot_t;
+
+typedef struct
+{
+   NodeId_t nodeId;
+   uint64_t packets;
+   uint64_t bytes;
+   uint64_t firstUs;
+   uint64_t lastUs;
+   uint64_t lastGapUs;
+   uint64_t gapTotalUs;
+   uint64_t gapMaxUs;
+   uint64_t gaps;
+   int64_t jitterQ4;       // jitter * 16, as the RFC 3550 appendix A.8 estimator
+   int32_t rssiAvgQ4;      // rssi * 16
+   int8_t rssi;
+   int8_t rssiMin;
+   int8_t rssiMax;
+   RateSlot_t rate[RATE_SLOTS];
+   uint32_t gapHist[GAP_BUCKETS];
+   uint32_t rssiHist[RSSI_BUCKETS];
+} Node_t;
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static Node_t *FindNode(NodeId_t nodeId, bool add);
+static uint32_t GapBucket(uint64_t gapUs);
+static uint64_t GapBucketMid(uint32_t bucket);
+static uint32_t HistRank(const uint32_t *hist, uint32_t buckets, uint64_t samples, uint32_t percent);
+static void Snapshot(const Node_t *node, uint64_t nowUs, PayloadStats_t *stats);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Payloads are counted on the rx decode thread, snapshots are taken by the GUI. Nodes are added
+// in arrival order and never removed until PayloadStats_Reset, s_index maps a node id to its
+// place in s_nodes + 1 with linear probing
+static std::mutex s_lock;
+static Node_t s_nodes[PAYLOAD_STATS_MAX_NODES];
+static uint8_t s_index[INDEX_SIZE];
+static size_t s_nodeCount = 0;
+static uint64_t s_untracked = 0;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Count a payload received from a node, called for each MCU_EVT_RX_PAYLOAD
+ * @param  nodeId - source node
+ * @param  len - payload bytes
+ * @param  rssi - dBm
+ * @param  nowUs - arrival time, TIMER_NowUs
+ * @return None
+ */
+void PayloadStats_OnRxPayload(NodeId_t nodeId, size_t len, int8_t rssi, uint64_t nowUs)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   Node_t *node = FindNode(nodeId, true);
+   if (node == NULL)
+   {
+      s_untracked++;
+      return;
+   }
+
+   if (node->packets == 0u)
+   {
+      node->firstUs = nowUs;
+      node->rssiMin = rssi;
+      node->rssiMax = rssi;
+      node->rssiAvgQ4 = (int32_t)rssi * 16;
+   }
+   else if (nowUs >= node->lastUs)  // two dongles hearing the node can report it out of order
+   {
+      uint64_t gapUs = nowUs - node->lastUs;
+      if (node->gaps > 0u)
+      {
+         int64_t d = (int64_t)gapUs - (int64_t)node->lastGapUs;
+         node->jitterQ4 += ((d < 0) ? -d : d) - ((node->jitterQ4 + 8) >> JITTER_SHIFT);
+      }
+      node->lastGapUs = gapUs;
+      node->gapTotalUs += gapUs;
+      node->gapMaxUs = (gapUs > node->gapMaxUs) ? gapUs : node->gapMaxUs;
+      node->gaps++;
+      node->gapHist[GapBucket(gapUs)]++;
+   }
+
+   node->packets++;
+   node->bytes += len;
+   node->lastUs = (nowUs > node->lastUs) ? nowUs : node->lastUs;
+
+   node->rssi = rssi;
+   node->rssiMin = (rssi < node->rssiMin) ? rssi : node->rssiMin;
+   node->rssiMax = (rssi > node->rssiMax) ? rssi : node->rssiMax;
+   node->rssiAvgQ4 += (((int32_t)rssi * 16) - node->rssiAvgQ4) / (1 << RSSI_AVG_SHIFT);
+   node->rssiHist[(uint8_t)(rssi + 128)]++;
+
+   uint64_t epoch = nowUs / RATE_SLOT_US;
+   RateSlot_t *slot = &node->rate[epoch % RATE_SLOTS];
+   if (slot->epoch != epoch)
+   {
+      slot->epoch = epoch;
+      slot->packets = 0;
+      slot->bytes = 0;
+   }
+   slot->packets++;
+   slot->bytes += (uint32_t)len;
+}
+
+/**
+ * @brief  Get the statistics of every node, in the order they were first heard
+ * @param  stats - filled with up to maxNodes entries
+ * @param  maxNodes - entries in stats
+ * @return number of entries filled in
+ */
+size_t PayloadStats_GetNodes(PayloadStats_t *stats, size_t maxNodes)
+{
+   uint64_t nowUs = TIMER_NowUs();
+   size_t count = 0;
+
+   // the lock is taken per node so the rx thread is never held off for the whole table
+   while (count < maxNodes)
+   {
+      {
+         std::lock_guard<std::mutex> guard(s_lock);
+         if (count >= s_nodeCount)
+         {
+            break;
+         }
+         Snapshot(&s_nodes[count], nowUs, &stats[count]);
+      }
+      count++;
+   }
+   return count;
+}
+
+/**
+ * @brief  Get the statistics of one node
+ * @param  nodeId - source node
+ * @param  stats - filled in if the node has been heard
+ * @return false if nothing has been received from the node
+ */
+bool PayloadStats_Get(NodeId_t nodeId, PayloadStats_t *stats)
+{
+   uint64_t nowUs = TIMER_NowUs();
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   const Node_t *node = FindNode(nodeId, false);
+   if (node == NULL)
+   {
+      return false;
+   }
+   Snapshot(node, nowUs, stats);
+   return true;
+}
+
+/**
+ * @brief  Get the number of payloads not counted because PAYLOAD_STATS_MAX_NODES nodes were
+ *         already tracked
+ * @param  None
+ * @return payloads since the last reset
+ */
+uint64_t PayloadStats_Untracked(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   return s_untracked;
+}
+
+/**
+ * @brief  Forget every node
+ * @param  None
+ * @return None
+ */
+void PayloadStats_Reset(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   memset(s_nodes, 0, sizeof(s_nodes));
+   memset(s_index, 0, sizeof(s_index));
+   s_nodeCount = 0;
+   s_untracked = 0;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Look up a node, s_lock must be held
+ * @param  nodeId - node to find
+ * @param  add - add the node if it is not there
+ * @return the node, NULL if it is not there and either add is false or the table is full
+ */
+static Node_t *FindNode(NodeId_t nodeId, bool add)
+{
+   uint32_t slot = ((uint32_t)nodeId * 2654435761u) & (INDEX_SIZE - 1u);
+
+   while (s_index[slot] != 0u)
+   {
+      Node_t *node = &s_nodes[s_index[slot] - 1u];
+      if (node->nodeId == nodeId)
+      {
+         return node;
+      }
+      slot = (slot + 1u) & (INDEX_SIZE - 1u);
+   }
+
+   if (!add || (s_nodeCount >= PAYLOAD_STATS_MAX_NODES))
+   {
+      return NULL;
+   }
+
+   Node_t *node = &s_nodes[s_nodeCount];
+   node->nodeId = nodeId;
+   s_index[slot] = (uint8_t)(++s_nodeCount);
+   return node;
+}
+
+/**
+ * @brief  Histogram bucket of a gap
+ * @param  gapUs - time between payloads
+ * @return bucket, 0 to GAP_BUCKETS - 1
+ */
+static uint32_t GapBucket(uint64_t gapUs)
+{
+   if (gapUs < GAP_LINEAR_MAX)
+   {
+      return (uint32_t)gapUs;
+   }
+
+   uint32_t topBit = GAP_LINEAR_BITS;
+   while ((topBit < GAP_TOP_BIT) && ((gapUs >> (topBit + 1u)) != 0u))
+   {
+      topBit++;
+   }
+   if ((gapUs >> (topBit + 1u)) != 0u)
+   {
+      return GAP_BUCKETS - 1u;
+   }
+
+   uint32_t sub = (uint32_t)(gapUs >> (topBit - GAP_SUB_BITS)) & (GAP_SUB_BUCKETS - 1u);
+   return GAP_LINEAR_MAX + ((topBit - GAP_LINEAR_BITS) * GAP_SUB_BUCKETS) + sub;
+}
+
+/**
+ * @brief  Value a gap bucket stands for
+ * @param  bucket - from GapBucket
+ * @return middle of the bucket in us
+ */
+static uint64_t GapBucketMid(uint32_t bucket)
+{
+   if (bucket < GAP_LINEAR_MAX)
+   {
+      return bucket;
+   }
+
+   uint32_t topBit = GAP_LINEAR_BITS + ((bucket - GAP_LINEAR_MAX) / GAP_SUB_BUCKETS);
+   uint64_t sub = (bucket - GAP_LINEAR_MAX) % GAP_SUB_BUCKETS;
+   uint64_t widthUs = 1ull << (topBit - GAP_SUB_BITS);
+   return ((GAP_SUB_BUCKETS + sub) * widthUs) + (widthUs / 2u);
+}
+
+/**
+ * @brief  Nearest-rank percentile of a histogram
+ * @param  hist - counts per bucket
+ * @param  buckets - entries in hist
+ * @param  samples - total of the counts
+ * @param  percent - 0 to 100
+ * @return bucket holding the percentile, 0 if there are no samples
+ */
+static uint32_t HistRank(const uint32_t *hist, uint32_t buckets, uint64_t samples, uint32_t percent)
+{
+   uint64_t rank = ((samples * percent) + 99u) / 100u;
+   uint64_t seen = 0;
+
+   for (uint32_t bucket = 0; bucket < buckets; bucket++)
+   {
+      seen += hist[bucket];
+      if ((seen >= rank) && (seen > 0u))
+      {
+         return bucket;
+      }
+   }
+   return 0;
+}
+
+/**
+ * @brief  Fill in the exported statistics of a node, s_lock must be held
+ * @param  node - node to report
+ * @param  nowUs - end of the rate window
+ * @param  stats - filled in
+ * @return None
+ */
+static void Snapshot(const Node_t *node, uint64_t nowUs, PayloadStats_t *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+   stats->nodeId = node->nodeId;
+   stats->packets = node->packets;
+   stats->bytes = node->bytes;
+   stats->firstUs = node->firstUs;
+   stats->lastUs = node->lastUs;
+
+   // the current slot is only part way through, so the window is the full slots before it plus
+   // the elapsed part of this one
+   uint64_t nowEpoch = nowUs / RATE_SLOT_US;
+   uint64_t windowUs = ((RATE_SLOTS - 1u) * RATE_SLOT_US) + (nowUs % RATE_SLOT_US);
+   uint64_t packets = 0;
+   uint64_t bytes = 0;
+   for (uint32_t i = 0; i < RATE_SLOTS; i++)
+   {
+      const RateSlot_t *slot = &node->rate[i];
+      if ((slot->epoch <= nowEpoch) && ((nowEpoch - slot->epoch) < RATE_SLOTS))
+      {
+         packets += slot->packets;
+         bytes += slot->bytes;
+      }
+   }
+   if (windowUs > 0u)
+   {
+      stats->packetsPerSec = (uint32_t)((packets * 1000000u) / windowUs);
+      stats->bytesPerSec = (uint32_t)((bytes * 1000000u) / windowUs);
+   }
+
+   if (node->gaps > 0u)
+   {
+      uint64_t p50Us = GapBucketMid(HistRank(node->gapHist, GAP_BUCKETS, node->gaps, 50u));
+      uint64_t p99Us = GapBucketMid(HistRank(node->gapHist, GAP_BUCKETS, node->gaps, 99u));
+      stats->gapMeanUs = node->gapTotalUs / node->gaps;
+      stats->gapP50Us = (p50Us < node->gapMaxUs) ? p50Us : node->gapMaxUs;
+      stats->gapP99Us = (p99Us < node->gapMaxUs) ? p99Us : node->gapMaxUs;
+      stats->gapMaxUs = node->gapMaxUs;
+      stats->jitterUs = (uint64_t)(node->jitterQ4 >> JITTER_SHIFT);
+   }
+
+   if (node->packets > 0u)
+   {
+      int32_t half = (node->rssiAvgQ4 < 0) ? -8 : 8;
+      stats->rssi = node->rssi;
+      stats->rssiAvg = (int8_t)((node->rssiAvgQ4 + half) / 16);
+      stats->rssiMin = node->rssiMin;
+      stats->rssiP10 = (int8_t)((int32_t)HistRank(node->rssiHist, RSSI_BUCKETS, node->packets, 10u) - 128);
+      stats->rssiP50 = (int8_t)((int32_t)HistRank(node->rssiHist, RSSI_BUCKETS, node->packets, 50u) - 128);
+      stats->rssiP90 = (int8_t)((int32_t)HistRank(node->rssiHist, RSSI_BUCKETS, node->packets, 90u) - 128);
+      stats->rssiMax = node->rssiMax;
+   }
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,91 @@
+/**
+ *  @File: payloadstats.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      payloadstats.h
+ *
+ *  @brief     Defines the per node received payload statistics API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "../../OML BLE App/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define PAYLOAD_STATS_MAX_NODES  64u     // source nodes tracked, payloads from more are counted as untracked
+#define PAYLOAD_STATS_WINDOW_MS  1000u   // span of the rate window
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+// Snapshot of the MCU_EVT_RX_PAYLOAD traffic from one source node. Bytes are application
+// payload bytes, not frame bytes. The gap is the time between consecutive payloads, its
+// percentiles come from a log bucketed histogram and are within 1/16 of the true value
+typedef struct
+{
+   NodeId_t nodeId;
+   uint64_t packets;
+   uint64_t bytes;
+   uint64_t firstUs;       // TIMER_NowUs of the first payload
+   uint64_t lastUs;        // TIMER_NowUs of the latest payload
+   uint32_t packetsPerSec; // over the last PAYLOAD_STATS_WINDOW_MS
+   uint32_t bytesPerSec;
+   uint64_t gapMeanUs;
+   uint64_t gapP50Us;
+   uint64_t gapP99Us;
+   uint64_t gapMaxUs;
+   uint64_t jitterUs;      // smoothed variation of the gap, as the RFC 3550 interarrival jitter
+   int8_t rssi;            // dBm of the latest payload
+   int8_t rssiAvg;         // moving average
+   int8_t rssiMin;
+   int8_t rssiP10;
+   int8_t rssiP50;
+   int8_t rssiP90;
+   int8_t rssiMax;
+} PayloadStats_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+void PayloadStats_OnRxPayload(NodeId_t nodeId, size_t len, int8_t rssi, uint64_t nowUs);
+size_t PayloadStats_GetNodes(PayloadStats_t *stats, size_t maxNodes);
+bool PayloadStats_Get(NodeId_t nodeId, PayloadStats_t *stats);
+uint64_t PayloadStats_Untracked(void);
+void PayloadStats_Reset(void);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -0,0 +1,123 @@
+#include "payloadstatsmodel.h"
+#include <algorithm>
+
+PayloadStatsModel::PayloadStatsModel(QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_snapshot(PAYLOAD_STATS_MAX_NODES)
+{
+}
+
+int PayloadStatsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_nodes.size();
+}
+
+int PayloadStatsModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant PayloadStatsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= m_nodes.size()))
+    {
+        return QVariant();
+    }
+
+    const PayloadStats_t &node = m_nodes.at(index.row());
+    if (role == Qt::DisplayRole)
+    {
+        // numbers rather than text so a sorting view orders them numerically, gaps in ms
+        bool gaps = (node.packets > 1u);
+        switch (index.column())
+        {
+        case ColumnNodeId: return static_cast<uint>(node.nodeId);
+        case ColumnPackets: return static_cast<qulonglong>(node.packets);
+        case ColumnBytes: return static_cast<qulonglong>(node.bytes);
+        case ColumnPacketsPerSec: return node.packetsPerSec;
+        case ColumnBytesPerSec: return node.bytesPerSec;
+        case ColumnGapMean: return gaps ? QVariant(node.gapMeanUs / 1000.0) : QVariant();
+        case ColumnGapP50: return gaps ? QVariant(node.gapP50Us / 1000.0) : QVariant();
+        case ColumnGapP99: return gaps ? QVariant(node.gapP99Us / 1000.0) : QVariant();
+        case ColumnGapMax: return gaps ? QVariant(node.gapMaxUs / 1000.0) : QVariant();
+        case ColumnJitter: return gaps ? QVariant(node.jitterUs / 1000.0) : QVariant();
+        case ColumnRssi: return node.rssi;
+        case ColumnRssiAvg: return node.rssiAvg;
+        case ColumnRssiP10: return node.rssiP10;
+        case ColumnRssiP50: return node.rssiP50;
+        case ColumnRssiP90: return node.rssiP90;
+        default: break;
+        }
+    }
+    else if ((role == Qt::ToolTipRole) && (index.column() >= ColumnRssi))
+    {
+        return QString("RSSI %1 to %2 dBm").arg(node.rssiMin).arg(node.rssiMax);
+    }
+    return QVariant();
+}
+
+QVariant PayloadStatsModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole))
+    {
+        return QVariant();
+    }
+
+    switch (section)
+    {
+    case ColumnNodeId: return QString("Node Id");
+    case ColumnPackets: return QString("Packets");
+    case ColumnBytes: return QString("Bytes");
+    case ColumnPacketsPerSec: return QString("Pkt/s");
+    case ColumnBytesPerSec: return QString("B/s");
+    case ColumnGapMean: return QString("Gap ms");
+    case ColumnGapP50: return QString("p50");
+    case ColumnGapP99: return QString("p99");
+    case ColumnGapMax: return QString("Max");
+    case ColumnJitter: return QString("Jitter ms");
+    case ColumnRssi: return QString("RSSI");
+    case ColumnRssiAvg: return QString("Avg");
+    case ColumnRssiP10: return QString("p10");
+    case ColumnRssiP50: return QString("p50");
+    case ColumnRssiP90: return QString("p90");
+    default: return QVariant();
+    }
+}
+
+// Nodes keep their place in the payloadstats table, so rows only ever get added
+// until it is reset
+void PayloadStatsModel::refresh()
+{
+    int count = static_cast<int>(PayloadStats_GetNodes(m_snapshot.data(), m_snapshot.size()));
+    if (count < m_nodes.size())
+    {
+        beginResetModel();
+        m_nodes = m_snapshot.mid(0, count);
+        endResetModel();
+        return;
+    }
+
+    int rows = m_nodes.size();
+    if (count > rows)
+    {
+        beginInsertRows(QModelIndex(), rows, count - 1);
+        m_nodes = m_snapshot.mid(0, count);
+        endInsertRows();
+    }
+    else
+    {
+        std::copy(m_snapshot.constBegin(), m_snapshot.constBegin() + count, m_nodes.begin());
+    }
+    if (rows > 0)
+    {
+        emit dataChanged(index(0, 0), index(rows - 1, ColumnCount - 1));
+    }
+}
+
+void PayloadStatsModel::clear()
+{
+    PayloadStats_Reset();
+    beginResetModel();
+    m_nodes.clear();
+    endResetModel();
+}
@@ -0,0 +1,52 @@
+#ifndef PAYLOADSTATSMODEL_H
+#define PAYLOADSTATSMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include "payloadstats.h"
+
+// Live view of the per node payload statistics. The counting is done on the rx
+// thread by the payloadstats module, refresh() takes a snapshot of it and tells
+// the view once, so the cost of the panel follows the refresh rate rather than
+// the payload rate.
+class PayloadStatsModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        ColumnNodeId = 0,
+        ColumnPackets,
+        ColumnBytes,
+        ColumnPacketsPerSec,
+        ColumnBytesPerSec,
+        ColumnGapMean,
+        ColumnGapP50,
+        ColumnGapP99,
+        ColumnGapMax,
+        ColumnJitter,
+        ColumnRssi,
+        ColumnRssiAvg,
+        ColumnRssiP10,
+        ColumnRssiP50,
+        ColumnRssiP90,
+        ColumnCount
+    };
+
+    explicit PayloadStatsModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void refresh();
+    void clear();
+
+private:
+    QVector<PayloadStats_t> m_nodes;
+    QVector<PayloadStats_t> m_snapshot;
+};
+
+#endif // PAYLOADSTATSMODEL_H
@@ -0,0 +1,296 @@
+/**
+ *  @File: pingbench.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      pingbench.cpp
+ *
+ *  @brief     Implements the ping round-trip latency benchmark API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "pingbench.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "cmdtracker.h"
+#include "timer.h"
+#include "utils.h"
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * External functions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module type definitions
+ **********************************************************************************************/
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static uint64_t Percentile(const std::vector<uint64_t> &sorted, uint32_t percent);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+// Pings are paced from the GUI, replies arrive on the rx decode thread
+static std::mutex s_lock;
+static bool s_running = false;
+static NodeId_t s_nodeId = 0;
+static uint32_t s_count = 0;
+static uint64_t s_intervalUs = 0;
+static uint64_t s_timeoutUs = 0;
+static uint64_t s_startUs = 0;
+static uint32_t s_sent = 0;
+static uint32_t s_lost = 0;
+static uint32_t s_late = 0;
+// A ping reply only names the node, so one ping is in flight at a time. After a ping is lost a
+// reply within the next timeout is taken as its late reply rather than charged to a new ping
+static bool s_inFlight = false;
+static uint64_t s_sentUs = 0;
+static uint64_t s_quietUntilUs = 0;
+static std::vector<uint64_t> s_rttUs;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Start pinging a node, discarding the results of any previous run
+ * @param  nodeId - node to ping
+ * @param  count - number of pings
+ * @param  intervalMs - time between pings, 0 sends the next as soon as the last is answered.
+ *         A ping that falls due while the last is unanswered waits for it
+ * @param  timeoutMs - time after which a ping counts as lost
+ * @return false if count is 0
+ */
+bool PingBench_Start(NodeId_t nodeId, uint32_t count, uint32_t intervalMs, uint32_t timeoutMs)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (count == 0u)
+   {
+      return false;
+   }
+
+   s_nodeId = nodeId;
+   s_count = count;
+   s_intervalUs = (uint64_t)intervalMs * 1000u;
+   s_timeoutUs = (uint64_t)((timeoutMs > 0u) ? timeoutMs : PING_BENCH_DEFAULT_TIMEOUT_MS) * 1000u;
+   s_startUs = TIMER_NowUs();
+   s_sent = 0;
+   s_lost = 0;
+   s_late = 0;
+   s_inFlight = false;
+   s_quietUntilUs = 0;
+   s_rttUs.clear();
+   s_rttUs.reserve(count);
+   s_running = true;
+
+   return true;
+}
+
+/**
+ * @brief  Stop sending, results so far are kept
+ * @param  None
+ * @return None
+ */
+void PingBench_Stop(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+   s_lost += s_inFlight ? 1u : 0u;
+   s_inFlight = false;
+   s_running = false;
+}
+
+/**
+ * @brief  Send any pings that are due and expire lost ones, call at least once per interval
+ * @param  None
+ * @return true while the benchmark is running
+ */
+bool PingBench_Poll(void)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (!s_running)
+   {
+      return false;
+   }
+
+   uint64_t nowUs = TIMER_NowUs();
+   if (s_inFlight && ((nowUs - s_sentUs) >= s_timeoutUs))
+   {
+      s_inFlight = false;
+      s_quietUntilUs = nowUs + s_timeoutUs;
+      s_lost++;
+   }
+
+   // pings are scheduled from the start time so a late poll does not stretch the interval
+   if (!s_inFlight && (nowUs >= s_quietUntilUs) && (s_sent < s_count) &&
+       ((s_intervalUs == 0u) || (nowUs >= (s_startUs + (s_sent * s_intervalUs)))))
+   {
+      MCU_CMD_REMOTE_MCU_PING_REQUEST_t cmd;
+      cmd.cmdId = MCU_CMD_REMOTE_MCU_PING_REQUEST;
+      cmd.nodeId[0] = GetArrayByteFromNodeId(0, s_nodeId);
+      cmd.nodeId[1] = GetArrayByteFromNodeId(1, s_nodeId);
+      cmd.nodeId[2] = GetArrayByteFromNodeId(2, s_nodeId);
+
+      // with too many commands outstanding nothing is sent, it is tried again next poll
+      uint64_t sentUs = TIMER_NowUs();
+      if (CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL) != 0u)
+      {
+         s_sentUs = sentUs;
+         s_inFlight = true;
+         s_sent++;
+      }
+   }
+
+   if ((s_sent == s_count) && !s_inFlight)
+   {
+      s_running = false;
+   }
+   return s_running;
+}
+
+/**
+ * @brief  Called on MCU_EVT_PING_REPLY, completes the ping in flight. A reply with no ping in
+ *         flight, or that arrived before the ping was sent, is a late reply to a lost ping
+ * @param  nodeId - node that replied
+ * @param  nowUs - TIMER_NowUs time the reply frame arrived
+ * @return None
+ */
+void PingBench_OnReply(NodeId_t nodeId, uint64_t nowUs)
+{
+   std::lock_guard<std::mutex> guard(s_lock);
+
+   if (!s_running || (nodeId != s_nodeId))
+   {
+      return;
+   }
+
+   if (s_inFlight && (nowUs >= s_sentUs))
+   {
+      s_rttUs.push_back(nowUs - s_sentUs);
+      s_inFlight = false;
+   }
+   else
+   {
+      s_late++;
+   }
+}
+
+/**
+ * @brief  Get the results so far
+ * @param  result - filled with the counters and round-trip statistics
+ * @return None
+ */
+void PingBench_GetResult(PingBenchResult_t *result)
+{
+   std::vector<uint64_t> sorted;
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      result->running = s_running;
+      result->sent = s_sent;
+      result->received = (uint32_t)s_rttUs.size();
+      result->lost = s_lost;
+      result->late = s_late;
+      result->outstanding = s_inFlight ? 1u : 0u;
+      sorted = s_rttUs;
+   }
+
+   std::sort(sorted.begin(), sorted.end());
+   uint64_t totalUs = 0;
+   for (uint64_t rttUs : sorted)
+   {
+      totalUs += rttUs;
+   }
+
+   result->minUs = sorted.empty() ? 0u : sorted.front();
+   result->maxUs = sorted.empty() ? 0u : sorted.back();
+   result->meanUs = sorted.empty() ? 0u : (totalUs / sorted.size());
+   result->p50Us = Percentile(sorted, 50u);
+   result->p99Us = Percentile(sorted, 99u);
+}
+
+/**
+ * @brief  Write the round-trip histogram as CSV, one row per bucket from 0 to the maximum
+ * @param  path - file to write
+ * @param  bucketUs - bucket width in microseconds
+ * @return false if the file could not be written
+ */
+bool PingBench_ExportHistogram(const char *path, uint32_t bucketUs)
+{
+   std::vector<uint32_t> hist;
+   uint64_t bucketWidthUs = (bucketUs > 0u) ? bucketUs : 1u;
+   {
+      std::lock_guard<std::mutex> guard(s_lock);
+      for (uint64_t rttUs : s_rttUs)
+      {
+         size_t bucket = (size_t)(rttUs / bucketWidthUs);
+         if (bucket >= hist.size())
+         {
+            hist.resize(bucket + 1u, 0u);
+         }
+         hist[bucket]++;
+      }
+   }
+
+   FILE *file = fopen(path, "w");
+   if (file == NULL)
+   {
+      return false;
+   }
+
+   fprintf(file, "rtt_us_from,rtt_us_to,count\n");
+   for (size_t bucket = 0; bucket < hist.size(); bucket++)
+   {
+      fprintf(file, "%llu,%llu,%u\n", (unsigned long long)(bucket * bucketWidthUs),
+              (unsigned long long)((bucket + 1u) * bucketWidthUs), hist[bucket]);
+   }
+
+   return (fclose(file) == 0);
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Nearest-rank percentile
+ * @param  sorted - samples in ascending order
+ * @param  percent - 0 to 100
+ * @return the sample at the percentile, 0 if there are none
+ */
+static uint64_t Percentile(const std::vector<uint64_t> &sorted, uint32_t percent)
+{
+   if (sorted.empty())
+   {
+      return 0;
+   }
+   size_t rank = ((sorted.size() * percent) + 99u) / 100u;
+   return sorted[(rank > 0u) ? (rank - 1u) : 0u];
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
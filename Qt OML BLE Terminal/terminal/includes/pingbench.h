@@ -0,0 +1,82 @@
+/**
+ *  @File: pingbench.h
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      pingbench.h
+ *
+ *  @brief     Defines the ping round-trip latency benchmark API
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+#pragma once
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "../../OML BLE App/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************************************
+ * Module exported defines
+ **********************************************************************************************/
+#define PING_BENCH_DEFAULT_COUNT       100u
+#define PING_BENCH_DEFAULT_INTERVAL_MS 100u
+#define PING_BENCH_DEFAULT_TIMEOUT_MS  2000u
+
+/**********************************************************************************************
+ * Module exported types
+ **********************************************************************************************/
+typedef struct
+{
+   bool running;
+   uint32_t sent;
+   uint32_t received;
+   uint32_t lost;        // no reply before the timeout
+   uint32_t late;        // replies that came after their ping was counted lost
+   uint32_t outstanding;
+   uint64_t minUs;
+   uint64_t meanUs;
+   uint64_t p50Us;
+   uint64_t p99Us;
+   uint64_t maxUs;
+} PingBenchResult_t;
+
+/**********************************************************************************************
+ * Module exported functions
+ **********************************************************************************************/
+bool PingBench_Start(NodeId_t nodeId, uint32_t count, uint32_t intervalMs, uint32_t timeoutMs);
+void PingBench_Stop(void);
+bool PingBench_Poll(void);
+void PingBench_OnReply(NodeId_t nodeId, uint64_t nowUs);
+void PingBench_GetResult(PingBenchResult_t *result);
+bool PingBench_ExportHistogram(const char *path, uint32_t bucketUs);
+
+/**********************************************************************************************
+ * Module exported variables
+ **********************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
@@ -1,87 +1,118 @@
-
 #include "serial.h"
-#include <QString>
-#include <QDebug>
-#include <QtSerialPort/QSerialPort>
-#include <QtSerialPort/QSerialPortInfo>
+#include "capture.h"
+#include "seriallink.h"
+#include "debug.h"
+#include <string.h>
+
+#define RX_RING_SIZE    65536u   // ~650 ms of traffic at 1 Mbaud
 
-QSerialPort s_Serial;
+// The primary dongle, the one commands are sent to and the capture records
+static SerialLink s_link(RX_RING_SIZE);
+static SerialBackend_e s_backend = eSERIAL_BACKEND_QT;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-bool SerialOpen(uint8_t nPort, int nBaud)
-{
-    QString portName = QString("COM%1").arg(nPort);
-    s_Serial.setPortName(portName);
-    s_Serial.setBaudRate(nBaud);
-    s_Serial.setDataBits(QSerialPort::Data8);
-    s_Serial.setParity(QSerialPort::NoParity);
-    s_Serial.setStopBits(QSerialPort::OneStop);
-    s_Serial.setFlowControl(QSerialPort::NoFlowControl);
-    //  return s_Serial.open(QIODevice::ReadWrite);
-
-    if (s_Serial.open(QIODevice::ReadWrite)) {
-        s_Serial.setRequestToSend(true);  // Set RTS
-        s_Serial.setDataTerminalReady(true);  // Set DTR
-        qDebug() << "Opened port:" << portName << "at baud rate:" << nBaud;
-        return true;
-    } else {
-        qDebug() << "Failed to open port:" << portName;
+bool SerialSetBackend(SerialBackend_e backend)
+{
+    if (s_link.isOpen() || !SerialBackendSupported(backend)) {
         return false;
     }
+    s_backend = backend;
+    return true;
+}
+
+SerialBackend_e SerialGetBackend(void)
+{
+    return s_backend;
+}
+
+bool SerialBackendSupported(SerialBackend_e backend)
+{
+    SerialLink probe(1u);  // the factories only need a sink to hand the transport
+    std::unique_ptr<SerialTransport> transport(CreateSerialTransport(backend, probe));
+    return transport != nullptr;
+}
+
+const char *SerialBackendName(SerialBackend_e backend)
+{
+    switch (backend) {
+    case eSERIAL_BACKEND_QT:
+        return "qt";
+    case eSERIAL_BACKEND_TERMIOS:
+        return "termios";
+    default:
+        return "?";
+    }
+}
+
+bool SerialOpen(const char *portName, int nBaud)
+{
+    return s_link.open(s_backend, QString(portName), nBaud, "serial");
 }
 
 void SerialClose(void)
 {
-    if (s_Serial.isOpen()) {
-           qDebug() << "Closing serial port.";
-           s_Serial.close();
-           qDebug() << "Serial port closed.";
-       }
-       else {
-           qDebug() << "Serial port was not open.";
-       }
+    s_link.close();
+}
+
+void SerialSetRxCallback(SerialRxCallback_t cb)
+{
+    s_link.setRxCallback((cb != nullptr) ? SerialLink::RxCallback(cb) : SerialLink::RxCallback());
+}
+
+void SerialGetRxStats(SerialRxStats_t *stats)
+{
+    s_link.getRxStats(stats);
 }
 
 bool SerialWriteByte(uint8_t u8Byte)
 {
-    if (s_Serial.isOpen()) {
-        return (s_Serial.write(reinterpret_cast<const char*>(&u8Byte), 1) == 1);
-    }
-    return false;
+    return SerialWriteBytes(&u8Byte, 1u);
 }
 
-void SerialWriteBytes(const void *p, size_t len)
+bool SerialWriteBytes(const void *p, size_t len)
 {
-    if (s_Serial.isOpen()) {
-        s_Serial.write(reinterpret_cast<const char*>(p), len);
+    bool written = false;
+    s_link.txLock();
+    if (s_link.isOpen()) {
+        Capture_Record(CAPTURE_DIR_TX, p, len);
+        written = s_link.write(p, len);
     }
+    s_link.txUnlock();
+    return written;
+}
+
+void SerialTxLock(void)
+{
+    s_link.txLock();
+}
+
+void SerialTxUnlock(void)
+{
+    s_link.txUnlock();
 }
 
 bool SerialWriteString(char *pszText)
 {
-    if (s_Serial.isOpen()) {
-        return (s_Serial.write(pszText, strlen(pszText)) == static_cast<qint64>(strlen(pszText)));
-    }
-    return false;
+    return SerialWriteBytes(pszText, strlen(pszText));
 }
 
 bool SerialRxPending(void)
 {
-    return s_Serial.bytesAvailable() > 0;
+    return s_link.rxRing().size() > 0u;
 }
 
 void SerialFifoRxPurge(void)
 {
-    if (s_Serial.isOpen()) {
-        qDebug() << "Clearing input buffer.";
-        s_Serial.clear(QSerialPort::Input);
+    if (s_link.isOpen()) {
+        LOG_INFO("Clearing input buffer.\n");
+        s_link.purgeInput();
     }
     else
     {
-        qDebug() << "Serial port is not open. Cannot clear input buffer.";
+        LOG_WARN("Serial port is not open. Cannot clear input buffer.\n");
     }
 }
 
@@ -93,42 +124,42 @@ void SerialWriteData(uint8_t u8Data)
 uint8_t SerialReadData(void)
 {
     uint8_t byte = 0;
-    if (s_Serial.isOpen() && s_Serial.bytesAvailable() > 0) {
-        s_Serial.read(reinterpret_cast<char*>(&byte), 1);
-    }
+    (void)s_link.rxRing().read(&byte, 1u);
     return byte;
 }
 
+size_t SerialReadBytes(void *p, size_t len)
+{
+    return s_link.rxRing().read(p, len);
+}
+
+size_t SerialRxPeek(const uint8_t **p)
+{
+    return s_link.rxRing().readSpan(p);
+}
+
+void SerialRxConsume(size_t len)
+{
+    s_link.rxRing().commitRead(len);
+}
+
 bool SerialSetRts(void)
 {
-    if (s_Serial.isOpen()) {
-        return s_Serial.setRequestToSend(true);
-    }
-    return false;
+    return s_link.setRts(true);
 }
 
 bool SerialClrRts(void)
 {
-    if (s_Serial.isOpen()) {
-        return s_Serial.setRequestToSend(false);
-    }
-    return false;
+    return s_link.setRts(false);
 }
 
 bool SerialAutoRts(void)
 {
-    // QSerialPort does not support auto RTS directly,
+    // neither backend supports auto RTS
     return false;
-
-
 }
 
-//QSerialPort& getSerialPort() {
-//    return s_Serial;
-//}
-
 
 #ifdef __cplusplus
 }
 #endif
-
@@ -5,27 +5,52 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#ifdef __cplusplus
-#include <QSerialPort>
-
-extern QSerialPort s_Serial;  // Extern declaration
-#endif
-
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// How the port is driven, chosen with SerialSetBackend before SerialOpen
+typedef enum
+{
+    eSERIAL_BACKEND_QT = 0,  // QSerialPort, every platform
+    eSERIAL_BACKEND_TERMIOS, // native tty with epoll and exact custom baud rates, Linux only
+    eSERIAL_BACKEND_COUNT
+} SerialBackend_e;
+
+// Called on the serial rx thread whenever new bytes are in the rx ring
+typedef void (*SerialRxCallback_t)(void);
 
+typedef struct
+{
+    uint64_t rxBytes;        // bytes moved from the port into the rx ring
+    uint64_t overflowBytes;  // bytes dropped because the rx ring was full
+    uint32_t overflows;      // reads that had to drop bytes
+    uint32_t ringCapacity;   // rx ring size in bytes
+    uint32_t ringHighWater;  // most bytes ever waiting in the rx ring
+} SerialRxStats_t;
 
-bool SerialOpen(uint8_t nPort, int nBaud);
+bool SerialSetBackend(SerialBackend_e backend);
+SerialBackend_e SerialGetBackend(void);
+bool SerialBackendSupported(SerialBackend_e backend);
+const char *SerialBackendName(SerialBackend_e backend);
+bool SerialOpen(const char *portName, int nBaud);
 void SerialClose(void);
 bool SerialWriteByte(uint8_t u8Byte);
-void SerialWriteBytes(const void *p, size_t len);
+bool SerialWriteBytes(const void *p, size_t len);
 bool SerialWriteString(char *pszText);
 bool SerialRxPending(void);
 void SerialFifoRxPurge(void);
 void SerialWriteData(uint8_t u8Data);
 uint8_t SerialReadData(void);
+size_t SerialReadBytes(void *p, size_t len);
+size_t SerialRxPeek(const uint8_t **p);
+void SerialRxConsume(size_t len);
+void SerialSetRxCallback(SerialRxCallback_t cb);
+void SerialGetRxStats(SerialRxStats_t *stats);
+// Held while a frame is built and written so frames from different threads never interleave,
+// recursive
+void SerialTxLock(void);
+void SerialTxUnlock(void);
 bool SerialSetRts(void);
 bool SerialClrRts(void);
 bool SerialAutoRts(void);
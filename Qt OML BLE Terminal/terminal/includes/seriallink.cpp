@@ -0,0 +1,177 @@
+#include "seriallink.h"
+#include "debug.h"
+#include <QThread>
+
+#define RX_WAIT_MS      50
+
+// Decode thread, drains the rx ring into the link's consumer
+class SerialLink::RxThread : public QThread
+{
+public:
+    explicit RxThread(SerialLink &link) : m_link(link) {}
+
+protected:
+    void run() override { m_link.runRx(this); }
+
+private:
+    SerialLink &m_link;
+};
+
+SerialTransport *CreateSerialTransport(SerialBackend_e backend, SerialRxSink &sink)
+{
+    switch (backend) {
+    case eSERIAL_BACKEND_QT:
+        return CreateQtSerialTransport(sink);
+    case eSERIAL_BACKEND_TERMIOS:
+        return CreateTermiosSerialTransport(sink);
+    default:
+        return nullptr;
+    }
+}
+
+SerialLink::SerialLink(size_t ringSize)
+    : m_rxRing(ringSize)
+    , m_rxPurge(false)
+    , m_isOpen(false)
+    , m_rxBytes(0)
+    , m_rxOverflows(0)
+    , m_rxOverflowBytes(0)
+    , m_rxThread(nullptr)
+{
+}
+
+SerialLink::~SerialLink()
+{
+    if (m_rxThread != nullptr) {
+        close();
+    }
+}
+
+bool SerialLink::open(SerialBackend_e backend, const QString &portName, int baud, const QString &name)
+{
+    if (m_isOpen) {
+        LOG_WARN("%s already open.\n", qPrintable(name));
+        return false;
+    }
+
+    m_transport.reset(CreateSerialTransport(backend, *this));
+    if (m_transport == nullptr) {
+        LOG_ERROR("Serial backend %s not available\n", SerialBackendName(backend));
+        return false;
+    }
+
+    if (!m_transport->open(portName, baud)) {
+        LOG_ERROR("Failed to open port: %s\n", qPrintable(portName));
+        m_transport.reset();
+        return false;
+    }
+
+    // bytes arriving before the thread runs wait in the ring
+    if (m_rxThread == nullptr) {
+        m_rxThread = new RxThread(*this);
+        m_rxThread->setObjectName(name + " rx");
+        m_rxThread->start(QThread::HighPriority);
+    }
+
+    m_isOpen = true;
+    LOG_INFO("Opened port: %s at baud rate: %d (%s)\n", qPrintable(portName), baud, SerialBackendName(backend));
+    return true;
+}
+
+void SerialLink::close()
+{
+    if (m_rxThread == nullptr) {
+        LOG_WARN("Serial port was not open.\n");
+        return;
+    }
+
+    LOG_INFO("Closing serial port.\n");
+    {
+        // no frame may be half written when the transport goes away
+        std::lock_guard<std::recursive_mutex> guard(m_txLock);
+        m_isOpen = false;
+    }
+    m_transport.reset();
+
+    m_rxThread->requestInterruption();
+    m_rxThread->wait();
+    delete m_rxThread;
+    m_rxThread = nullptr;
+
+    LOG_INFO("Serial port closed.\n");
+}
+
+bool SerialLink::write(const void *data, size_t len)
+{
+    std::lock_guard<std::recursive_mutex> guard(m_txLock);
+    if (!m_isOpen) {
+        return false;
+    }
+    m_transport->write(data, len);
+    return true;
+}
+
+void SerialLink::purgeInput()
+{
+    if (!m_isOpen) {
+        return;
+    }
+    m_transport->purgeInput();
+    // the ring belongs to the decode thread, ask it to drop what it holds
+    m_rxPurge = true;
+    m_rxSignal.release();
+}
+
+bool SerialLink::setRts(bool on)
+{
+    return m_isOpen && m_transport->setRts(on);
+}
+
+void SerialLink::getRxStats(SerialRxStats_t *stats) const
+{
+    stats->rxBytes = m_rxBytes;
+    stats->overflows = m_rxOverflows;
+    stats->overflowBytes = m_rxOverflowBytes;
+    stats->ringCapacity = static_cast<uint32_t>(m_rxRing.capacity());
+    stats->ringHighWater = static_cast<uint32_t>(m_rxRing.highWater());
+}
+
+size_t SerialLink::writeSpan(uint8_t **span)
+{
+    return m_rxRing.writeSpan(span);
+}
+
+void SerialLink::commitWrite(size_t len)
+{
+    m_rxRing.commitWrite(len);
+    m_rxBytes += static_cast<uint64_t>(len);
+}
+
+void SerialLink::overflow(size_t droppedBytes)
+{
+    m_rxOverflowBytes += static_cast<uint64_t>(droppedBytes);
+    m_rxOverflows++;
+}
+
+void SerialLink::wake()
+{
+    m_rxSignal.release();
+}
+
+void SerialLink::runRx(QThread *thread)
+{
+    while (!thread->isInterruptionRequested()) {
+        if (m_rxSignal.tryAcquire(1, RX_WAIT_MS)) {
+            // collapse any wake-ups queued behind this one, one drain covers them
+            m_rxSignal.tryAcquire(m_rxSignal.available());
+
+            if (m_rxPurge.exchange(false)) {
+                m_rxRing.discard();
+            }
+        }
+        // also runs when idle so the callback can service timeouts every RX_WAIT_MS
+        if (m_rxCallback) {
+            m_rxCallback();
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef SERIALLINK_H
+#define SERIALLINK_H
+
+#include "serial.h"
+#include "serialtransport.h"
+#include "spscring.h"
+#include <QSemaphore>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+class QThread;
+
+// One dongle: the transport, the rx ring it fills and the rx thread that drains the ring
+// into a consumer. Links share nothing, so each dongle is read and decoded on threads of
+// its own. serial.cpp drives the primary link behind the Serial C API, OMLLinks opens more.
+class SerialLink : public SerialRxSink
+{
+public:
+    typedef std::function<void()> RxCallback;
+
+    explicit SerialLink(size_t ringSize);
+    ~SerialLink() override;
+
+    // Called on the rx thread whenever new bytes are in the ring, and every RX_WAIT_MS when
+    // idle so it can service timeouts. Set before open()
+    void setRxCallback(const RxCallback &cb) { m_rxCallback = cb; }
+
+    bool open(SerialBackend_e backend, const QString &portName, int baud, const QString &name);
+    void close();
+    bool isOpen() const { return m_isOpen; }
+    bool isRunning() const { return m_rxThread != nullptr; }
+
+    // Held while a frame is built and written so frames from different threads never
+    // interleave, recursive
+    void txLock() { m_txLock.lock(); }
+    void txUnlock() { m_txLock.unlock(); }
+    bool write(const void *data, size_t len);
+
+    void purgeInput();
+    bool setRts(bool on);
+    SpscRing &rxRing() { return m_rxRing; }
+    void getRxStats(SerialRxStats_t *stats) const;
+
+    // SerialRxSink, called by the transport
+    size_t writeSpan(uint8_t **span) override;
+    void commitWrite(size_t len) override;
+    void overflow(size_t droppedBytes) override;
+    void wake() override;
+
+private:
+    class RxThread;
+
+    void runRx(QThread *thread);
+
+    SpscRing m_rxRing;
+    QSemaphore m_rxSignal;
+    std::atomic<bool> m_rxPurge;
+    std::atomic<bool> m_isOpen;
+    std::atomic<uint64_t> m_rxBytes;
+    std::atomic<uint32_t> m_rxOverflows;
+    std::atomic<uint64_t> m_rxOverflowBytes;
+    RxCallback m_rxCallback;
+    std::unique_ptr<SerialTransport> m_transport;
+    QThread *m_rxThread;
+    std::recursive_mutex m_txLock;
+};
+
+// Factory for the transport of a backend, nullptr when it is not available on this platform
+SerialTransport *CreateSerialTransport(SerialBackend_e backend, SerialRxSink &sink);
+
+#endif // SERIALLINK_H
@@ -0,0 +1,39 @@
+#ifndef SERIALTRANSPORT_H
+#define SERIALTRANSPORT_H
+
+#include <QString>
+#include <stddef.h>
+#include <stdint.h>
+
+// Where a transport puts received bytes. Implemented by serial.cpp over the rx ring that
+// the decode thread drains, so every backend feeds the same decoder.
+class SerialRxSink
+{
+public:
+    virtual ~SerialRxSink() {}
+
+    virtual size_t writeSpan(uint8_t **span) = 0;   // free space, 0 when the ring is full
+    virtual void commitWrite(size_t len) = 0;
+    virtual void overflow(size_t droppedBytes) = 0; // bytes read and discarded for want of space
+    virtual void wake() = 0;                        // new bytes are in the ring
+};
+
+// One open serial link. Received bytes go to the sink from the transport's own thread,
+// write() may be called from any thread but callers serialise it with SerialTxLock.
+class SerialTransport
+{
+public:
+    virtual ~SerialTransport() {}
+
+    virtual bool open(const QString &portName, int baud) = 0;
+    virtual void close() = 0;
+    virtual void write(const void *data, size_t len) = 0;
+    virtual void purgeInput() = 0;
+    virtual bool setRts(bool on) = 0;
+};
+
+// Factories, return nullptr when the backend is not available on this platform
+SerialTransport *CreateQtSerialTransport(SerialRxSink &sink);
+SerialTransport *CreateTermiosSerialTransport(SerialRxSink &sink);
+
+#endif // SERIALTRANSPORT_H
@@ -0,0 +1,163 @@
+#include "serialtransport.h"
+#include "debug.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QThread>
+#include <QtSerialPort/QSerialPort>
+#include <functional>
+
+// QSerialPort on a dedicated io thread. The port's readyRead runs there and moves
+// everything it has into the rx sink.
+class QtSerialTransport : public SerialTransport
+{
+public:
+    explicit QtSerialTransport(SerialRxSink &sink) : m_sink(sink), m_ioThread(nullptr), m_port(nullptr) {}
+    ~QtSerialTransport() override { close(); }
+
+    bool open(const QString &portName, int baud) override;
+    void close() override;
+    void write(const void *data, size_t len) override;
+    void purgeInput() override;
+    bool setRts(bool on) override;
+
+private:
+    void runOnIoThread(const std::function<void()> &fn);
+    void onReadyRead();
+
+    SerialRxSink &m_sink;
+    QThread *m_ioThread;
+    QSerialPort *m_port;
+};
+
+bool QtSerialTransport::open(const QString &portName, int baud)
+{
+    m_ioThread = new QThread();
+    m_ioThread->setObjectName("serial io");
+    m_ioThread->start(QThread::TimeCriticalPriority);
+
+    m_port = new QSerialPort();
+    m_port->moveToThread(m_ioThread);
+    QObject::connect(m_port, &QSerialPort::readyRead, m_port, [this]() { onReadyRead(); });
+
+    bool opened = false;
+    runOnIoThread([&]() {
+        m_port->setPortName(portName);
+        m_port->setBaudRate(baud);
+        m_port->setDataBits(QSerialPort::Data8);
+        m_port->setParity(QSerialPort::NoParity);
+        m_port->setStopBits(QSerialPort::OneStop);
+        m_port->setFlowControl(QSerialPort::NoFlowControl);
+
+        if (m_port->open(QIODevice::ReadWrite)) {
+            m_port->setRequestToSend(true);  // Set RTS
+            m_port->setDataTerminalReady(true);  // Set DTR
+            opened = true;
+        }
+    });
+
+    if (!opened) {
+        close();
+    }
+    return opened;
+}
+
+void QtSerialTransport::close()
+{
+    if (m_ioThread == nullptr) {
+        return;
+    }
+
+    runOnIoThread([this]() {
+        if (m_port->isOpen()) {
+            m_port->close();
+        }
+    });
+
+    // the port lives on the io thread, it is deleted there as the thread finishes
+    m_port->deleteLater();
+    m_port = nullptr;
+    m_ioThread->quit();
+    m_ioThread->wait();
+    delete m_ioThread;
+    m_ioThread = nullptr;
+}
+
+void QtSerialTransport::write(const void *data, size_t len)
+{
+    if (QThread::currentThread() == m_ioThread) {
+        m_port->write(reinterpret_cast<const char*>(data), static_cast<qint64>(len));
+    } else {
+        // queued calls from one thread run in order, so frames stay intact
+        QByteArray bytes(reinterpret_cast<const char*>(data), static_cast<int>(len));
+        QSerialPort *port = m_port;
+        QMetaObject::invokeMethod(m_port, [port, bytes]() {
+            port->write(bytes);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void QtSerialTransport::purgeInput()
+{
+    runOnIoThread([this]() {
+        m_port->clear(QSerialPort::Input);
+    });
+}
+
+bool QtSerialTransport::setRts(bool on)
+{
+    bool ret = false;
+    runOnIoThread([this, on, &ret]() {
+        ret = m_port->setRequestToSend(on);
+    });
+    return ret;
+}
+
+// Run fn on the thread that owns the port, waiting for it to finish
+void QtSerialTransport::runOnIoThread(const std::function<void()> &fn)
+{
+    if (QThread::currentThread() == m_ioThread) {
+        fn();
+    } else {
+        QMetaObject::invokeMethod(m_port, fn, Qt::BlockingQueuedConnection);
+    }
+}
+
+// Called on the io thread, moves everything the port has into the rx sink
+void QtSerialTransport::onReadyRead()
+{
+    size_t dropped = 0;
+
+    while (m_port->bytesAvailable() > 0) {
+        uint8_t *span;
+        size_t spanLen = m_sink.writeSpan(&span);
+
+        if (spanLen == 0u) {
+            // ring full, the decoder has fallen behind. Drop rather than let the
+            // port buffer grow without bound, and count it.
+            char scratch[512];
+            qint64 n = m_port->read(scratch, sizeof(scratch));
+            if (n <= 0) {
+                break;
+            }
+            dropped += static_cast<size_t>(n);
+            continue;
+        }
+
+        qint64 n = m_port->read(reinterpret_cast<char*>(span), static_cast<qint64>(spanLen));
+        if (n <= 0) {
+            break;
+        }
+        m_sink.commitWrite(static_cast<size_t>(n));
+    }
+
+    if (dropped > 0u) {
+        m_sink.overflow(dropped);
+    }
+    m_sink.wake();
+}
+
+SerialTransport *CreateQtSerialTransport(SerialRxSink &sink)
+{
+    return new QtSerialTransport(sink);
+}
@@ -0,0 +1,258 @@
+#include "serialtransport.h"
+
+#ifdef __linux__
+
+#include "debug.h"
+#include <QThread>
+#include <asm/termbits.h> // termios2, instead of <termios.h> which cannot set arbitrary rates
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#define WRITE_WAIT_MS 100  // longest a write waits for the tty to drain before giving up
+
+// Native Linux tty: non-blocking fd, reader thread blocked in epoll_wait that reads straight
+// into the rx ring, writes go to the fd from the calling thread. Rates such as 1 Mbaud are
+// set exactly with termios2/BOTHER rather than the nearest Bxxx constant.
+class TermiosSerialTransport : public SerialTransport
+{
+public:
+    explicit TermiosSerialTransport(SerialRxSink &sink) : m_sink(sink), m_fd(-1), m_stopFd(-1), m_reader(this) {}
+    ~TermiosSerialTransport() override { close(); }
+
+    bool open(const QString &portName, int baud) override;
+    void close() override;
+    void write(const void *data, size_t len) override;
+    void purgeInput() override;
+    bool setRts(bool on) override;
+
+private:
+    class Reader : public QThread
+    {
+    public:
+        explicit Reader(TermiosSerialTransport *owner) : m_owner(owner) {}
+    protected:
+        void run() override { m_owner->readLoop(); }
+    private:
+        TermiosSerialTransport *m_owner;
+    };
+
+    bool configure(int baud);
+    void readLoop();
+    bool drain();
+
+    SerialRxSink &m_sink;
+    int m_fd;
+    int m_stopFd;
+    Reader m_reader;
+};
+
+bool TermiosSerialTransport::open(const QString &portName, int baud)
+{
+    m_fd = ::open(portName.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        LOG_ERROR("open %s: %s\n", qPrintable(portName), strerror(errno));
+        return false;
+    }
+
+    if (!configure(baud)) {
+        close();
+        return false;
+    }
+
+    m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_stopFd < 0) {
+        LOG_ERROR("eventfd: %s\n", strerror(errno));
+        close();
+        return false;
+    }
+
+    m_reader.setObjectName("serial io");
+    m_reader.start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+void TermiosSerialTransport::close()
+{
+    if (m_reader.isRunning()) {
+        uint64_t one = 1u;
+        (void)::write(m_stopFd, &one, sizeof(one));
+        m_reader.wait();
+    }
+    if (m_stopFd >= 0) {
+        ::close(m_stopFd);
+        m_stopFd = -1;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void TermiosSerialTransport::write(const void *data, size_t len)
+{
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+
+    while (len > 0u) {
+        ssize_t n = ::write(m_fd, p, len);
+        if (n > 0) {
+            p += n;
+            len -= static_cast<size_t>(n);
+        } else if ((n < 0) && (errno == EAGAIN)) {
+            // tty output buffer full, wait for it to drain
+            struct pollfd pfd = { m_fd, POLLOUT, 0 };
+            if (poll(&pfd, 1, WRITE_WAIT_MS) <= 0) {
+                LOG_ERROR("serial write stalled, %u bytes dropped\n", static_cast<unsigned>(len));
+                return;
+            }
+        } else if ((n < 0) && (errno == EINTR)) {
+            continue;
+        } else {
+            LOG_ERROR("serial write: %s\n", strerror(errno));
+            return;
+        }
+    }
+}
+
+void TermiosSerialTransport::purgeInput()
+{
+    (void)ioctl(m_fd, TCFLSH, TCIFLUSH);
+}
+
+bool TermiosSerialTransport::setRts(bool on)
+{
+    int bits = TIOCM_RTS;
+    return ioctl(m_fd, on ? TIOCMBIS : TIOCMBIC, &bits) == 0;
+}
+
+// 8N1 raw at an exact rate, the equivalent of cfmakeraw plus cfsetspeed for any baud
+bool TermiosSerialTransport::configure(int baud)
+{
+    struct termios2 tio;
+    if (ioctl(m_fd, TCGETS2, &tio) != 0) {
+        LOG_ERROR("TCGETS2: %s\n", strerror(errno));
+        return false;
+    }
+
+    tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON | IXOFF | IXANY);
+    tio.c_oflag &= ~OPOST;
+    tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS | CBAUD | (CBAUD << IBSHIFT));
+    tio.c_cflag |= CS8 | CREAD | CLOCAL | BOTHER | (BOTHER << IBSHIFT);
+    tio.c_ispeed = static_cast<speed_t>(baud);
+    tio.c_ospeed = static_cast<speed_t>(baud);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    if (ioctl(m_fd, TCSETS2, &tio) != 0) {
+        LOG_ERROR("TCSETS2 %d baud: %s\n", baud, strerror(errno));
+        return false;
+    }
+
+    // assert RTS and DTR as the Qt backend does, a pty has no modem lines so ignore failure
+    int bits = TIOCM_RTS | TIOCM_DTR;
+    (void)ioctl(m_fd, TIOCMBIS, &bits);
+    return true;
+}
+
+// Reader thread, sleeps in epoll_wait until the tty has data or close() signals m_stopFd
+void TermiosSerialTransport::readLoop()
+{
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        LOG_ERROR("epoll_create1: %s\n", strerror(errno));
+        return;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_fd;
+    (void)epoll_ctl(epollFd, EPOLL_CTL_ADD, m_fd, &ev);
+    ev.data.fd = m_stopFd;
+    (void)epoll_ctl(epollFd, EPOLL_CTL_ADD, m_stopFd, &ev);
+
+    bool running = true;
+    while (running) {
+        struct epoll_event events[2];
+        int count = epoll_wait(epollFd, events, 2, -1);
+        if ((count < 0) && (errno != EINTR)) {
+            LOG_ERROR("epoll_wait: %s\n", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.fd == m_stopFd) {
+                running = false;
+            } else if (!drain() || (events[i].events & (EPOLLHUP | EPOLLERR))) {
+                // device unplugged or pty peer gone, stop polling it until closed
+                LOG_WARN("serial port hung up\n");
+                (void)epoll_ctl(epollFd, EPOLL_CTL_DEL, m_fd, nullptr);
+            }
+        }
+    }
+
+    ::close(epollFd);
+}
+
+// Read until the tty is empty, straight into the ring. Returns false on a read error
+bool TermiosSerialTransport::drain()
+{
+    size_t dropped = 0;
+    bool ok = true;
+
+    for (;;) {
+        uint8_t *span;
+        uint8_t scratch[512];
+        size_t spanLen = m_sink.writeSpan(&span);
+        bool full = (spanLen == 0u);
+        if (full) {
+            // ring full, the decoder has fallen behind. Drop and count it
+            span = scratch;
+            spanLen = sizeof(scratch);
+        }
+
+        ssize_t n = ::read(m_fd, span, spanLen);
+        if (n > 0) {
+            if (full) {
+                dropped += static_cast<size_t>(n);
+            } else {
+                // wake per chunk so the decoder drains while a long burst is still arriving
+                m_sink.commitWrite(static_cast<size_t>(n));
+                m_sink.wake();
+            }
+            continue;
+        }
+        if ((n < 0) && (errno == EINTR)) {
+            continue;
+        }
+        // VMIN = VTIME = 0 makes an empty tty read 0 rather than fail with EAGAIN
+        ok = (n == 0) || (errno == EAGAIN);
+        break;
+    }
+
+    if (dropped > 0u) {
+        m_sink.overflow(dropped);
+    }
+    return ok;
+}
+
+SerialTransport *CreateTermiosSerialTransport(SerialRxSink &sink)
+{
+    return new TermiosSerialTransport(sink);
+}
+
+#else
+
+SerialTransport *CreateTermiosSerialTransport(SerialRxSink &sink)
+{
+    (void)sink;
+    return nullptr;
+}
+
+#endif
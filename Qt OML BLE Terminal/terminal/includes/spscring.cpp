@@ -0,0 +1,101 @@
+#include "spscring.h"
+#include <string.h>
+
+SpscRing::SpscRing(size_t capacityPow2)
+    : m_buf(capacityPow2)
+    , m_mask(capacityPow2 - 1u)
+    , m_head(0)
+    , m_tail(0)
+    , m_highWater(0)
+{
+}
+
+size_t SpscRing::writeSpan(uint8_t **span)
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    size_t free = m_buf.size() - (head - tail);
+    size_t toEnd = m_buf.size() - (head & m_mask);
+
+    *span = &m_buf[head & m_mask];
+    return (free < toEnd) ? free : toEnd;
+}
+
+void SpscRing::commitWrite(size_t len)
+{
+    size_t head = m_head.load(std::memory_order_relaxed) + len;
+    m_head.store(head, std::memory_order_release);
+
+    size_t used = head - m_tail.load(std::memory_order_acquire);
+    if (used > m_highWater.load(std::memory_order_relaxed))
+    {
+        m_highWater.store(used, std::memory_order_relaxed);
+    }
+}
+
+size_t SpscRing::write(const void *data, size_t len)
+{
+    const uint8_t *src = static_cast<const uint8_t*>(data);
+    size_t written = 0;
+
+    // at most two spans, before and after the wrap
+    for (int pass = 0; (pass < 2) && (written < len); pass++)
+    {
+        uint8_t *span;
+        size_t spanLen = writeSpan(&span);
+        if (spanLen > (len - written))
+        {
+            spanLen = len - written;
+        }
+        memcpy(span, src + written, spanLen);
+        commitWrite(spanLen);
+        written += spanLen;
+    }
+    return written;
+}
+
+size_t SpscRing::readSpan(const uint8_t **span)
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    size_t head = m_head.load(std::memory_order_acquire);
+    size_t used = head - tail;
+    size_t toEnd = m_buf.size() - (tail & m_mask);
+
+    *span = &m_buf[tail & m_mask];
+    return (used < toEnd) ? used : toEnd;
+}
+
+void SpscRing::commitRead(size_t len)
+{
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+}
+
+size_t SpscRing::read(void *data, size_t len)
+{
+    uint8_t *dst = static_cast<uint8_t*>(data);
+    size_t done = 0;
+
+    for (int pass = 0; (pass < 2) && (done < len); pass++)
+    {
+        const uint8_t *span;
+        size_t spanLen = readSpan(&span);
+        if (spanLen > (len - done))
+        {
+            spanLen = len - done;
+        }
+        memcpy(dst + done, span, spanLen);
+        commitRead(spanLen);
+        done += spanLen;
+    }
+    return done;
+}
+
+void SpscRing::discard()
+{
+    m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+size_t SpscRing::size() const
+{
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+}
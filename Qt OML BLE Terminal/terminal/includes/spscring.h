@@ -0,0 +1,44 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Fixed-capacity single-producer/single-consumer byte ring. The producer only
+// moves m_head and the consumer only moves m_tail, so no lock is needed as long
+// as each side stays on its own thread.
+class SpscRing
+{
+public:
+    explicit SpscRing(size_t capacityPow2);
+
+    // Producer side
+    size_t writeSpan(uint8_t **span);
+    void commitWrite(size_t len);
+    size_t write(const void *data, size_t len);
+
+    // Consumer side
+    size_t readSpan(const uint8_t **span);
+    void commitRead(size_t len);
+    size_t read(void *data, size_t len);
+    void discard();
+
+    size_t size() const;
+    size_t capacity() const { return m_buf.size(); }
+    size_t highWater() const { return m_highWater.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<uint8_t> m_buf;
+    size_t m_mask;
+    // padded rather than alignas(64) so rings inside heap objects keep head and tail on
+    // separate cache lines without C++17 aligned new
+    char m_padHead[64];
+    std::atomic<size_t> m_head;
+    char m_padTail[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> m_tail;
+    std::atomic<size_t> m_highWater;
+};
+
+#endif // SPSCRING_H
@@ -1,4 +1,5 @@
 #include "terminalcommands.h"
+#include "debug.h"
 
 TerminalCommands::TerminalCommands()
 {
@@ -9,21 +10,21 @@ void TerminalCommands::nop()
 {
     MCU_CMD_NOP_t cmd;
     cmd.cmdId = MCU_CMD_NOP;
-    BLEModule_Tx(&cmd, sizeof(cmd));
+    (void)CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL);
 }
 
 void TerminalCommands::onmcureset()
 {
     MCU_CMD_ON_MCU_RESET_t cmd;
     cmd.cmdId = MCU_CMD_ON_MCU_RESET;
-    BLEModule_Tx(&cmd, sizeof(cmd));
+    (void)CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL);
 }
 
 void TerminalCommands::getnodeid()
 {
     MCU_CMD_GET_NODE_ID_t cmd;
     cmd.cmdId = MCU_CMD_GET_NODE_ID;
-    BLEModule_Tx(&cmd, sizeof(cmd));
+    (void)CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL);
 }
 
 
@@ -31,7 +32,7 @@ void TerminalCommands::fwver()
 {
     MCU_CMD_GET_FW_VERSION_t cmd;
     cmd.cmdId = MCU_CMD_GET_FW_VERSION;
-    BLEModule_Tx(&cmd, sizeof(cmd));
+    (void)CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL);
 }
 
 void TerminalCommands::connectble(TerminalArg_t *args)
@@ -43,7 +44,7 @@ void TerminalCommands::connectble(TerminalArg_t *args)
     cmd.nodeId[0] = GetArrayByteFromNodeId(0, nodeId);
     cmd.nodeId[1] = GetArrayByteFromNodeId(1, nodeId);
     cmd.nodeId[2] = GetArrayByteFromNodeId(2, nodeId);
-    BLEModule_Tx(&cmd, sizeof(cmd));
+    (void)CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL);
 }
 
 void TerminalCommands::disconnectble(TerminalArg_t *args)
@@ -54,44 +55,53 @@ void TerminalCommands::disconnectble(TerminalArg_t *args)
     cmd.nodeId[0] = GetArrayByteFromNodeId(0, nodeId);
     cmd.nodeId[1] = GetArrayByteFromNodeId(1, nodeId);
     cmd.nodeId[2] = GetArrayByteFromNodeId(2, nodeId);
-    BLEModule_Tx(&cmd, sizeof(cmd));
+    (void)CmdTracker_Send(&cmd, sizeof(cmd), 0, NULL, NULL);
 }
 
-void TerminalCommands::txpayload(TerminalArg_t *args)
+// encode straight into a tx pool frame, no intermediate buffer
+static void TxPayload(TerminalArg_t *args, uint8_t ack)
 {
-    uint8_t txBuffer[260];
-    MCU_CMD_TX_PAYLOAD_t *cmd = (MCU_CMD_TX_PAYLOAD_t *)txBuffer;
+    MCU_CMD_TX_PAYLOAD_t *cmd = (MCU_CMD_TX_PAYLOAD_t *)BLEModule_TxAlloc();
+    if (cmd == NULL)
+    {
+        return;
+    }
 
     cmd->cmdId = MCU_CMD_TX_PAYLOAD;
     NodeId_t nodeId = (NodeId_t)args[0].l;
     cmd->destNodeId[0] = GetArrayByteFromNodeId(0, nodeId);
     cmd->destNodeId[1] = GetArrayByteFromNodeId(1, nodeId);
     cmd->destNodeId[2] = GetArrayByteFromNodeId(2, nodeId);
-    cmd->ack = 0;
+    cmd->ack = ack;
 
     size_t payloadLen = strlen(args[1].s);
+    if (payloadLen > (MCU_PROTOCOL_PAYLOAD_MAX - 6u))
+    {
+        payloadLen = MCU_PROTOCOL_PAYLOAD_MAX - 6u;
+    }
     cmd->payloadLen = (uint8_t)payloadLen;
     (void)memcpy(&cmd->payloadLen + 1u, args[1].s, payloadLen);
 
-    BLEModule_Tx(cmd, 6u + payloadLen);
+    // tracked before it goes on the wire so a fast response cannot arrive untracked
+    uint32_t tag = CmdTracker_Track(MCU_CMD_TX_PAYLOAD, 0, NULL, NULL);
+    if (tag == 0u)
+    {
+        (void)BLEModule_TxCommit(cmd, 0u);
+        LOG_WARN("txpayload not sent, too many commands outstanding\n");
+        return;
+    }
+    if (!BLEModule_TxCommit(cmd, 6u + payloadLen))
+    {
+        CmdTracker_Untrack(tag);
+    }
 }
 
-void TerminalCommands::txpayloadack(TerminalArg_t *args)
+void TerminalCommands::txpayload(TerminalArg_t *args)
 {
-    uint8_t txBuffer[260];
-    MCU_CMD_TX_PAYLOAD_t *cmd = (MCU_CMD_TX_PAYLOAD_t *)txBuffer;
-
-    cmd->cmdId = MCU_CMD_TX_PAYLOAD;
-    NodeId_t nodeId = (NodeId_t)args[0].l;
-    cmd->destNodeId[0] = GetArrayByteFromNodeId(0, nodeId);
-    cmd->destNodeId[1] = GetArrayByteFromNodeId(1, nodeId);
-    cmd->destNodeId[2] = GetArrayByteFromNodeId(2, nodeId);
-    cmd->ack = 1u;
-
-    size_t payloadLen = strlen(args[1].s);
-    cmd->payloadLen = (uint8_t)payloadLen;
-    (void)memcpy(&cmd->payloadLen + 1u, args[1].s, payloadLen);
-
-    BLEModule_Tx(cmd, 6u + payloadLen);
+    TxPayload(args, 0);
 }
 
+void TerminalCommands::txpayloadack(TerminalArg_t *args)
+{
+    TxPayload(args, 1u);
+}
@@ -2,12 +2,13 @@
 #define TERMINALCOMMANDS_H
 
 #include <QObject>
-#include "includes/ble_module.h"
-#include "includes/oml_interface.h"
-#include "includes/serial.h"
-#include "..\..\OML BLE App\mcu_cmds.h"
-#include "..\..\OML BLE App\types.h"
-#include "..\..\OML BLE App\utils.h"
+#include "ble_module.h"
+#include "cmdtracker.h"
+#include "oml_interface.h"
+#include "serial.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include "../../OML BLE App/types.h"
+#include "../../OML BLE App/utils.h"
 
 typedef union {
    const char *s;// Arguments can be string, uint16_t or uint32_t
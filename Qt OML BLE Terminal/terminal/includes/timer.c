@@ -24,13 +24,20 @@
 /**********************************************************************************************
  * Module includes
  **********************************************************************************************/
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // clock_gettime, nanosleep
+#endif
 #include "timer.h"
-#include "Windows.h"
-#include <sys/timeb.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 /**********************************************************************************************
  * Module constant defines
  **********************************************************************************************/
+#define NS_PER_SEC 1000000000ull
 
 /**********************************************************************************************
  * External functions
@@ -43,20 +50,27 @@
 /**********************************************************************************************
  * Module static variables
  **********************************************************************************************/
-static uint64_t s_startMs = 0;
+static uint64_t s_startNs = 0;
 
 /**********************************************************************************************
  * Module static function prototypes
  **********************************************************************************************/
+static uint64_t MonotonicNs(void);
 
 /**********************************************************************************************
  * Module externally exported functions
  **********************************************************************************************/
 
+/**
+ * @brief  Make now time zero for all the TIMER_Now functions
+ * @param  None
+ * @return None
+ */
 void TIMER_Init(void)
 {
-   s_startMs = TIMER_NowMs();
+   s_startNs = MonotonicNs();
 }
+
 /**
  * @brief  Get the time in ms now
  * @param  None
@@ -64,11 +78,28 @@ void TIMER_Init(void)
  */
 uint64_t TIMER_NowMs(void)
 {
-   struct _timeb timebuffer;
-   _ftime(&timebuffer);
+   return TIMER_NowNs() / 1000000u;
+}
+
+/**
+ * @brief  Get the time in us now
+ * @param  None
+ * @return the time in us now
+ */
+uint64_t TIMER_NowUs(void)
+{
+   return TIMER_NowNs() / 1000u;
+}
 
-   uint64_t nowMs = (uint64_t)(((timebuffer.time * 1000u) + timebuffer.millitm));
-   return (nowMs - s_startMs);
+/**
+ * @brief  Get the time in ns now from a monotonic clock that never jumps with the wall clock.
+ *         Resolution is that of the platform counter, typically well under 1 us
+ * @param  None
+ * @return the time in ns now
+ */
+uint64_t TIMER_NowNs(void)
+{
+   return MonotonicNs() - s_startNs;
 }
 
 /**
@@ -78,13 +109,51 @@ uint64_t TIMER_NowMs(void)
  */
 void TIMER_DelayMs(uint32_t ms)
 {
+#ifdef _WIN32
    Sleep(ms);
+#else
+   struct timespec delay;
+   delay.tv_sec = (time_t)(ms / 1000u);
+   delay.tv_nsec = (long)((ms % 1000u) * 1000000u);
+   while (nanosleep(&delay, &delay) != 0)
+   {
+      // interrupted by a signal, sleep for the remainder
+   }
+#endif
 }
 
 /**********************************************************************************************
  * Module static functions
  **********************************************************************************************/
 
+/**
+ * @brief  Read the platform monotonic counter
+ * @param  None
+ * @return ns since an arbitrary fixed point
+ */
+static uint64_t MonotonicNs(void)
+{
+#ifdef _WIN32
+   static LARGE_INTEGER s_frequency = {0};
+   LARGE_INTEGER count;
+
+   if (0 == s_frequency.QuadPart)
+   {
+      (void)QueryPerformanceFrequency(&s_frequency);
+   }
+   (void)QueryPerformanceCounter(&count);
+
+   // split so count * NS_PER_SEC cannot overflow
+   uint64_t ticks = (uint64_t)count.QuadPart;
+   uint64_t frequency = (uint64_t)s_frequency.QuadPart;
+   return ((ticks / frequency) * NS_PER_SEC) + (((ticks % frequency) * NS_PER_SEC) / frequency);
+#else
+   struct timespec now;
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return ((uint64_t)now.tv_sec * NS_PER_SEC) + (uint64_t)now.tv_nsec;
+#endif
+}
+
 /**********************************************************************************************
  * End of file
  **********************************************************************************************/
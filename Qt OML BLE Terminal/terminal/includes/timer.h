@@ -26,7 +26,7 @@
 /**********************************************************************************************
  * Module includes
  **********************************************************************************************/
-#include "..\..\OML BLE App\types.h"
+#include "../../OML BLE App/types.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -51,6 +51,8 @@ extern "C" {
  **********************************************************************************************/
 void TIMER_Init(void);
 uint64_t TIMER_NowMs(void);
+uint64_t TIMER_NowUs(void);
+uint64_t TIMER_NowNs(void);
 void TIMER_DelayMs(uint32_t ms);
 
 /**********************************************************************************************
@@ -26,11 +26,15 @@
 /**********************************************************************************************
  * Module includes
  **********************************************************************************************/
-#include "..\..\OML BLE App\types.h"
+#include "../../OML BLE App/types.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**********************************************************************************************
  * Module exported defines
  **********************************************************************************************/
@@ -7,40 +7,93 @@
 #include <QSplashScreen>
 #include <QProgressBar>
 #include <QMessageBox>
+#include "includes/ackbench.h"
 #include "includes/ble_module.h"
+#include "includes/capture.h"
+#include "includes/cmdqueue.h"
+#include "includes/cmdtracker.h"
+#include "includes/payloadstats.h"
+#include "includes/pingbench.h"
 #include "includes/oml_interface.h"
+#include "includes/omllinks.h"
 #include "includes/serial.h"
 #include "includes/timer.h"
-#include "..\..\OML BLE App\mcu_cmds.h"
+#include "../../OML BLE App/mcu_cmds.h"
 #include <stdio.h>
 #include <string.h>
-#include <windows.h>
 #include <QKeyEvent>
 #include "includes/debugsignals.h"
+#include "includes/debug_signals_wrapper.h"
+#include "includes/debug.h"
+#include "includes/benchmark.h"
+#include <QFileDialog>
+#include <QFile>
+#include <QDateTime>
+#include <QDir>
+#include <QAction>
+#include <QApplication>
+#include <QClipboard>
+#include <QDockWidget>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QSortFilterProxyModel>
+#include <QTableView>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 
 #define MCU_BAUD_RATE 1000000u
+#define LOG_CAPACITY  50000     // rows kept in the log view, see logsize
+#define LOG_FLUSH_MS  25        // log view update period
+#define LOG_SPILL_MB  64        // default spill file size
+#define LOG_SPILL_FILES 8       // default spill files kept
+#define LOG_FIND_MAX  200       // hits shown by find
+#define PAYLOAD_STATS_REFRESH_MS 500  // payloads dock update period
 
 
-extern QSerialPort s_Serial;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , commands()
 {
+    // one time base for the whole session, the capture, log spill, payload stats and extra
+    // links all outlive a disconnect and reconnect
+    TIMER_Init();
     ui->setupUi(this);
     setWindowTitle("OML BLE Terminal Application");
-    ui->textEdit->setReadOnly(false);
+    // the log is a virtualized list over a bounded ring, new rows are shown in one
+    // batch per LOG_FLUSH_MS rather than as they arrive
+    m_log = new LogModel(LOG_CAPACITY, this);
+    ui->logView->setModel(m_log);
+    ui->logView->setUniformItemSizes(true);
+    ui->logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    ui->logView->setContextMenuPolicy(Qt::ActionsContextMenu);
+    QAction *copyAction = new QAction("Copy", ui->logView);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setShortcutContext(Qt::WidgetShortcut);
+    connect(copyAction, &QAction::triggered, this, &MainWindow::copyLogSelection);
+    ui->logView->addAction(copyAction);
+    // every record is logged, link view only filters what is shown. The proxy is only
+    // attached while filtering so the unfiltered log costs nothing extra in a storm
+    m_logLinks = new QSortFilterProxyModel(this);
+    m_logLinks->setFilterRole(LogModel::LinkRole);
+    m_logFlushTimer = new QTimer(this);
+    m_logFlushTimer->setSingleShot(true);
+    m_logFlushTimer->setInterval(LOG_FLUSH_MS);
+    connect(m_logFlushTimer, &QTimer::timeout, this, &MainWindow::flushLog);
     ui->lineEdit->setPlaceholderText("Enter text to transmit");
     ui->lineEdit_2->setPlaceholderText("Enter Node ID to connect");
     ui->pushButton_2->setText("Connect");
+    // any port can be typed in, e.g. the pty of a simulated dongle
+    ui->comboBox->setEditable(true);
+    ui->comboBox->setInsertPolicy(QComboBox::NoInsert);
 
     m_checkComPortsTimer = new QTimer(this);
     connect(m_checkComPortsTimer, &QTimer::timeout, this, &MainWindow::checkComPorts);
     m_checkComPortsTimer->start(1000);  // Check every 1 sec
 
-    connect(&s_Serial, &QSerialPort::readyRead, this, &MainWindow::handleReadyRead);
     //connect(ui->pushButton, &QPushButton::clicked, this, &MainWindow::on_sendCommandButton);
     ui->lineEdit->installEventFilter(this);
 
@@ -50,6 +103,57 @@ MainWindow::MainWindow(QWidget *parent)
     connect(&DebugSignals::instance(), &DebugSignals::debugHex, this, &MainWindow::handleDebugResponse);
     //connect(&DebugSignals::instance(), &DebugSignals::debugMain, this, &MainWindow::handleDebugEvent);
 
+    // node combos and the nodes dock follow the node table, filled from the decoded records.
+    // Scan adverts are aggregated there instead of logged, see adverts
+    m_nodeTable = new NodeTableModel(this);
+    ui->comboBoxNodeId->setModel(m_nodeTable);
+    ui->comboBoxNodeId->setModelColumn(NodeTableModel::ColumnNodeId);
+    QSortFilterProxyModel *nodeSort = new QSortFilterProxyModel(this);
+    nodeSort->setSourceModel(m_nodeTable);
+    QTableView *nodeView = new QTableView;
+    nodeView->setModel(nodeSort);
+    nodeView->setSortingEnabled(true);
+    nodeView->sortByColumn(NodeTableModel::ColumnNodeId, Qt::AscendingOrder);
+    nodeView->verticalHeader()->hide();
+    QDockWidget *nodeDock = new QDockWidget("Nodes", this);
+    nodeDock->setWidget(nodeView);
+    addDockWidget(Qt::BottomDockWidgetArea, nodeDock);
+    connect(m_nodeTable, &NodeTableModel::nodeTypeAdded, this, [this](int nodeType)
+    {
+        ui->comboBoxNodeType->addItem(QString::number(nodeType));
+    });
+
+    // per node payload statistics are counted on the rx thread, the dock shows a snapshot
+    // of them while it is visible
+    m_payloadStats = new PayloadStatsModel(this);
+    QSortFilterProxyModel *payloadSort = new QSortFilterProxyModel(this);
+    payloadSort->setSourceModel(m_payloadStats);
+    QTableView *payloadView = new QTableView;
+    payloadView->setModel(payloadSort);
+    payloadView->setSortingEnabled(true);
+    payloadView->sortByColumn(PayloadStatsModel::ColumnNodeId, Qt::AscendingOrder);
+    payloadView->verticalHeader()->hide();
+    QDockWidget *payloadDock = new QDockWidget("Payloads", this);
+    payloadDock->setWidget(payloadView);
+    addDockWidget(Qt::BottomDockWidgetArea, payloadDock);
+    tabifyDockWidget(nodeDock, payloadDock);
+    nodeDock->raise();
+    QTimer *payloadTimer = new QTimer(this);
+    connect(payloadTimer, &QTimer::timeout, this, [this, payloadDock]()
+    {
+        if (payloadDock->isVisible())
+        {
+            m_payloadStats->refresh();
+        }
+    });
+    payloadTimer->start(PAYLOAD_STATS_REFRESH_MS);
+
+    // decoded responses and events arrive as records, one queued signal per burst
+    connect(&DebugSignals::instance(), &DebugSignals::recordsReady, this, &MainWindow::drainRecords);
+    BLERecord_SetNotify(emitDebugRecords);
+    // decoder diagnostics go to the log pane as before the core was split out
+    BLEModule_SetLogSink([](uint8_t, const char *text) { emitDebugMain(text); });
+
 
 
     initializeCommandMap();
@@ -58,15 +162,23 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    Capture_ReplayStop();
+    OMLLinks_CloseAll();
     SerialClose();
+    Capture_Stop();
+    BLERecord_SetNotify(NULL);
+    BLEModule_SetLogSink(NULL);
     delete ui;
 }
 
-bool MainWindow::OMLInterface_Open(uint8_t port)
+bool MainWindow::OMLInterface_Open(const QString &portName)
 {
-    if (!SerialOpen(port, MCU_BAUD_RATE))
+    // frames are decoded on the serial rx thread, only decoded messages reach the GUI
+    SerialSetRxCallback(::OMLInterface_Process);
+
+    if (!SerialOpen(portName.toLocal8Bit().constData(), MCU_BAUD_RATE))
       {
-          qDebug() << "Failed to open serial port:" << port;
+          LOG_ERROR("Failed to open serial port: %s\n", qPrintable(portName));
           return false;
       }
 
@@ -82,13 +194,9 @@ bool MainWindow::OMLInterface_Open(uint8_t port)
 
 void MainWindow::OMLInterface_Purge()
 {
-    qDebug() <<"Serial data pending?: "+QString::number(SerialRxPending())+". Purging serial buffer";
-      while (SerialRxPending())
-      {
-          (void)SerialReadData();
-          qDebug() << "Purged one byte from serial buffer";
-      }
-      qDebug() << "Completed purging serial buffer";
+    LOG_INFO("Serial data pending?: %d. Purging serial buffer\n", SerialRxPending());
+    SerialFifoRxPurge();
+    LOG_INFO("Completed purging serial buffer\n");
 }
 
 void MainWindow::OMLInterface_Close()
@@ -96,23 +204,6 @@ void MainWindow::OMLInterface_Close()
      SerialClose();
 }
 
-void MainWindow::OMLInterface_Process()
-{
-    while (SerialRxPending())
-    {
-        uint8_t ch = SerialReadData();
-        qDebug() << "Received data:" << ch;
-        BLEModule_OnRx(ch);
-
-        QString str = QString::fromUtf8(reinterpret_cast<char*>(&ch), 1);
-        ui->textEdit->moveCursor(QTextCursor::Down);
-        ui->textEdit->insertPlainText(str);
-
-    }
-
-}
-
-
 void MainWindow::OMLInterface_Transmit(const void * const data, size_t len)
 {
     SerialWriteBytes(data, (int)len);
@@ -124,42 +215,41 @@ bool MainWindow::OMLInterface_Wake()
 
     if (SerialClrRts())
     {
-        qDebug() << "CLRRTS";
-        Sleep(100u);
+        LOG_INFO("CLRRTS\n");
+        TIMER_DelayMs(100u);
         if (SerialSetRts())
         {
-            qDebug() << "SETRTS";
-            Sleep(100u);
-            printf("CLRRTS\n");
+            LOG_INFO("SETRTS\n");
+            TIMER_DelayMs(100u);
             if (SerialClrRts())
             {
-                qDebug() << "CLRRTS";
-                Sleep(100u);
+                LOG_INFO("CLRRTS\n");
+                TIMER_DelayMs(100u);
                 if (SerialAutoRts())
                 {
-                    qDebug() << "AUTORTS";
+                    LOG_INFO("AUTORTS\n");
                     ret = true;
                 }
                 else
                 {
-                    qDebug() << "Failed to set AUTO RTS";
+                    LOG_ERROR("Failed to set AUTO RTS\n");
                 }
             }
             else
             {
-                qDebug() << "Failed to clear RTS second time";
+                LOG_ERROR("Failed to clear RTS second time\n");
             }
 
         }
         else
         {
-            qDebug() << "Failed to clear RTS initially";
+            LOG_ERROR("Failed to clear RTS initially\n");
         }
 
     }
     else
     {
-        qDebug() << "Serial port is not open";
+        LOG_ERROR("Serial port is not open\n");
     }
     return ret;
 
@@ -181,12 +271,14 @@ void MainWindow::on_pushButton_2_clicked()
 
     if (portOpen)
     {
-        ui->textEdit->setText("COM Port: "+ui->comboBox->currentText()+" Opened OK"+"\n");
+        clearLog();
+        appendLog("COM Port: "+ui->comboBox->currentText()+" Opened OK"+"\n");
         ui->statusbar->showMessage("Connected to Port "+ui->comboBox->currentText());
     }
     else
     {
-        ui->textEdit->setText("Failed to Open "+ui->comboBox->currentText()+"\n");
+        clearLog();
+        appendLog("Failed to Open "+ui->comboBox->currentText()+"\n");
         ui->statusbar->showMessage("Failed to Open "+ui->comboBox->currentText());
     }
 
@@ -213,7 +305,8 @@ void MainWindow::on_pushButton_2_clicked()
         {
             // Disconnect
             OMLInterface_Close();
-            ui->textEdit->setText("COM Port: " + ui->comboBox->currentText() + " Closed OK\n");
+            clearLog();
+            appendLog("Port: " + ui->comboBox->currentText() + " Closed OK\n");
             ui->statusbar->showMessage("Disconnected from Port " + ui->comboBox->currentText());
             ui->pushButton_2->setText("Connect");
             m_isConnected = false;
@@ -223,30 +316,31 @@ void MainWindow::on_pushButton_2_clicked()
             // Connect
             bool portOpen = false;
 
+            // a replay still running would publish its records alongside the live ones
+            Capture_ReplayStop();
+            BLEModule_Init();
+            CmdTracker_Init();
+            CmdQueue_Init();
+
             if (!ui->comboBox->currentText().isEmpty())
             {
-                uint8_t port = ui->comboBox->currentText().toUInt();
-                portOpen = OMLInterface_Open(port);
+                portOpen = OMLInterface_Open(ui->comboBox->currentText());
             }
 
             if (portOpen)
             {
-                ui->textEdit->setText("COM Port: " + ui->comboBox->currentText() + " Opened OK\n");
+                clearLog();
+                appendLog("Port: " + ui->comboBox->currentText() + " Opened OK\n");
                 ui->statusbar->showMessage("Connected to Port " + ui->comboBox->currentText());
                 ui->pushButton_2->setText("Disconnect");
                 m_isConnected = true;
             }
             else
             {
-                ui->textEdit->setText("Failed to Open " + ui->comboBox->currentText() + "\n");
+                clearLog();
+                appendLog("Failed to Open " + ui->comboBox->currentText() + "\n");
                 ui->statusbar->showMessage("Failed to Open " + ui->comboBox->currentText());
             }
-
-            TIMER_Init();
-            BLEModule_Init();
-
-            OMLInterface_Purge();
-            OMLInterface_Process();
         }
 
 
@@ -263,7 +357,11 @@ void MainWindow::checkComPorts()
 
         if (info.vendorIdentifier() == targetVID && info.productIdentifier() == targetPID)
         {
+#ifdef Q_OS_WIN
             newComPorts.append(info.portName());
+#else
+            newComPorts.append(info.systemLocation());  // the termios backend needs the device path
+#endif
         }
     }
 
@@ -272,12 +370,7 @@ void MainWindow::checkComPorts()
     {
         if (!m_currentComPorts.contains(port))
         {
-            QString portNumber = port;
-            if (port.startsWith("COM"))
-            {
-                portNumber = port.mid(3);  // Get the part after "COM"
-            }
-            ui->comboBox->addItem(portNumber);
+            ui->comboBox->addItem(port);
         }
     }
 
@@ -285,8 +378,7 @@ void MainWindow::checkComPorts()
     QStringList portsToRemove;
     for (int i = 0; i < ui->comboBox->count(); ++i)
     {
-        QString portText = "COM" + ui->comboBox->itemText(i);
-        if (!newComPorts.contains(portText))
+        if (!newComPorts.contains(ui->comboBox->itemText(i)))
         {
             portsToRemove.append(ui->comboBox->itemText(i));
         }
@@ -304,21 +396,6 @@ void MainWindow::checkComPorts()
     m_currentComPorts = newComPorts;
 }
 
-void MainWindow::handleReadyRead()
-{
-
-    while (SerialRxPending())
-    {
-        uint8_t ch = SerialReadData();
-        qDebug() << "Received data:" << ch;
-        BLEModule_OnRx(ch);
-        //         QString str = QString::fromUtf8(reinterpret_cast<char*>(&ch), 1);
-        //         ui->textEdit->moveCursor(QTextCursor::Down);
-        //         ui->textEdit->insertPlainText(str);
-    }
-}
-
-
 void MainWindow::on_pushButton_5_clicked()
 {
     commands.nop();
@@ -374,14 +451,15 @@ void MainWindow::on_pushButton_7_clicked()
 
 void MainWindow::on_pushButton_3_clicked()
 {
-    ui->textEdit->clear();
+    clearLog();
     SerialFifoRxPurge();
 }
 
 void MainWindow::on_sendCommandButton()
 {
-    QString command = ui->lineEdit->text().trimmed().toLower();
-
+    // first word picks the command, the rest are its arguments
+    m_commandArgs = ui->lineEdit->text().trimmed().toLower().split(' ', QString::SkipEmptyParts);
+    QString command = m_commandArgs.isEmpty() ? QString() : m_commandArgs.takeFirst();
 
     if (commandMap.contains(command))
     {
@@ -389,7 +467,7 @@ void MainWindow::on_sendCommandButton()
     }
     else
     {
-        ui->textEdit->append("Unknown command: " + command+" :(");
+        appendLog("Unknown command: " + command+" :(");
     }
 
     ui->lineEdit->clear();
@@ -397,94 +475,628 @@ void MainWindow::on_sendCommandButton()
 
 void MainWindow::handleDebugEvent(const QString &message)
 {
+    drainRecords();  // keep the order the messages arrived in
+    m_log->appendText(message, LogModel::KindEvent);
+    scheduleLogFlush();
+}
 
-    ui->textEdit->setReadOnly(false);
-    QTextCursor cursor(ui->textEdit->textCursor());
-    cursor.movePosition(QTextCursor::End);
-    cursor.insertBlock();
+void MainWindow::handleDebugResponse(const QString &message)
+{
+    drainRecords();
+    m_log->appendText(message, LogModel::KindResponse);
+    scheduleLogFlush();
+}
+
+void MainWindow::drainRecords()
+{
+    // queued as records, the text is only made for the rows the view shows
+    qint64 wallMs = QDateTime::currentMSecsSinceEpoch();
+    quint64 nowUs = TIMER_NowUs();
+    const BLERecord_t *rec;
+    while ((rec = BLERecord_Peek()) != NULL)
+    {
+        m_nodeTable->onRecord(*rec, wallMs, nowUs);
+        if (m_logAdverts || (rec->kind != eBLE_RECORD_EVT) || (rec->id != MCU_EVT_NODE_FOUND))
+        {
+            m_log->appendRecord(*rec);
+        }
+        BLERecord_Release();
+    }
+    scheduleLogFlush();
+}
 
-    QTextCharFormat format;
-    format.setForeground(QBrush(QColor("blue")));
+void MainWindow::appendLog(const QString &text)
+{
+    drainRecords();
+    m_log->appendText(text);
+    scheduleLogFlush();
+}
 
-    cursor.setCharFormat(format);
-    cursor.insertText("Event: " + message);
+void MainWindow::clearLog()
+{
+    drainRecords();
+    m_log->clear();
+}
 
-    ui->textEdit->setTextCursor(cursor);
+void MainWindow::scheduleLogFlush()
+{
+    if ((m_log->hasPending() || m_nodeTable->hasPending()) && !m_logFlushTimer->isActive())
+    {
+        m_logFlushTimer->start();
+    }
+}
 
-     QRegularExpression nodeIdRegex("NodeId:(\\d+)");
-     QRegularExpression nodeTypeRegex("NodeType:(\\d+)");
+void MainWindow::flushLog()
+{
+    drainRecords();
+
+    // follow the end of the log unless the user has scrolled back
+    QScrollBar *scrollBar = ui->logView->verticalScrollBar();
+    bool follow = (scrollBar->value() == scrollBar->maximum());
+    m_log->flush();
+    m_nodeTable->flush();
+    m_logFlushTimer->stop();  // drainRecords above may have rearmed it for what was just shown
+    if (follow)
+    {
+        ui->logView->scrollToBottom();
+    }
+}
 
-     QRegularExpressionMatch nodeIdMatch = nodeIdRegex.match(message);
-     QRegularExpressionMatch nodeTypeMatch = nodeTypeRegex.match(message);
-     if (!nodeIdMatch.hasMatch() || !nodeTypeMatch.hasMatch()) {
-             return; // No NodeId or NodeType found, exit the function
-         }
+void MainWindow::copyLogSelection()
+{
+    QModelIndexList rows = ui->logView->selectionModel()->selectedRows();
+    std::sort(rows.begin(), rows.end());
 
-         QString nodeId = nodeIdMatch.captured(1); // Extracted NodeId
-         QString nodeType = nodeTypeMatch.captured(1); // Extracted NodeType
+    QStringList lines;
+    for (const QModelIndex &index : rows)
+    {
+        QModelIndex source = (ui->logView->model() == m_logLinks) ? m_logLinks->mapToSource(index) : index;
+        lines.append(m_log->rowText(source.row()));
+    }
+    QApplication::clipboard()->setText(lines.join('\n'));
+}
 
+void MainWindow::initializeCommandMap()
+{
+    commandMap["nop"] = std::bind(&TerminalCommands::nop, &commands);
+    commandMap["onmcureset"] = std::bind(&TerminalCommands::onmcureset, &commands);
+    commandMap["getnodeid"] = std::bind(&TerminalCommands::getnodeid, &commands);
+    //commandMap["connect"] = std::bind(&TerminalCommands::connectble, &commands);
+   // commandMap["disconnect"] = std::bind(&TerminalCommands::disconnectble, &commands);
+    commandMap["fwver"] = std::bind(&TerminalCommands::fwver, &commands);
+    commandMap["help"] = std::bind(&MainWindow::listAvailableCommands, this);
+    commandMap["benchrx"] = std::bind(&MainWindow::runRxBenchmark, this);
+    commandMap["rxstats"] = std::bind(&MainWindow::showRxStats, this);
+    commandMap["benchlog"] = std::bind(&MainWindow::runLogBenchmark, this);
+    commandMap["benchcrc"] = std::bind(&MainWindow::runCrcBenchmark, this);
+    commandMap["benchlat"] = std::bind(&MainWindow::runLatencyBenchmark, this);
+    commandMap["benchtx"] = std::bind(&MainWindow::runTxBenchmark, this);
+    commandMap["cmdstats"] = std::bind(&MainWindow::showCmdStats, this);
+    commandMap["soak"] = std::bind(&MainWindow::runSoak, this);
+    commandMap["pingbench"] = std::bind(&MainWindow::runPingBenchmark, this);
+    commandMap["ackbench"] = std::bind(&MainWindow::runAckBenchmark, this);
+    commandMap["backend"] = std::bind(&MainWindow::selectSerialBackend, this);
+    commandMap["capture"] = std::bind(&MainWindow::captureLink, this);
+    commandMap["replay"] = std::bind(&MainWindow::replayCapture, this);
+    commandMap["logsize"] = std::bind(&MainWindow::setLogSize, this);
+    commandMap["logspill"] = std::bind(&MainWindow::setLogSpill, this);
+    commandMap["find"] = std::bind(&MainWindow::findInLog, this);
+    commandMap["adverts"] = std::bind(&MainWindow::setLogAdverts, this);
+    commandMap["nodes"] = std::bind(&MainWindow::showNodes, this);
+    commandMap["payloadstats"] = std::bind(&MainWindow::showPayloadStats, this);
+    commandMap["link"] = std::bind(&MainWindow::manageLinks, this);
+}
 
-         int nodeIdIndex = ui->comboBoxNodeId->findText(nodeId);
-         if (nodeIdIndex == -1) {
-             // NodeId not in the ComboBox, add it
-             ui->comboBoxNodeId->addItem(nodeId);
-         }
+void MainWindow::listAvailableCommands()
+{
 
+    clearLog();
 
-         int nodeTypeIndex = ui->comboBoxNodeType->findText(nodeType);
-         if (nodeTypeIndex == -1) {
-             // NodeType not in the ComboBox, add it
-             ui->comboBoxNodeType->addItem(nodeType);
-         }
+    appendLog("Available commands:");
+    for (auto it = commandMap.cbegin(); it != commandMap.cend(); ++it)
+    {
+        appendLog(it.key());
+    }
 
 
 }
 
-void MainWindow::handleDebugResponse(const QString &message)
+void MainWindow::runRxBenchmark()
+{
+    if (m_isConnected)
+    {
+        // the serial rx thread would compete with the benchmark for the CPU
+        appendLog("Disconnect before running the RX benchmark");
+        return;
+    }
+
+    QByteArray capture;
+    QString source = QFileDialog::getOpenFileName(this, "Select raw capture", QString(), "Capture (*.bin *.raw);;All files (*)");
+
+    if (!source.isEmpty())
+    {
+        QFile file(source);
+        if (file.open(QIODevice::ReadOnly))
+        {
+            capture = file.readAll();
+        }
+    }
+
+    if (capture.isEmpty())
+    {
+        std::vector<uint8_t> synthetic(1024u * 1024u);
+        size_t len = Benchmark_MakeCapture(synthetic.data(), synthetic.size());
+        capture = QByteArray(reinterpret_cast<const char*>(synthetic.data()), static_cast<int>(len));
+        source = "synthetic";
+    }
+
+    appendLog(QString("RX decoder benchmark on %1 (%2 bytes)").arg(source).arg(capture.size()));
+
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(capture.constData());
+    for (bool perByte : {true, false})
+    {
+        BenchmarkResult_t result;
+        Benchmark_RxDecoder(data, static_cast<size_t>(capture.size()), perByte, &result);
+
+        double seconds = (result.elapsedMs > 0u) ? (result.elapsedMs / 1000.0) : 0.001;
+        appendLog(QString("%1: %2 frames/sec, %3 MB/s (%4 frames in %5 ms)")
+                             .arg(perByte ? "BLEModule_OnRx     " : "BLEModule_OnRxBlock")
+                             .arg(result.frames / seconds, 0, 'f', 0)
+                             .arg(result.bytes / seconds / 1e6, 0, 'f', 2)
+                             .arg(result.frames)
+                             .arg(result.elapsedMs));
+    }
+}
+
+void MainWindow::runLogBenchmark()
 {
+    if (m_isConnected)
+    {
+        appendLog("Disconnect before running the logging benchmark");
+        return;
+    }
+
+    std::vector<uint8_t> capture(1024u * 1024u);
+    size_t len = Benchmark_MakeCapture(capture.data(), capture.size());
+    QString tracePath = QDir::temp().filePath("oml_trace_bench.bin");
 
-    ui->textEdit->setReadOnly(false);
-    QTextCursor cursor(ui->textEdit->textCursor());
-    cursor.movePosition(QTextCursor::End);
-    cursor.insertBlock();
+    appendLog(QString("RX logging benchmark, %1 synthetic bytes, trace to %2").arg(len).arg(tracePath));
 
-    QTextCharFormat format;
-    format.setForeground(QBrush(QColor("green")));
+    for (bool trace : {false, true})
+    {
+        if (trace && !DBG_TraceOpen(tracePath.toLocal8Bit().constData()))
+        {
+            appendLog("Could not open " + tracePath);
+            break;
+        }
 
-    cursor.setCharFormat(format);
-    cursor.insertText("Response: " + message + "\n");
+        BenchmarkResult_t result;
+        Benchmark_RxDecoder(capture.data(), len, false, &result);
+        DBG_TraceClose();
 
-    ui->textEdit->setTextCursor(cursor);
+        double seconds = (result.elapsedMs > 0u) ? (result.elapsedMs / 1000.0) : 0.001;
+        appendLog(QString("Trace %1: %2 MB/s, %3 frames/sec")
+                             .arg(trace ? "on " : "off")
+                             .arg(result.bytes / seconds / 1e6, 0, 'f', 2)
+                             .arg(result.frames / seconds, 0, 'f', 0));
+    }
+    QFile::remove(tracePath);
 }
 
-void MainWindow::processInterfaces()
+void MainWindow::runCrcBenchmark()
 {
-    OMLInterface_Process();
+    appendLog(QString("CRC-8 self test: %1, selected: %2")
+                         .arg(crc8ccitt_selftest() ? "pass" : "FAIL")
+                         .arg(crc8ccitt_impl_name(crc8ccitt_impl_selected())));
+
+    std::vector<uint8_t> buf(64u * 1024u);
+    for (size_t i = 0; i < buf.size(); i++)
+    {
+        buf[i] = static_cast<uint8_t>(i * 7u);
+    }
+
+    for (size_t len = 1u; len <= buf.size(); len *= 4u)
+    {
+        QString line = QString("%1 B:").arg(len, 6);
+        for (int impl = 0; impl < eCRC8_IMPL_COUNT; impl++)
+        {
+            if (!crc8ccitt_impl_supported(static_cast<Crc8Impl_e>(impl)))
+            {
+                continue;
+            }
+            BenchmarkResult_t result;
+            Benchmark_Crc8(static_cast<Crc8Impl_e>(impl), buf.data(), len, &result);
+
+            double seconds = (result.elapsedMs > 0u) ? (result.elapsedMs / 1000.0) : 0.001;
+            line += QString("  %1 %2 MB/s").arg(crc8ccitt_impl_name(static_cast<Crc8Impl_e>(impl)))
+                    .arg(result.bytes / seconds / 1e6, 0, 'f', 0);
+        }
+        appendLog(line);
+        QCoreApplication::processEvents();
+    }
 }
 
-void MainWindow::initializeCommandMap()
+void MainWindow::runLatencyBenchmark()
 {
-    commandMap["nop"] = std::bind(&TerminalCommands::nop, &commands);
-    commandMap["onmcureset"] = std::bind(&TerminalCommands::onmcureset, &commands);
-    commandMap["getnodeid"] = std::bind(&TerminalCommands::getnodeid, &commands);
-    //commandMap["connect"] = std::bind(&TerminalCommands::connectble, &commands);
-   // commandMap["disconnect"] = std::bind(&TerminalCommands::disconnectble, &commands);
-    commandMap["fwver"] = std::bind(&TerminalCommands::fwver, &commands);
-    commandMap["help"] = std::bind(&MainWindow::listAvailableCommands, this);
+    if (m_isConnected)
+    {
+        appendLog("Disconnect before running the latency benchmark");
+        return;
+    }
+
+    appendLog("Last byte to handler latency, 100000 max-length frames:");
+    for (bool rewalk : {true, false})
+    {
+        BenchmarkLatency_t result;
+        Benchmark_RxLatency(rewalk, 100000u, TIMER_NowNs, &result);
+
+        appendLog(QString("%1: min %2 ns, mean %3 ns, max %4 ns")
+                             .arg(rewalk ? "CRC re-walk at completion (before)" : "incremental CRC (now)")
+                             .arg(result.minNs)
+                             .arg(result.totalNs / (result.count ? result.count : 1u))
+                             .arg(result.maxNs));
+    }
 }
 
-void MainWindow::listAvailableCommands()
+void MainWindow::runTxBenchmark()
+{
+    if (m_isConnected)
+    {
+        appendLog("Disconnect before running the TX benchmark");
+        return;
+    }
+
+    static const char *modeNames[eBENCHMARK_TX_COUNT] = {"3 writes per frame (before)", "1 write per frame", "coalesced"};
+
+    appendLog("TX through a pseudo terminal, 20 byte payloads:");
+    for (int mode = 0; mode < eBENCHMARK_TX_COUNT; mode++)
+    {
+        BenchmarkResult_t result;
+        if (!Benchmark_TxPty(static_cast<BenchmarkTxMode_e>(mode), 20u, &result))
+        {
+            appendLog("No pseudo terminal available on this platform");
+            return;
+        }
+
+        double seconds = (result.elapsedMs > 0u) ? (result.elapsedMs / 1000.0) : 0.001;
+        appendLog(QString("%1: %2 frames/s, %3 writes per frame")
+                             .arg(modeNames[mode])
+                             .arg(result.frames / seconds, 0, 'f', 0)
+                             .arg(static_cast<double>(result.writes) / (result.frames ? result.frames : 1u), 0, 'f', 3));
+        QCoreApplication::processEvents();
+    }
+}
+
+// backend [qt|termios]: show or pick how the serial port is driven
+void MainWindow::selectSerialBackend()
 {
+    QString name = m_commandArgs.value(0);
+    if (!name.isEmpty())
+    {
+        bool found = false;
+        for (int backend = 0; backend < eSERIAL_BACKEND_COUNT; backend++)
+        {
+            if (name == SerialBackendName(static_cast<SerialBackend_e>(backend)))
+            {
+                found = true;
+                if (m_isConnected)
+                {
+                    appendLog("Disconnect before changing the serial backend");
+                }
+                else if (!SerialSetBackend(static_cast<SerialBackend_e>(backend)))
+                {
+                    appendLog(QString("Serial backend %1 is not available on this platform").arg(name));
+                }
+            }
+        }
+        if (!found)
+        {
+            appendLog("Unknown serial backend: " + name);
+        }
+    }
 
-    ui->textEdit->clear();
+    QString available;
+    for (int backend = 0; backend < eSERIAL_BACKEND_COUNT; backend++)
+    {
+        if (SerialBackendSupported(static_cast<SerialBackend_e>(backend)))
+        {
+            available += QString(" ") + SerialBackendName(static_cast<SerialBackend_e>(backend));
+        }
+    }
+    appendLog(QString("Serial backend: %1 (available:%2)").arg(SerialBackendName(SerialGetBackend())).arg(available));
+}
 
-    ui->textEdit->append("Available commands:");
-    for (auto it = commandMap.cbegin(); it != commandMap.cend(); ++it)
+void MainWindow::showRxStats()
+{
+    SerialRxStats_t stats;
+    SerialGetRxStats(&stats);
+
+    appendLog(QString("RX bytes: %1, ring high water: %2 of %3, overflows: %4 (%5 bytes dropped)")
+                         .arg(stats.rxBytes)
+                         .arg(stats.ringHighWater)
+                         .arg(stats.ringCapacity)
+                         .arg(stats.overflows)
+                         .arg(stats.overflowBytes));
+    appendLog(QString("Decoded records dropped: %1").arg(BLERecord_Dropped()));
+}
+
+void MainWindow::showCmdStats()
+{
+    appendLog(QString("Commands outstanding: %1").arg(CmdTracker_Outstanding()));
+
+    for (int cmdId = 0; cmdId < 256; cmdId++)
+    {
+        CmdTrackerStats_t stats;
+        CmdTracker_GetStats(static_cast<uint8_t>(cmdId), &stats);
+        if ((stats.sent == 0u) && (stats.unmatched == 0u))
+        {
+            continue;
+        }
+
+        appendLog(QString("cmd 0x%1: sent %2, completed %3, timed out %4, unknown %5, unmatched %6, rtt min %7 mean %8 max %9 us")
+                             .arg(cmdId, 2, 16, QChar('0'))
+                             .arg(stats.sent)
+                             .arg(stats.completed)
+                             .arg(stats.timedOut)
+                             .arg(stats.rejected)
+                             .arg(stats.unmatched)
+                             .arg(stats.rttMinUs)
+                             .arg(stats.rttTotalUs / (stats.completed ? stats.completed : 1u))
+                             .arg(stats.rttMaxUs));
+
+        QString hist = "    rtt us:";
+        for (uint32_t bucket = 0; bucket < CMD_TRACKER_HIST_BUCKETS; bucket++)
+        {
+            if (stats.hist[bucket] != 0u)
+            {
+                bool last = (bucket == (CMD_TRACKER_HIST_BUCKETS - 1u));
+                hist += QString(" %1%2:%3").arg(last ? ">=" : "<").arg(1u << (last ? (bucket - 1u) : bucket)).arg(stats.hist[bucket]);
+            }
+        }
+        appendLog(hist);
+    }
+}
+
+// soak [count] [window]: pipeline count nops through the command queue
+void MainWindow::runSoak()
+{
+    if (!m_isConnected)
+    {
+        appendLog("Connect before running a soak test");
+        return;
+    }
+
+    uint32_t count = m_commandArgs.value(0, "1000").toUInt();
+    CmdQueue_Init();
+    CmdQueue_SetWindow(m_commandArgs.value(1, QString::number(CMD_QUEUE_DEFAULT_WINDOW)).toUInt());
+    appendLog(QString("Soak: %1 nop commands, window %2").arg(count).arg(CmdQueue_GetWindow()));
+
+    // top the queue up as it drains, a full queue refuses pushes until the dongle catches up
+    std::shared_ptr<uint32_t> remaining = std::make_shared<uint32_t>(count);
+    QTimer *timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, [this, timer, remaining]()
+    {
+        MCU_CMD_NOP_t cmd;
+        cmd.cmdId = MCU_CMD_NOP;
+        while ((*remaining > 0u) && CmdQueue_Push(&cmd, sizeof(cmd), 0, NULL, NULL))
+        {
+            (*remaining)--;
+        }
+
+        CmdQueueStats_t stats;
+        CmdQueue_GetStats(&stats);
+        if (((*remaining == 0u) && (stats.queued == 0u) && (stats.inFlight == 0u)) || !m_isConnected)
+        {
+            timer->stop();
+            timer->deleteLater();
+            appendLog(QString("Soak done: sent %1, completed %2, timed out %3, unknown %4, peak in flight %5, %6 commands/s")
+                                 .arg(stats.sent)
+                                 .arg(stats.completed)
+                                 .arg(stats.timedOut)
+                                 .arg(stats.unknown)
+                                 .arg(stats.inFlightHighWater)
+                                 .arg(CmdQueue_Rate(&stats)));
+        }
+    });
+    timer->start(10);
+}
+
+// pingbench <nodeid> [count] [interval ms]: round-trip latency of remote MCU pings
+void MainWindow::runPingBenchmark()
+{
+    if (!m_isConnected)
+    {
+        appendLog("Connect before running the ping benchmark");
+        return;
+    }
+    if (m_commandArgs.isEmpty())
+    {
+        appendLog("Usage: pingbench <nodeid> [count] [interval ms]");
+        return;
+    }
+
+    NodeId_t nodeId = static_cast<NodeId_t>(m_commandArgs.value(0).toUInt());
+    uint32_t count = m_commandArgs.value(1, QString::number(PING_BENCH_DEFAULT_COUNT)).toUInt();
+    uint32_t intervalMs = m_commandArgs.value(2, QString::number(PING_BENCH_DEFAULT_INTERVAL_MS)).toUInt();
+    if (!PingBench_Start(nodeId, count, intervalMs, PING_BENCH_DEFAULT_TIMEOUT_MS))
+    {
+        appendLog("Nothing to send");
+        return;
+    }
+    appendLog(QString("Pinging node %1: %2 pings every %3 ms").arg(nodeId).arg(count).arg(intervalMs));
+
+    // the rx thread only polls every 50 ms, pace the pings from here
+    QTimer *timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, [this, timer]()
+    {
+        if (PingBench_Poll() && m_isConnected)
+        {
+            return;
+        }
+        PingBench_Stop();
+        timer->stop();
+        timer->deleteLater();
+
+        PingBenchResult_t result;
+        PingBench_GetResult(&result);
+        appendLog(QString("Ping: sent %1, received %2, lost %3, late replies %4")
+                             .arg(result.sent).arg(result.received).arg(result.lost).arg(result.late));
+        appendLog(QString("RTT us: min %1, mean %2, p50 %3, p99 %4, max %5")
+                             .arg(result.minUs).arg(result.meanUs).arg(result.p50Us).arg(result.p99Us).arg(result.maxUs));
+
+        QString histPath = QDir::temp().filePath("oml_ping_hist.csv");
+        if (PingBench_ExportHistogram(histPath.toLocal8Bit().constData(), 250u))
+        {
+            appendLog("Histogram written to " + histPath);
+        }
+    });
+    timer->start(1);
+}
+
+// ackbench <nodeid> [count] [bytes] [window]: goodput and ack latency of acknowledged payloads
+void MainWindow::runAckBenchmark()
+{
+    if (!m_isConnected)
+    {
+        appendLog("Connect before running the ack benchmark");
+        return;
+    }
+    if (m_commandArgs.isEmpty())
+    {
+        appendLog("Usage: ackbench <nodeid> [count] [bytes] [window]");
+        return;
+    }
+
+    NodeId_t nodeId = static_cast<NodeId_t>(m_commandArgs.value(0).toUInt());
+    uint32_t count = m_commandArgs.value(1, QString::number(ACK_BENCH_DEFAULT_COUNT)).toUInt();
+    uint32_t payloadLen = m_commandArgs.value(2, QString::number(ACK_BENCH_DEFAULT_LEN)).toUInt();
+    uint32_t window = m_commandArgs.value(3, QString::number(ACK_BENCH_DEFAULT_WINDOW)).toUInt();
+    if (!AckBench_Start(nodeId, count, payloadLen, window, ACK_BENCH_DEFAULT_TIMEOUT_MS))
+    {
+        appendLog("Nothing to send");
+        return;
+    }
+    appendLog(QString("Sending node %1: %2 acknowledged payloads of %3 bytes, window %4")
+                         .arg(nodeId).arg(count).arg(payloadLen).arg(window));
+
+    // the window moves as soon as an ack is seen, poll fast so the link rather than the
+    // poll rate limits the throughput
+    QTimer *timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, [this, timer]()
     {
-        ui->textEdit->append(it.key());
+        if (AckBench_Poll() && m_isConnected)
+        {
+            return;
+        }
+        AckBench_Stop();
+        timer->stop();
+        timer->deleteLater();
+
+        AckBenchResult_t result;
+        AckBench_GetResult(&result);
+        uint32_t retransmit = result.lost + result.rejected;
+        appendLog(QString("Ack: sent %1, accepted %2, acked %3, lost %4, rejected %5, late %6, window max %7")
+                             .arg(result.sent).arg(result.accepted).arg(result.acked).arg(result.lost)
+                             .arg(result.rejected).arg(result.late).arg(result.windowMax));
+        appendLog(QString("Retransmit needed: %1 (%2%)")
+                             .arg(retransmit)
+                             .arg((result.sent > 0u) ? (100.0 * retransmit / result.sent) : 0.0, 0, 'f', 2));
+        appendLog(QString("Ack latency us: min %1, mean %2, p50 %3, p99 %4, max %5")
+                             .arg(result.ackMinUs).arg(result.ackMeanUs).arg(result.ackP50Us).arg(result.ackP99Us).arg(result.ackMaxUs));
+        appendLog(QString("Goodput %1 B/s of %2 B/s offered, %3 bytes acked in %4 ms")
+                             .arg(result.goodputBytesPerSec).arg(result.offeredBytesPerSec)
+                             .arg(result.ackedBytes).arg(result.elapsedUs / 1000u));
+    });
+    timer->start(1);
+}
+
+// capture [start [file]|stop]: record raw link traffic, shows progress with no arguments
+void MainWindow::captureLink()
+{
+    QString action = m_commandArgs.value(0);
+    if (action == "start")
+    {
+        QString path = m_commandArgs.value(1);
+        if (path.isEmpty())
+        {
+            path = QDir::temp().filePath(QString("oml_%1%2").arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")).arg(CAPTURE_EXTENSION));
+        }
+        QByteArray pathBytes = path.toLocal8Bit();
+        appendLog(Capture_Start(pathBytes.constData()) ? "Capturing to " + path : "Cannot create " + path);
+    }
+    else if (action == "stop")
+    {
+        Capture_Stop();
+    }
+    else if (!action.isEmpty())
+    {
+        appendLog("Usage: capture [start [file]|stop]");
     }
 
+    CaptureStats_t stats;
+    Capture_GetStats(&stats);
+    appendLog(QString("Capture %1: %2 records, %3 bytes, %4 bytes dropped")
+                         .arg(stats.active ? "running" : "stopped")
+                         .arg(stats.records)
+                         .arg(stats.bytes)
+                         .arg(stats.droppedBytes));
+}
 
+// replay <file> [fast] [decode]: feed a capture through the decoder, in real time by default.
+// fast runs flat out as a throughput benchmark, decode counts frames without the handlers
+void MainWindow::replayCapture()
+{
+    if (m_isConnected)
+    {
+        // the replay's frame handlers publish to the record pool the serial rx thread fills
+        appendLog("Disconnect before replaying a capture");
+        return;
+    }
+    if (m_commandArgs.isEmpty())
+    {
+        appendLog("Usage: replay <file> [fast] [decode]");
+        return;
+    }
+
+    CaptureReplayMode_e mode = m_commandArgs.contains("fast") ? eCAPTURE_REPLAY_FAST : eCAPTURE_REPLAY_REALTIME;
+    bool handlers = !m_commandArgs.contains("decode");
+    QByteArray pathBytes = m_commandArgs.value(0).toLocal8Bit();
+    if (!Capture_ReplayStart(pathBytes.constData(), mode, handlers))
+    {
+        appendLog("Cannot replay " + m_commandArgs.value(0));
+        return;
+    }
+    appendLog(QString("Replaying %1 %2%3").arg(m_commandArgs.value(0))
+                         .arg((mode == eCAPTURE_REPLAY_FAST) ? "as fast as possible" : "in real time")
+                         .arg(handlers ? "" : ", decode only"));
+
+    QTimer *timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, [this, timer]()
+    {
+        CaptureReplayResult_t result;
+        if (Capture_ReplayPoll(&result))
+        {
+            return;
+        }
+        timer->stop();
+        timer->deleteLater();
+
+        double seconds = (result.elapsedUs > 0u) ? (result.elapsedUs / 1e6) : 1e-6;
+        appendLog(QString("Replay done%1: %2 records, %3 frames from %4 rx bytes (%5 tx bytes skipped)")
+                             .arg(result.truncated ? " (file truncated)" : "")
+                             .arg(result.records)
+                             .arg(result.frames)
+                             .arg(result.rxBytes)
+                             .arg(result.txBytes));
+        appendLog(QString("%1 ms of traffic in %2 ms: %3 frames/s, %4 MB/s")
+                             .arg(result.durationUs / 1000u)
+                             .arg(result.elapsedUs / 1000u)
+                             .arg(result.frames / seconds, 0, 'f', 0)
+                             .arg(result.rxBytes / seconds / 1e6, 0, 'f', 2));
+    });
+    timer->start(100);
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
@@ -556,8 +1168,8 @@ void MainWindow::on_pushButton_11_clicked()
 
     TerminalArg_t args[2];
     args[0].l = ui->comboBoxNodeId->currentText().toUInt(nullptr, 10);
-    QString payload = ui->lineEdit->text();
-    args[1].s = payload.toUtf8().constData();
+    QByteArray payload = ui->lineEdit->text().toUtf8();
+    args[1].s = payload.constData();
     commands.txpayload(args);
     ui->lineEdit->clear();
 }
@@ -567,8 +1179,8 @@ void MainWindow::on_pushButton_clicked()
 {
     TerminalArg_t args[2];
     args[0].l = ui->comboBoxNodeId->currentText().toUInt(nullptr, 10);
-    QString payload = ui->lineEdit->text();
-    args[1].s = payload.toUtf8().constData();
+    QByteArray payload = ui->lineEdit->text().toUtf8();
+    args[1].s = payload.constData();
     commands.txpayloadack(args);
     ui->lineEdit->clear();
 }
@@ -598,3 +1210,268 @@ void MainWindow::on_pushButton_12_clicked()
     msgBox.setDefaultButton(QMessageBox::Close);
     msgBox.exec();
 }
+
+// logsize [rows]: show or change how many rows the log keeps in memory
+void MainWindow::setLogSize()
+{
+    if (!m_commandArgs.isEmpty())
+    {
+        int rows = m_commandArgs.value(0).toInt();
+        if (rows <= 0)
+        {
+            appendLog("Usage: logsize [rows]");
+            return;
+        }
+        m_log->setCapacity(rows);
+    }
+    appendLog(QString("Log keeps %1 rows, %2 rows evicted%3")
+                         .arg(m_log->capacity())
+                         .arg(m_log->evicted())
+                         .arg(m_logSpill.isActive() ? " to " + m_logSpill.dir() : QString()));
+}
+
+// logspill [on [dir] [mb] [files]|off]: keep the records evicted from the log in rotating
+// capture files, so find still sees them and they can be replayed
+void MainWindow::setLogSpill()
+{
+    QString action = m_commandArgs.value(0);
+    if (action == "on")
+    {
+        QString dir = m_commandArgs.value(1, QDir::temp().filePath("oml_log"));
+        int mb = m_commandArgs.value(2, QString::number(LOG_SPILL_MB)).toInt();
+        int files = m_commandArgs.value(3, QString::number(LOG_SPILL_FILES)).toInt();
+        if ((mb <= 0) || (files <= 0) || !m_logSpill.start(dir, static_cast<qint64>(mb) << 20, files))
+        {
+            appendLog("Cannot spill to " + dir);
+            return;
+        }
+        m_log->setSpill(&m_logSpill);
+        appendLog(QString("Spilling evicted records to %1, %2 files of %3 MB").arg(dir).arg(files).arg(mb));
+    }
+    else if (action == "off")
+    {
+        m_log->setSpill(nullptr);
+        m_logSpill.stop();
+        appendLog("Log spill off");
+    }
+    else
+    {
+        appendLog(QString("Usage: logspill [on [dir] [mb] [files]|off], %1, %2 records spilled")
+                             .arg(m_logSpill.isActive() ? "spilling to " + m_logSpill.dir() : QString("off"))
+                             .arg(m_logSpill.records()));
+    }
+}
+
+// find <text>: case-insensitive search of the spilled records then the log in memory
+void MainWindow::findInLog()
+{
+    QString needle = m_commandArgs.join(' ');
+    if (needle.isEmpty())
+    {
+        appendLog("Usage: find <text>");
+        return;
+    }
+
+    flushLog();
+    m_logSpill.flush();
+
+    QStringList hits;
+    int spilled = m_logSpill.search(needle, LOG_FIND_MAX, &hits);
+    int found = spilled + m_log->find(needle, LOG_FIND_MAX - spilled, &hits);
+    for (const QString &hit : hits)
+    {
+        appendLog(hit);
+    }
+    appendLog(QString("find \"%1\": %2 matches (%3 on disk)%4")
+                         .arg(needle)
+                         .arg(found)
+                         .arg(spilled)
+                         .arg((found >= LOG_FIND_MAX) ? ", stopped at the limit" : ""));
+}
+
+// adverts [on|off]: log every MCU_EVT_NODE_FOUND as well as aggregating it in the nodes table
+void MainWindow::setLogAdverts()
+{
+    QString action = m_commandArgs.value(0);
+    if ((action == "on") || (action == "off"))
+    {
+        m_logAdverts = (action == "on");
+    }
+    else if (!action.isEmpty())
+    {
+        appendLog("Usage: adverts [on|off]");
+        return;
+    }
+    appendLog(QString("Scan adverts %1").arg(m_logAdverts ? "logged and aggregated" : "aggregated in the nodes table only"));
+}
+
+// nodes [clear]: summary of the nodes table, or empty it before a fresh scan
+void MainWindow::showNodes()
+{
+    if (m_commandArgs.value(0) == "clear")
+    {
+        flushLog();
+        m_nodeTable->clear();
+        ui->comboBoxNodeType->clear();
+    }
+    appendLog(QString("%1 nodes from %2 adverts").arg(m_nodeTable->rowCount()).arg(m_nodeTable->adverts()));
+}
+
+// payloadstats [nodeid|clear]: rates, gaps and RSSI of the payloads received from each node
+void MainWindow::showPayloadStats()
+{
+    QString action = m_commandArgs.value(0);
+    if (action == "clear")
+    {
+        m_payloadStats->clear();
+        appendLog("Payload statistics cleared");
+        return;
+    }
+
+    std::vector<PayloadStats_t> nodes(PAYLOAD_STATS_MAX_NODES);
+    size_t count = 0;
+    if (!action.isEmpty())
+    {
+        count = PayloadStats_Get(static_cast<NodeId_t>(action.toUInt()), &nodes[0]) ? 1u : 0u;
+    }
+    else
+    {
+        count = PayloadStats_GetNodes(nodes.data(), nodes.size());
+    }
+
+    if (count == 0u)
+    {
+        appendLog("No payloads received");
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        const PayloadStats_t &node = nodes[i];
+        appendLog(QString("Node %1: %2 packets, %3 bytes, %4 pkt/s, %5 B/s")
+                             .arg(node.nodeId).arg(node.packets).arg(node.bytes)
+                             .arg(node.packetsPerSec).arg(node.bytesPerSec));
+        appendLog(QString("  gap us: mean %1, p50 %2, p99 %3, max %4, jitter %5")
+                             .arg(node.gapMeanUs).arg(node.gapP50Us).arg(node.gapP99Us)
+                             .arg(node.gapMaxUs).arg(node.jitterUs));
+        appendLog(QString("  RSSI dBm: last %1, avg %2, min %3, p10 %4, p50 %5, p90 %6, max %7")
+                             .arg(node.rssi).arg(node.rssiAvg).arg(node.rssiMin).arg(node.rssiP10)
+                             .arg(node.rssiP50).arg(node.rssiP90).arg(node.rssiMax));
+    }
+    if (PayloadStats_Untracked() > 0u)
+    {
+        appendLog(QString("%1 payloads from nodes over the %2 tracked").arg(PayloadStats_Untracked()).arg(PAYLOAD_STATS_MAX_NODES));
+    }
+}
+
+// link [open [port]|close <n|all>|send <n> <hex>|view <all|n>]: extra dongles next to the
+// primary one, each read and decoded on its own threads. With no port, open opens every
+// discovered dongle not already open. Records from extra links are logged with their link id
+void MainWindow::manageLinks()
+{
+    QString action = m_commandArgs.value(0);
+    if (action == "open")
+    {
+        QStringList ports;
+        if (m_commandArgs.size() > 1)
+        {
+            // the command line is lower cased, take the discovered spelling of the port
+            QString port = m_commandArgs.value(1);
+            for (const QString &found : m_currentComPorts)
+            {
+                if (found.compare(port, Qt::CaseInsensitive) == 0)
+                {
+                    port = found;
+                }
+            }
+            ports.append(port);
+        }
+        else
+        {
+            for (const QString &port : m_currentComPorts)
+            {
+                if (!(m_isConnected && (port == ui->comboBox->currentText())))
+                {
+                    ports.append(port);
+                }
+            }
+        }
+
+        for (const QString &port : ports)
+        {
+            QByteArray portBytes = port.toLocal8Bit();
+            if ((OMLLinks_Find(portBytes.constData()) != 0u) || (m_isConnected && (port == ui->comboBox->currentText())))
+            {
+                appendLog(port + " is already open");
+                continue;
+            }
+            uint8_t link = OMLLinks_Open(portBytes.constData());
+            appendLog((link != 0u) ? QString("Link %1: %2 open").arg(link).arg(port) : "Cannot open " + port);
+        }
+        if (ports.isEmpty())
+        {
+            appendLog("No other dongles found");
+        }
+    }
+    else if (action == "close")
+    {
+        QString which = m_commandArgs.value(1);
+        if (which == "all")
+        {
+            OMLLinks_CloseAll();
+            appendLog("Extra links closed");
+        }
+        else if (!OMLLinks_Close(static_cast<uint8_t>(which.toUInt())))
+        {
+            appendLog("Usage: link close <1.." + QString::number(OML_LINKS_MAX - 1u) + "|all>");
+        }
+    }
+    else if (action == "send")
+    {
+        uint8_t link = static_cast<uint8_t>(m_commandArgs.value(1).toUInt());
+        QByteArray payload = QByteArray::fromHex(m_commandArgs.mid(2).join("").toLatin1());
+        if ((link == 0u) && !m_isConnected)
+        {
+            appendLog("Link 0 is not connected");
+        }
+        else if (payload.isEmpty() ||
+                 !OMLLinks_Transmit(link, payload.constData(), static_cast<size_t>(payload.size())))
+        {
+            appendLog("Usage: link send <n> <hex payload>, the link must be open");
+        }
+    }
+    else if (action == "view")
+    {
+        QString which = m_commandArgs.value(1);
+        m_linkView = ((which == "all") || which.isEmpty()) ? -1 : static_cast<int>(which.toUInt());
+        // text rows have no link and stay in every view
+        QItemSelectionModel *selection = ui->logView->selectionModel();
+        m_logLinks->setFilterRegularExpression((m_linkView < 0) ? QString() : QString("^(%1)?$").arg(m_linkView));
+        m_logLinks->setSourceModel((m_linkView < 0) ? nullptr : m_log);
+        ui->logView->setModel((m_linkView < 0) ? static_cast<QAbstractItemModel*>(m_log) : m_logLinks);
+        delete selection;
+        ui->logView->scrollToBottom();
+        appendLog((m_linkView < 0) ? QString("Showing every link") : QString("Showing link %1 only").arg(m_linkView));
+    }
+    else if (!action.isEmpty())
+    {
+        appendLog("Usage: link [open [port]|close <n|all>|send <n> <hex>|view <all|n>]");
+    }
+    else
+    {
+        SerialRxStats_t rx;
+        SerialGetRxStats(&rx);
+        appendLog(QString("Link 0: %1, %2 RX bytes")
+                             .arg(m_isConnected ? ui->comboBox->currentText() : QString("not connected"))
+                             .arg(rx.rxBytes));
+        for (uint8_t link = 1; link < OML_LINKS_MAX; link++)
+        {
+            OMLLinkStats_t stats;
+            if (OMLLinks_GetStats(link, &stats))
+            {
+                appendLog(QString("Link %1: %2, %3 RX bytes, %4 frames, %5 bad CRC, %6 overflows, %7 TX frames")
+                                     .arg(link).arg(stats.port).arg(stats.rx.rxBytes).arg(stats.decoder.frames)
+                                     .arg(stats.decoder.badCrc).arg(stats.rx.overflows).arg(stats.txFrames));
+            }
+        }
+    }
+}
@@ -5,13 +5,19 @@
 #include <QSerialPort>
 #include <QGroupBox>
 #include "includes/terminalcommands.h"
+#include "includes/logmodel.h"
+#include "includes/logspill.h"
+#include "includes/nodetablemodel.h"
+#include "includes/payloadstatsmodel.h"
 #include <functional>
 #include <string>
 #include <map>
 #include <QMap>
+#include <QStringList>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QSortFilterProxyModel;
 QT_END_NAMESPACE
 
 class MainWindow : public QMainWindow
@@ -21,17 +27,13 @@ class MainWindow : public QMainWindow
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
-    bool OMLInterface_Open(uint8_t port);
+    bool OMLInterface_Open(const QString &portName);
     void OMLInterface_Purge(void);
     void OMLInterface_Close(void);
-    void OMLInterface_Process(void);
     void OMLInterface_Transmit(const void *const data, size_t len);
     bool OMLInterface_Wake(void);
     void checkComPorts();
 
-public slots:
-    void handleReadyRead();
-
 protected:
     bool eventFilter(QObject *obj, QEvent *event) override; // Event filter
 
@@ -54,7 +56,9 @@ private slots:
 
     void handleDebugEvent(const QString &message);
     void handleDebugResponse(const QString &message);
-    void  processInterfaces();
+    void drainRecords();
+    void flushLog();
+    void copyLogSelection();
 
     void on_pushButton_8_clicked();
 
@@ -77,11 +81,43 @@ private:
 //    uint32_t baud = 1000000;
     TerminalCommands commands;
      bool m_isConnected = false;
+    NodeTableModel *m_nodeTable;
+    PayloadStatsModel *m_payloadStats;
+    LogModel *m_log;
+    QSortFilterProxyModel *m_logLinks;  // the log view while one link is viewed
+    LogSpill m_logSpill;
+    bool m_logAdverts = false;
+    int m_linkView = -1;  // link whose records are shown, -1 for every link
+    QTimer *m_logFlushTimer;
 
     typedef std::function<void()> CommandFunction;
     QMap<QString, CommandFunction> commandMap;
+    QStringList m_commandArgs;
     void initializeCommandMap();
+    void appendLog(const QString &text);
+    void clearLog();
+    void scheduleLogFlush();
     void listAvailableCommands();
+    void runRxBenchmark();
+    void showRxStats();
+    void runLogBenchmark();
+    void runCrcBenchmark();
+    void runLatencyBenchmark();
+    void runTxBenchmark();
+    void showCmdStats();
+    void runSoak();
+    void runPingBenchmark();
+    void runAckBenchmark();
+    void selectSerialBackend();
+    void captureLink();
+    void replayCapture();
+    void setLogSize();
+    void setLogSpill();
+    void findInLog();
+    void setLogAdverts();
+    void showNodes();
+    void showPayloadStats();
+    void manageLinks();
     void closeEvent (QCloseEvent *event);
 
 //    bool nop();
@@ -2,7 +2,7 @@ QT       += core gui serialport
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++14
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
@@ -11,31 +11,25 @@ CONFIG += c++11
 git_commit_hash = $$system(git rev-parse --short HEAD)
 DEFINES += GIT_COMMIT_HASH=\\\"$$git_commit_hash\\\"
 
+include(../oml_core/oml_core.pri)
+
 SOURCES += \
-    includes/ble_module.c \
-    includes/crc8.c \
-    includes/debug.c \
     includes/debug_signals_wrapper.cpp \
     includes/debugsignals.cpp \
-    includes/oml_interface.c \
-    includes/serial.cpp \
-    includes/terminalcommands.cpp \
-    includes/timer.c \
-    includes/utils.c \
+    includes/logmodel.cpp \
+    includes/logspill.cpp \
+    includes/nodetablemodel.cpp \
+    includes/payloadstatsmodel.cpp \
     main.cpp \
     mainwindow.cpp
 
 HEADERS += \
-    includes/ble_module.h \
-    includes/crc8.h \
-    includes/debug.h \
     includes/debug_signals_wrapper.h \
     includes/debugsignals.h \
-    includes/oml_interface.h \
-    includes/serial.h \
-    includes/terminalcommands.h \
-    includes/timer.h \
-    includes/utils.h \
+    includes/logmodel.h \
+    includes/logspill.h \
+    includes/nodetablemodel.h \
+    includes/payloadstatsmodel.h \
     mainwindow.h
 
 FORMS += \
@@ -16,12 +16,12 @@
 #include <QtWidgets/QHBoxLayout>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QLineEdit>
+#include <QtWidgets/QListView>
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QSpacerItem>
 #include <QtWidgets/QStatusBar>
-#include <QtWidgets/QTextEdit>
 #include <QtWidgets/QWidget>
 
 QT_BEGIN_NAMESPACE
@@ -39,7 +39,7 @@ public:
     QHBoxLayout *horizontalLayout_5;
     QSpacerItem *horizontalSpacer_3;
     QPushButton *pushButton_2;
-    QTextEdit *textEdit;
+    QListView *logView;
     QHBoxLayout *horizontalLayout_4;
     QPushButton *pushButton_12;
     QPushButton *pushButton_5;
@@ -114,10 +114,10 @@ public:
 
         gridLayout->addLayout(horizontalLayout_6, 0, 0, 1, 2);
 
-        textEdit = new QTextEdit(centralwidget);
-        textEdit->setObjectName(QString::fromUtf8("textEdit"));
+        logView = new QListView(centralwidget);
+        logView->setObjectName(QString::fromUtf8("logView"));
 
-        gridLayout->addWidget(textEdit, 1, 0, 1, 2);
+        gridLayout->addWidget(logView, 1, 0, 1, 2);
 
         horizontalLayout_4 = new QHBoxLayout();
         horizontalLayout_4->setObjectName(QString::fromUtf8("horizontalLayout_4"));
@@ -0,0 +1,399 @@
+/**
+ *  @File: main.cpp
+ *
+ *  *******************************************************************************************
+ *
+ *  @file      main.cpp
+ *
+ *  @brief     Headless OML BLE terminal. Opens the dongle (or replays a capture) with the same
+ *             serial, framing and handler code as the terminal and writes every decoded
+ *             response and event as one tab separated line, to stdout or a file
+ *  *******************************************************************************************
+ *
+ *  Copyright: Odstock Medical Limited (C) 2024
+ *
+ *  All rights are reserved. Reproduction or transmission in whole or in part,
+ *  in any form or by any means, electronic, mechanical or otherwise, is
+ *  prohibited without the prior written consent of the copyright owner.
+ *
+ *  To obtain written consent please contact the software release authority :
+ *
+ *  Odstock Medical Ltd. The National Clinical FES Centre, Salisbury District Hospital
+ *  Salisbury, Wiltshire SP2 8BJ, Tel +44 (0)1722 439 540
+ *
+ **/
+
+/**********************************************************************************************
+ * Module includes
+ **********************************************************************************************/
+#include "ble_module.h"
+#include "blerecord.h"
+#include "capture.h"
+#include "cmdqueue.h"
+#include "cmdtracker.h"
+#include "oml_interface.h"
+#include "omllinks.h"
+#include "serial.h"
+#include "timer.h"
+#include "../../OML BLE App/mcu_cmds.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QMetaObject>
+#include <QTimer>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/**********************************************************************************************
+ * Module constant defines
+ **********************************************************************************************/
+#define POLL_MS          100     // quit, duration and replay checks
+#define OUT_BUFFER_SIZE  65536u
+#define TEXT_MAX         512u
+
+/**********************************************************************************************
+ * Module static function prototypes
+ **********************************************************************************************/
+static bool OpenOutput(const QString &path);
+static bool SelectBackend(const QString &name);
+static bool SendCommands(const QStringList &commands);
+static void NotifyRecords(void);
+static void LogText(uint8_t level, const char *text);
+static void DrainRecords(void);
+static void PrintStats(void);
+static void OnSignal(int sig);
+
+/**********************************************************************************************
+ * Module static variables
+ **********************************************************************************************/
+static FILE *s_out = NULL;
+static bool s_adverts = true;
+static uint64_t s_records = 0;
+static uint64_t s_skipped = 0;
+static volatile sig_atomic_t s_quit = 0;
+
+/**********************************************************************************************
+ * Module externally exported functions
+ **********************************************************************************************/
+
+int main(int argc, char *argv[])
+{
+   QCoreApplication app(argc, argv);
+   QCoreApplication::setApplicationName("oml_terminal_cli");
+   QCoreApplication::setApplicationVersion(GIT_COMMIT_HASH);
+
+   QCommandLineParser parser;
+   parser.setApplicationDescription("Headless OML BLE terminal. Writes one line per decoded response or event:\n"
+                                    "wall time (s since the epoch), rx time (us), link, RSP/EVT, id, node id, RSSI, text");
+   parser.addHelpOption();
+   parser.addVersionOption();
+   QCommandLineOption portOption(QStringList() << "p" << "port", "Dongle serial port, e.g. /dev/ttyACM0 or COM3. Repeat for more dongles, the first is link 0 and gets the commands and the capture.", "port");
+   QCommandLineOption backendOption(QStringList() << "b" << "backend", "Serial backend, qt or termios.", "name");
+   QCommandLineOption outputOption(QStringList() << "o" << "output", "Write the records to file, - for stdout (default).", "file", "-");
+   QCommandLineOption captureOption(QStringList() << "c" << "capture", "Also capture the raw link traffic to file.", "file");
+   QCommandLineOption replayOption(QStringList() << "r" << "replay", "Decode a capture instead of opening a port.", "file");
+   QCommandLineOption fastOption(QStringList() << "f" << "fast", "Replay as fast as possible rather than in real time.");
+   QCommandLineOption sendOption(QStringList() << "s" << "send", "Command payload in hex to send once the port is open, e.g. 10 for MCU_CMD_GET_NODE_ID. Repeatable.", "hex");
+   QCommandLineOption durationOption(QStringList() << "t" << "duration", "Stop after this many seconds, 0 to run until interrupted (default).", "seconds", "0");
+   QCommandLineOption statsOption(QStringList() << "S" << "stats", "Print link counters to stderr every this many seconds, 0 for none (default).", "seconds", "0");
+   QCommandLineOption noAdvertsOption(QStringList() << "n" << "no-adverts", "Leave out MCU_EVT_NODE_FOUND.");
+   parser.addOptions({ portOption, backendOption, outputOption, captureOption, replayOption, fastOption,
+                       sendOption, durationOption, statsOption, noAdvertsOption });
+   parser.process(app);
+
+   bool replay = parser.isSet(replayOption);
+   if (replay == parser.isSet(portOption))
+   {
+      fprintf(stderr, "Give one of --port or --replay, see --help\n");
+      return EXIT_FAILURE;
+   }
+   if ((parser.isSet(backendOption) && !SelectBackend(parser.value(backendOption))) || !OpenOutput(parser.value(outputOption)))
+   {
+      return EXIT_FAILURE;
+   }
+   s_adverts = !parser.isSet(noAdvertsOption);
+
+   // records are taken off the pool on this thread, one queued call per burst
+   BLERecord_SetNotify(NotifyRecords);
+   BLEModule_SetLogSink(LogText);
+
+   TIMER_Init();
+   BLEModule_Init();
+   CmdTracker_Init();
+   CmdQueue_Init();
+
+   if (parser.isSet(captureOption) && !Capture_Start(parser.value(captureOption).toLocal8Bit().constData()))
+   {
+      fprintf(stderr, "Cannot capture to %s\n", parser.value(captureOption).toLocal8Bit().constData());
+      return EXIT_FAILURE;
+   }
+
+   if (replay)
+   {
+      CaptureReplayMode_e mode = parser.isSet(fastOption) ? eCAPTURE_REPLAY_FAST : eCAPTURE_REPLAY_REALTIME;
+      if (!Capture_ReplayStart(parser.value(replayOption).toLocal8Bit().constData(), mode, true))
+      {
+         fprintf(stderr, "Cannot replay %s\n", parser.value(replayOption).toLocal8Bit().constData());
+         return EXIT_FAILURE;
+      }
+   }
+   else
+   {
+      const QStringList ports = parser.values(portOption);
+      bool opened = OMLInterface_Open(ports.first().toLocal8Bit().constData());
+      for (int i = 1; opened && (i < ports.size()); i++)
+      {
+         opened = (OMLLinks_Open(ports[i].toLocal8Bit().constData()) != 0u);
+      }
+      if (!opened || !SendCommands(parser.values(sendOption)))
+      {
+         if (!opened)
+         {
+            fprintf(stderr, "Cannot open every port of %s\n", ports.join(", ").toLocal8Bit().constData());
+         }
+         OMLLinks_CloseAll();
+         OMLInterface_Close();
+         Capture_Stop();
+         return EXIT_FAILURE;
+      }
+   }
+
+   (void)signal(SIGINT, OnSignal);
+   (void)signal(SIGTERM, OnSignal);
+
+   uint64_t durationMs = parser.value(durationOption).toULongLong() * 1000u;
+   uint64_t statsMs = parser.value(statsOption).toULongLong() * 1000u;
+   uint64_t nextStatsMs = statsMs;
+
+   QTimer pollTimer;
+   QObject::connect(&pollTimer, &QTimer::timeout, [&]()
+   {
+      uint64_t nowMs = TIMER_NowMs();
+      if ((statsMs > 0u) && (nowMs >= nextStatsMs))
+      {
+         PrintStats();
+         nextStatsMs += statsMs;
+      }
+
+      CaptureReplayResult_t result;
+      if (s_quit || ((durationMs > 0u) && (nowMs >= durationMs)) || (replay && !Capture_ReplayPoll(&result)))
+      {
+         app.quit();
+      }
+   });
+   pollTimer.start(POLL_MS);
+
+   int ret = app.exec();
+
+   Capture_ReplayStop();
+   OMLLinks_CloseAll();
+   OMLInterface_Close();
+   Capture_Stop();
+   DrainRecords();
+   BLERecord_SetNotify(NULL);
+   BLEModule_SetLogSink(NULL);
+   PrintStats();
+   if (fclose(s_out) != 0)
+   {
+      ret = EXIT_FAILURE;
+   }
+   return ret;
+}
+
+/**********************************************************************************************
+ * Module static functions
+ **********************************************************************************************/
+
+/**
+ * @brief  Open where the records go. The library's own diagnostics are printed to stdout, so
+ *         when the records go there too stdout is kept for them and the rest sent to stderr
+ * @param  path - file, or - for stdout
+ * @return false if the file cannot be opened
+ */
+static bool OpenOutput(const QString &path)
+{
+   if (path == "-")
+   {
+      fflush(stdout);
+      s_out = fdopen(dup(fileno(stdout)), "w");
+      (void)dup2(fileno(stderr), fileno(stdout));
+   }
+   else
+   {
+      s_out = fopen(path.toLocal8Bit().constData(), "w");
+   }
+
+   if (s_out == NULL)
+   {
+      fprintf(stderr, "Cannot write %s\n", path.toLocal8Bit().constData());
+      return false;
+   }
+   (void)setvbuf(s_out, NULL, _IOFBF, OUT_BUFFER_SIZE);
+   return true;
+}
+
+/**
+ * @brief  Select the serial backend by name
+ * @param  name - as SerialBackendName
+ * @return false if the name is unknown or the backend is not available here
+ */
+static bool SelectBackend(const QString &name)
+{
+   for (int backend = 0; backend < eSERIAL_BACKEND_COUNT; backend++)
+   {
+      if (name == SerialBackendName(static_cast<SerialBackend_e>(backend)))
+      {
+         if (SerialSetBackend(static_cast<SerialBackend_e>(backend)))
+         {
+            return true;
+         }
+         fprintf(stderr, "Serial backend %s is not available on this platform\n", name.toLocal8Bit().constData());
+         return false;
+      }
+   }
+   fprintf(stderr, "Unknown serial backend: %s\n", name.toLocal8Bit().constData());
+   return false;
+}
+
+/**
+ * @brief  Send the --send command payloads, tracked like terminal commands
+ * @param  commands - command payloads in hex, the first byte is the MCU_CMD_xx id
+ * @return false if a payload is not valid hex or too long
+ */
+static bool SendCommands(const QStringList &commands)
+{
+   for (const QString &command : commands)
+   {
+      QByteArray payload = QByteArray::fromHex(command.toLatin1());
+      if (payload.isEmpty() || ((size_t)payload.size() > MCU_PROTOCOL_PAYLOAD_MAX))
+      {
+         fprintf(stderr, "Bad command payload: %s\n", command.toLocal8Bit().constData());
+         return false;
+      }
+      (void)CmdTracker_Send(payload.constData(), (size_t)payload.size(), 0, NULL, NULL);
+   }
+   return true;
+}
+
+/**
+ * @brief  Record pool notify, runs on the rx thread so only queues the drain to the main loop
+ * @param  None
+ * @return None
+ */
+static void NotifyRecords(void)
+{
+   QMetaObject::invokeMethod(qApp, DrainRecords, Qt::QueuedConnection);
+}
+
+/**
+ * @brief  Decoder log sink, diagnostics go to stderr to keep the record stream clean
+ * @param  level - debug level of the message, unused
+ * @param  text - message text
+ * @return None
+ */
+static void LogText(uint8_t level, const char *text)
+{
+   (void)level;
+   fputs(text, stderr);
+}
+
+/**
+ * @brief  Write every record waiting in the pool, one line each, and flush once
+ * @param  None
+ * @return None
+ */
+static void DrainRecords(void)
+{
+   // the rx time of a record is the TIMER_NowUs it arrived, turned into wall time against
+   // one reading of both clocks per burst. Records the rx thread commits during the burst
+   // arrived after that reading, so the difference is signed
+   uint64_t nowUs = TIMER_NowUs();
+   int64_t wallMs = QDateTime::currentMSecsSinceEpoch();
+   bool wrote = false;
+   const BLERecord_t *rec;
+
+   while ((rec = BLERecord_Peek()) != NULL)
+   {
+      if (!s_adverts && (rec->kind == eBLE_RECORD_EVT) && (rec->id == MCU_EVT_NODE_FOUND))
+      {
+         s_skipped++;
+         BLERecord_Release();
+         continue;
+      }
+
+      char text[TEXT_MAX];
+      BLEModule_FormatRecord(rec, text, sizeof(text));
+      size_t len = strlen(text);
+      while ((len > 0u) && ((text[len - 1u] == '\n') || (text[len - 1u] == ' ')))
+      {
+         text[--len] = '\0';
+      }
+      for (size_t i = 0; i < len; i++)
+      {
+         text[i] = ((text[i] == '\n') || (text[i] == '\t')) ? ' ' : text[i];
+      }
+
+      int64_t recWallMs = wallMs - (((int64_t)nowUs - (int64_t)rec->timeUs) / 1000);
+      fprintf(s_out, "%lld.%03d\t%llu\t%u\t%s\t0x%02X\t%u\t%d\t%s\n",
+              (long long)(recWallMs / 1000), (int)(recWallMs % 1000), (unsigned long long)rec->timeUs, (unsigned)rec->link,
+              (rec->kind == eBLE_RECORD_EVT) ? "EVT" : "RSP", rec->id, (unsigned)rec->nodeId, rec->rssi, text);
+      s_records++;
+      wrote = true;
+      BLERecord_Release();
+   }
+
+   if (wrote)
+   {
+      fflush(s_out);
+   }
+}
+
+/**
+ * @brief  Print the link counters to stderr
+ * @param  None
+ * @return None
+ */
+static void PrintStats(void)
+{
+   SerialRxStats_t rx;
+   SerialGetRxStats(&rx);
+   CaptureStats_t capture;
+   Capture_GetStats(&capture);
+   fprintf(stderr, "records %llu (adverts left out %llu, dropped %llu), rx %llu bytes (overflowed %llu), captured %llu bytes (dropped %llu)\n",
+           (unsigned long long)s_records, (unsigned long long)s_skipped, (unsigned long long)BLERecord_Dropped(),
+           (unsigned long long)rx.rxBytes, (unsigned long long)rx.overflowBytes,
+           (unsigned long long)capture.bytes, (unsigned long long)capture.droppedBytes);
+   for (uint8_t link = 1; link < OML_LINKS_MAX; link++)
+   {
+      OMLLinkStats_t stats;
+      if (OMLLinks_GetStats(link, &stats))
+      {
+         fprintf(stderr, "link %u %s: rx %llu bytes (overflowed %llu), %llu frames, %u bad crc\n",
+                 (unsigned)link, stats.port, (unsigned long long)stats.rx.rxBytes,
+                 (unsigned long long)stats.rx.overflowBytes, (unsigned long long)stats.decoder.frames,
+                 (unsigned)stats.decoder.badCrc);
+      }
+   }
+}
+
+/**
+ * @brief  SIGINT/SIGTERM handler
+ * @param  sig - signal number
+ * @return None
+ */
+static void OnSignal(int sig)
+{
+   (void)sig;
+   s_quit = 1;
+}
+
+/**********************************************************************************************
+ * End of file
+ **********************************************************************************************/
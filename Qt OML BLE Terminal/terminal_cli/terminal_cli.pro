@@ -0,0 +1,19 @@
+# Headless OML BLE terminal, a console tool for scripted use and sustained captures on
+# machines with no display. Links the oml_core protocol library under QCoreApplication,
+# no widgets.
+QT = core serialport
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+TARGET = oml_terminal_cli
+
+include(../oml_core/oml_core.pri)
+
+git_commit_hash = $$system(git rev-parse --short HEAD)
+DEFINES += GIT_COMMIT_HASH=\\\"$$git_commit_hash\\\"
+
+SOURCES += \
+    main.cpp
+
+unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target